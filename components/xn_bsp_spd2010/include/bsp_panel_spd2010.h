@@ -117,6 +117,21 @@ void Set_Backlight_Official(uint8_t Light);
  */
 esp_err_t SPD2010_Register_LVGL_Callback(lv_display_t *display);
 
+/**
+ * @brief flush完成回调（在SPI中断上下文中调用，每次 draw_bitmap 传输完成调用一次）
+ * @param disp LVGL显示对象
+ * @return 是否唤醒了更高优先级的任务（需要在中断退出时切换任务）
+ */
+typedef bool (*SPD2010_Flush_Done_Hook_t)(lv_display_t *disp);
+
+/**
+ * @brief 设置flush完成回调
+ * @param hook 回调函数，NULL表示取消（每次传输完成直接调用 lv_display_flush_ready）
+ * @note 设置后由回调负责调用 lv_display_flush_ready（一个刷屏区域分多次传输时只在最后一次调用），
+ *       回调中只能调用ISR安全的函数
+ */
+void SPD2010_Set_Flush_Done_Hook(SPD2010_Flush_Done_Hook_t hook);
+
 /**
  * @brief 获取面板句柄
  * @return esp_lcd_panel_handle_t 面板句柄
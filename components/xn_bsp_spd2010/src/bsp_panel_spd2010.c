@@ -230,6 +230,9 @@ void LCD_Init_Official(void)
     ESP_LOGI(TAG, "LCD初始化完成");
 }
 
+// flush完成回调（设置后由驱动决定何时通知LVGL，用于分块传输）
+static SPD2010_Flush_Done_Hook_t flush_done_hook = NULL;
+
 /**
  * @brief LVGL flush完成回调函数
  */
@@ -239,10 +242,23 @@ static bool notify_lvgl_flush_ready(esp_lcd_panel_io_handle_t panel_io, esp_lcd_
     // 如需调试，可使用 ESP_EARLY_LOGI（无锁，但功能简陋）
 
     lv_display_t *disp = (lv_display_t *)user_ctx;
+    SPD2010_Flush_Done_Hook_t hook = flush_done_hook;
+    if (hook) {
+        return hook(disp);
+    }
     lv_display_flush_ready(disp);
     return false;
 }
 
+/**
+ * @brief 设置flush完成回调
+ * @param hook 回调函数，NULL表示取消
+ */
+void SPD2010_Set_Flush_Done_Hook(SPD2010_Flush_Done_Hook_t hook)
+{
+    flush_done_hook = hook;
+}
+
 /**
  * @brief 注册LVGL flush完成回调
  * @param display LVGL显示对象指针
@@ -36,6 +36,27 @@ typedef struct {
     uint16_t screen_height;  // 屏幕高度
 } xn_lottie_app_config_t;
 
+// 管理器命令统计
+typedef struct {
+    uint32_t cmd_count;            // 已执行的命令数
+    uint32_t cmd_dropped;          // 命令队列满而丢弃的命令数
+    uint32_t cmd_latency_avg_us;   // 提交到开始执行的平均延迟（微秒）
+    uint32_t cmd_latency_max_us;   // 提交到开始执行的最大延迟（微秒）
+    uint32_t exec_max_us;          // 单条命令在LVGL任务中的最长执行时间（微秒）
+    uint32_t drive_frames;         // 外部数值驱动渲染并刷屏的帧数
+    uint32_t drive_latency_avg_us; // 驱动值发布到刷屏完成的平均延迟（微秒）
+    uint32_t drive_latency_max_us; // 驱动值发布到刷屏完成的最大延迟（微秒）
+    uint32_t preload_issued;       // 预测预加载次数
+    uint32_t preload_hits;         // 按类型播放时命中预加载的次数
+    uint32_t preload_misses;       // 按类型播放时未命中预加载的次数（命中率 = hits / (hits + misses)）
+    uint32_t preload_wasted;       // 未被使用而丢弃的预加载次数
+    uint32_t first_frame_cold_count;   // 冷加载的播放次数
+    uint32_t first_frame_cold_avg_us;  // 冷加载：播放请求到首帧发布的平均延迟（微秒）
+    uint32_t first_frame_hit_count;    // 命中预加载的播放次数
+    uint32_t first_frame_hit_avg_us;   // 命中预加载：播放请求到首帧发布的平均延迟（微秒）
+    uint32_t hold_skipped;         // 静止区间内跳过光栅化和刷新的帧数（动画切换或停止时累计）
+} lottie_manager_stats_t;
+
 /**
  * @brief 初始化 Lottie 管理器（包含底层 LVGL / 屏幕 / SPIFFS / 管理器）
  *
@@ -48,10 +69,14 @@ esp_err_t xn_lottie_manager_init(const xn_lottie_app_config_t *cfg);
 
 /**
  * @brief 播放指定路径的动画
+ *
+ * 所有管理器接口均为异步：只提交命令，不等待执行，可在任意任务中调用。
+ * 动画在后台任务加载完成后才替换当前显示的动画。
+ *
  * @param file_path 动画文件路径
  * @param width 动画宽度
  * @param height 动画高度
- * @return true 成功，false 失败
+ * @return true 命令已提交，false 失败
  */
 bool lottie_manager_play(const char *file_path, uint16_t width, uint16_t height);
 
@@ -88,6 +113,19 @@ void lottie_manager_show(void);
  */
 void lottie_manager_set_pos(int16_t x, int16_t y);
 
+/**
+ * @brief 以动画方式移动到指定位置（坐标含义与 lottie_manager_set_pos 相同）
+ *
+ * 移动过程按显示刷新节奏更新位置，只重新合成已渲染的帧缓冲区，不会重新光栅化矢量；
+ * 新的移动、set_pos 或 center 会打断进行中的移动。
+ *
+ * @param x 目标X坐标
+ * @param y 目标Y坐标
+ * @param duration_ms 移动时长（毫秒），0表示立即到达
+ * @return true 命令已提交
+ */
+bool lottie_manager_move_to(int16_t x, int16_t y, uint16_t duration_ms);
+
 /**
  * @brief 居中显示动画
  */
@@ -117,14 +155,148 @@ void lottie_manager_stop_anim(int anim_type);
 
 /**
  * @brief 显示图片
+ *
+ * 图片已在缓存中时仅交换图片指针；否则先由后台任务解码，解码完成后再显示，
+ * 不会阻塞LVGL渲染。构建期生成的同名 .bin（LVGL原生格式）优先于 .png。
  */
 bool lottie_manager_show_image(const char *img_path, uint16_t width, uint16_t height);
 
+/**
+ * @brief 预取图片：在后台解码并放入缓存，后续显示无需等待解码
+ * @param img_path 图片路径
+ * @return true 已缓存或已加入解码队列，false 失败
+ */
+bool lottie_manager_prefetch_image(const char *img_path);
+
 /**
  * @brief 隐藏图片
  */
 void lottie_manager_hide_image(void);
 
+/**
+ * @brief 开启/关闭外部数值驱动帧（如按音频幅度驱动说话动画口型）
+ *
+ * 开启后当前动画停止循环播放，每次LVGL刷新时读取 lottie_manager_drive_value 的最新值，
+ * 将 0.0~1.0 映射到 [start_frame, end_frame] 渲染；关闭后恢复循环播放。
+ * 设置对之后播放的动画同样生效。
+ *
+ * @param enable 是否开启
+ * @param start_frame 数值0对应的帧
+ * @param end_frame 数值1对应的帧，-1表示最后一帧
+ * @return true 命令已提交
+ */
+bool lottie_manager_drive_enable(bool enable, int32_t start_frame, int32_t end_frame);
+
+/**
+ * @brief 发布外部驱动数值（0.0~1.0）
+ *
+ * 单值邮箱，只保留最新值：不排队、不加锁、不阻塞，可在音频等任务中高频调用（如100Hz）。
+ * 仅支持单个生产者任务。
+ *
+ * @param value 驱动数值
+ */
+void lottie_manager_drive_value(float value);
+
+/**
+ * @brief 覆盖插槽颜色（复用已解析的场景，不重新加载）
+ *
+ * 插槽由构建工具按图层名生成：<图层名>_fill、<图层名>_stroke（小写，非字母数字替换为'_'），
+ * 可用 `python tools/lottie_assets.py slots --src lottie_spiffs` 列出。
+ * 覆盖立即作用于当前动画，并在之后播放的动画上保留，直到 lottie_manager_clear_overrides。
+ *
+ * @param slot 插槽名
+ * @param rgb 颜色（0xRRGGBB）
+ * @return true 命令已提交
+ */
+bool lottie_manager_set_color(const char *slot, uint32_t rgb);
+
+/**
+ * @brief 显示/隐藏图层（覆盖 <图层名>_opacity 插槽的不透明度）
+ * @param slot 插槽名
+ * @param visible 是否可见
+ * @return true 命令已提交
+ */
+bool lottie_manager_set_visible(const char *slot, bool visible);
+
+/**
+ * @brief 清除全部插槽覆盖，恢复动画原始属性
+ * @return true 命令已提交
+ */
+bool lottie_manager_clear_overrides(void);
+
+/**
+ * @brief 开始批量命令
+ *
+ * 之后当前任务调用的管理器接口（播放、停止、显示/隐藏、位置、图片等）先暂存，
+ * lottie_manager_batch_commit 时作为一条命令提交，在LVGL任务中一次执行完，
+ * 中间状态不会被渲染，显示对象的新旧区域只刷新一次。每批最多8条命令。
+ *
+ * @return true 成功，false 当前任务已打开批次或同时打开的批次过多
+ */
+bool lottie_manager_batch_begin(void);
+
+/**
+ * @brief 提交批量命令
+ * @return true 已提交，false 未打开批次或命令队列已满（批次内命令全部丢弃）
+ */
+bool lottie_manager_batch_commit(void);
+
+/**
+ * @brief 开始录制命令流（清空之前的录制）
+ *
+ * 录制之后执行的外部命令（含提交时间），保留最近512条，用于复现现场的命令序列
+ * （如语音交互中快速的播放/停止）。
+ *
+ * @return true 命令已提交
+ */
+bool lottie_manager_trace_start(void);
+
+/**
+ * @brief 停止录制命令流，已录制的内容保留
+ * @return true 命令已提交
+ */
+bool lottie_manager_trace_stop(void);
+
+/**
+ * @brief 导出录制的命令流到日志（后台任务输出）
+ *
+ * 用 `python tools/lottie_assets.py trace --log monitor.log --out lottie_spiffs/name.trace`
+ * 从日志还原为命令流文件。
+ *
+ * @return true 命令已提交
+ */
+bool lottie_manager_trace_dump(void);
+
+/**
+ * @brief 回放命令流，结束后在日志中输出回放报告（切换延迟、丢帧、命令丢弃、峰值内存）
+ *
+ * 回放任务先停止动画并清除覆盖、外部驱动和图片，再按记录的时间间隔调用管理器接口，
+ * 同一命令流每次回放的命令顺序和间隔相同。回放时停止录制。
+ *
+ * @param trace_path 命令流文件（如 "/lottie/burst.trace"），NULL表示回放内存中的录制
+ * @return true 命令已提交
+ */
+bool lottie_manager_trace_replay(const char *trace_path);
+
+/**
+ * @brief 测量动画在各渲染比例（1、3/4、1/2）下的光栅化时间和视觉误差（调试用）
+ *
+ * 在后台加载任务中单独加载一份动画，对若干采样帧计时并以PSNR对比原始尺寸渲染结果，
+ * 结果输出到日志，不影响当前显示。
+ *
+ * @param anim_type 动画类型
+ * @return true 测量请求已提交
+ */
+bool lottie_manager_profile_anim(int anim_type);
+
+/**
+ * @brief 获取命令统计（调试用）
+ *
+ * 预测预加载节省的首帧延迟约为 (first_frame_cold_avg_us - first_frame_hit_avg_us) × first_frame_hit_count。
+ * @param stats 输出统计
+ */
+void lottie_manager_get_stats(lottie_manager_stats_t *stats);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,419 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Description: 动画场景内存分区实现
+ *
+ * 解析一个Lottie会产生数千次小分配，销毁时再逐块释放。这些分配与系统其他模块的分配
+ * 交错在通用堆中，长时间运行后PSRAM碎片越来越多。分区把一个动画的场景分配集中到
+ * 独立的页中：页按需从页池（初始化时分配的一整块内存）取用，块按大小分级、释放后按级
+ * 复用；销毁动画时先丢弃分区，ThorVG析构中的释放直接返回，再把所有页一次归还页池。
+ *
+ * 页池分配用位图CAS，无锁；分区本身同一时刻只由一个任务使用，不加锁。
+ * 页归还页池后可能被另一个分区取用，此时仍持有旧指针的释放不能进入新分区的空闲链：
+ * 块头记录分配时的分区序号和页代数（页每次被取用时加一），释放时与页的当前所属分区和
+ * 代数比对，不符的释放直接忽略并计数。
+ * 分区核心不依赖ESP-IDF，可在主机上编译（tools/lottie_arena_bench.c）。
+ */
+
+#include "xn_lottie_arena.h"
+#include <stdatomic.h>
+#include <string.h>
+
+#define ARENA_HDR_SIZE      8       // 块头（arena_hdr_t），保证返回地址8字节对齐
+#define ARENA_CLASSES       32      // 8~64按8字节分级，之后每个2的幂分4级，到 LOTTIE_ARENA_LARGE
+#define ARENA_PAGE_WORDS    ((LOTTIE_ARENA_PAGES + 31) / 32)
+
+_Static_assert(LOTTIE_ARENA_LARGE == 4096, "分级表按4096字节上限设计");
+_Static_assert(LOTTIE_ARENA_LARGE + ARENA_HDR_SIZE <= LOTTIE_ARENA_PAGE_SIZE, "页必须能容纳最大的块");
+
+// 块头：级别、所属分区序号+1、分配时的页代数
+typedef struct {
+    uint8_t cls;
+    uint8_t owner;
+    uint16_t gen;
+    uint32_t reserved;
+} arena_hdr_t;
+
+_Static_assert(sizeof(arena_hdr_t) == ARENA_HDR_SIZE, "块头大小");
+_Static_assert(LOTTIE_ARENA_MAX < 255, "分区序号用8位记录");
+
+enum {
+    ARENA_FREE = 0,
+    ARENA_LIVE,
+    ARENA_DROPPED,
+};
+
+struct lottie_arena {
+    atomic_uint state;
+    uint8_t *cur;               // 当前页中未使用部分
+    uint8_t *end;
+    uint8_t *free_list[ARENA_CLASSES];  // 按级的空闲块（块头地址，块体存下一个）
+    lottie_arena_stats_t stats;
+};
+
+static uint8_t *g_pool;
+static uint8_t *g_pool_end;
+static atomic_uint g_page_bits[ARENA_PAGE_WORDS];   // 已占用的页
+static uint8_t g_page_owner[LOTTIE_ARENA_PAGES];    // 页所属分区序号+1，0为空闲
+static uint16_t g_page_gen[LOTTIE_ARENA_PAGES];     // 页代数，每次被取用时加一
+static atomic_uint g_stale_frees;                   // 忽略的过期释放（块头与页当前所属不符）
+static lottie_arena_t g_arenas[LOTTIE_ARENA_MAX];
+
+// 大小 -> 级别（size 为 1~LOTTIE_ARENA_LARGE）
+static int arena_class(size_t size)
+{
+    if (size <= 64) {
+        return (int)((size + 7) >> 3) - 1;
+    }
+    unsigned bits = 31 - __builtin_clz((unsigned)(size - 1));
+    unsigned sub = (unsigned)((size - 1) >> (bits - 2)) & 3;
+    return 8 + (int)(bits - 6) * 4 + (int)sub;
+}
+
+// 级别 -> 块体大小
+static size_t arena_class_size(int cls)
+{
+    if (cls < 8) {
+        return (size_t)(cls + 1) << 3;
+    }
+    cls -= 8;
+    return (size_t)(5 + (cls & 3)) << (4 + (cls >> 2));
+}
+
+bool lottie_arena_pool_init(void *mem, size_t size)
+{
+    if (!mem || g_pool) {
+        return false;
+    }
+
+    size_t pages = size / LOTTIE_ARENA_PAGE_SIZE;
+    if (pages > LOTTIE_ARENA_PAGES) {
+        pages = LOTTIE_ARENA_PAGES;
+    }
+    if (pages == 0) {
+        return false;
+    }
+
+    // 超出页池实际大小的位预先置为占用
+    for (unsigned w = 0; w < ARENA_PAGE_WORDS; w++) {
+        unsigned bits = 0;
+        for (unsigned b = 0; b < 32; b++) {
+            if (w * 32 + b >= pages) {
+                bits |= 1u << b;
+            }
+        }
+        atomic_store_explicit(&g_page_bits[w], bits, memory_order_relaxed);
+    }
+    memset(g_page_owner, 0, sizeof(g_page_owner));
+    memset(g_page_gen, 0, sizeof(g_page_gen));
+    atomic_store_explicit(&g_stale_frees, 0, memory_order_relaxed);
+
+    g_pool_end = (uint8_t *)mem + pages * LOTTIE_ARENA_PAGE_SIZE;
+    g_pool = (uint8_t *)mem;
+    return true;
+}
+
+static uint8_t *arena_claim_page(lottie_arena_t *arena)
+{
+    for (unsigned w = 0; w < ARENA_PAGE_WORDS; w++) {
+        unsigned bits = atomic_load_explicit(&g_page_bits[w], memory_order_relaxed);
+        while (bits != ~0u) {
+            unsigned b = __builtin_ctz(~bits);
+            if (atomic_compare_exchange_weak_explicit(&g_page_bits[w], &bits, bits | (1u << b),
+                                                      memory_order_acquire, memory_order_relaxed)) {
+                unsigned page = w * 32 + b;
+                g_page_gen[page]++;
+                g_page_owner[page] = (uint8_t)(arena - g_arenas + 1);
+                return g_pool + (size_t)page * LOTTIE_ARENA_PAGE_SIZE;
+            }
+        }
+    }
+    return NULL;
+}
+
+lottie_arena_t *lottie_arena_create(void)
+{
+    if (!g_pool) {
+        return NULL;
+    }
+
+    for (int i = 0; i < LOTTIE_ARENA_MAX; i++) {
+        lottie_arena_t *arena = &g_arenas[i];
+        unsigned expected = ARENA_FREE;
+        if (atomic_compare_exchange_strong(&arena->state, &expected, ARENA_LIVE)) {
+            arena->cur = NULL;
+            arena->end = NULL;
+            memset(arena->free_list, 0, sizeof(arena->free_list));
+            memset(&arena->stats, 0, sizeof(arena->stats));
+            return arena;
+        }
+    }
+    return NULL;
+}
+
+void *lottie_arena_alloc(lottie_arena_t *arena, size_t size)
+{
+    if (size > LOTTIE_ARENA_LARGE) {
+        arena->stats.overflow_count++;
+        return NULL;
+    }
+
+    int cls = arena_class(size ? size : 1);
+    size_t block = arena_class_size(cls) + ARENA_HDR_SIZE;
+    uint8_t *p = arena->free_list[cls];
+    if (p) {
+        arena->free_list[cls] = *(uint8_t **)(p + ARENA_HDR_SIZE);
+    } else {
+        if (!arena->cur || arena->cur + block > arena->end) {
+            uint8_t *page = arena_claim_page(arena);
+            if (!page) {
+                arena->stats.overflow_count++;
+                return NULL;
+            }
+            arena->cur = page;
+            arena->end = page + LOTTIE_ARENA_PAGE_SIZE;
+            arena->stats.pages++;
+        }
+        p = arena->cur;
+        arena->cur += block;
+        // 块头只在从页中切出时写入，按级复用的块留在原页，分区和页代数不变
+        arena_hdr_t *hdr = (arena_hdr_t *)p;
+        hdr->cls = (uint8_t)cls;
+        hdr->owner = (uint8_t)(arena - g_arenas + 1);
+        hdr->gen = g_page_gen[(size_t)(p - g_pool) / LOTTIE_ARENA_PAGE_SIZE];
+        hdr->reserved = 0;
+    }
+
+    arena->stats.alloc_count++;
+    arena->stats.used_bytes += block;
+    if (arena->stats.used_bytes > arena->stats.peak_bytes) {
+        arena->stats.peak_bytes = arena->stats.used_bytes;
+    }
+    return p + ARENA_HDR_SIZE;
+}
+
+bool lottie_arena_in_pool(const void *ptr)
+{
+    const uint8_t *p = (const uint8_t *)ptr;
+    return p >= g_pool && p < g_pool_end;
+}
+
+lottie_arena_t *lottie_arena_of(const void *ptr)
+{
+    if (!lottie_arena_in_pool(ptr)) {
+        return NULL;
+    }
+
+    size_t page = (size_t)((const uint8_t *)ptr - g_pool) / LOTTIE_ARENA_PAGE_SIZE;
+    uint8_t owner = g_page_owner[page];
+    const arena_hdr_t *hdr = (const arena_hdr_t *)((const uint8_t *)ptr - ARENA_HDR_SIZE);
+    // 块头地址不在本页（指针不是分区返回的块）或块头与页当前所属不符：过期指针
+    if (!owner || ((size_t)((const uint8_t *)hdr - g_pool) / LOTTIE_ARENA_PAGE_SIZE) != page ||
+        hdr->owner != owner || hdr->gen != g_page_gen[page] || hdr->cls >= ARENA_CLASSES) {
+        return NULL;
+    }
+    return &g_arenas[owner - 1];
+}
+
+void lottie_arena_free(void *ptr)
+{
+    lottie_arena_t *arena = lottie_arena_of(ptr);
+    if (!arena) {
+        // 所属分区已销毁、页已归还或被其他分区取用：不能进入任何空闲链
+        if (lottie_arena_in_pool(ptr)) {
+            atomic_fetch_add_explicit(&g_stale_frees, 1, memory_order_relaxed);
+        }
+        return;
+    }
+    if (atomic_load_explicit(&arena->state, memory_order_relaxed) != ARENA_LIVE) {
+        return;     // 已丢弃：销毁时整体释放
+    }
+
+    uint8_t *p = (uint8_t *)ptr - ARENA_HDR_SIZE;
+    int cls = ((arena_hdr_t *)p)->cls;
+    *(uint8_t **)ptr = arena->free_list[cls];
+    arena->free_list[cls] = p;
+    arena->stats.used_bytes -= (uint32_t)(arena_class_size(cls) + ARENA_HDR_SIZE);
+}
+
+size_t lottie_arena_block_size(const void *ptr)
+{
+    return arena_class_size(((const arena_hdr_t *)((const uint8_t *)ptr - ARENA_HDR_SIZE))->cls);
+}
+
+void lottie_arena_drop(lottie_arena_t *arena)
+{
+    if (arena) {
+        atomic_store_explicit(&arena->state, ARENA_DROPPED, memory_order_relaxed);
+    }
+}
+
+void lottie_arena_destroy(lottie_arena_t *arena)
+{
+    if (!arena) {
+        return;
+    }
+
+    uint8_t id = (uint8_t)(arena - g_arenas + 1);
+    for (unsigned page = 0; page < LOTTIE_ARENA_PAGES; page++) {
+        if (g_page_owner[page] == id) {
+            g_page_owner[page] = 0;
+            atomic_fetch_and_explicit(&g_page_bits[page / 32], ~(1u << (page % 32)), memory_order_release);
+        }
+    }
+    atomic_store_explicit(&arena->state, ARENA_FREE, memory_order_release);
+}
+
+void lottie_arena_get_stats(const lottie_arena_t *arena, lottie_arena_stats_t *stats)
+{
+    *stats = arena->stats;
+}
+
+uint32_t lottie_arena_pool_stale_frees(void)
+{
+    return atomic_load_explicit(&g_stale_frees, memory_order_relaxed);
+}
+
+uint32_t lottie_arena_pool_free_pages(void)
+{
+    uint32_t count = 0;
+    for (unsigned w = 0; w < ARENA_PAGE_WORDS; w++) {
+        count += 32 - __builtin_popcount(atomic_load_explicit(&g_page_bits[w], memory_order_relaxed));
+    }
+    return count;
+}
+
+#ifdef ESP_PLATFORM
+
+// ---------------- malloc 拦截（链接参数 -Wl,--wrap=malloc 等，见 CMakeLists.txt） ----------------
+
+#include "sdkconfig.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+
+static const char *TAG = "LOTTIE_ARENA";
+
+#if !CONFIG_LOTTIE_SCENE_ARENA
+
+// 未启用：不分配页池、不拦截分配，lottie_arena_create 返回NULL，场景使用通用堆
+bool lottie_arena_init(void)
+{
+    ESP_LOGI(TAG, "场景分区未启用 (CONFIG_LOTTIE_SCENE_ARENA)");
+    return false;
+}
+
+lottie_arena_t *lottie_arena_enter(lottie_arena_t *arena)
+{
+    (void)arena;
+    return NULL;
+}
+
+#else
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t n, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+void __real_free(void *ptr);
+
+static __thread lottie_arena_t *t_arena;    // 当前任务进入的分区
+
+bool lottie_arena_init(void)
+{
+    size_t size = (size_t)CONFIG_LOTTIE_SCENE_ARENA_POOL_KB * 1024;
+    if (size > (size_t)LOTTIE_ARENA_PAGES * LOTTIE_ARENA_PAGE_SIZE) {
+        size = (size_t)LOTTIE_ARENA_PAGES * LOTTIE_ARENA_PAGE_SIZE;
+    }
+    void *mem = heap_caps_aligned_alloc(8, size, MALLOC_CAP_SPIRAM);
+    if (!mem) {
+        ESP_LOGW(TAG, "页池分配失败 (需要 %zu 字节)，场景使用通用堆", size);
+        return false;
+    }
+
+    lottie_arena_pool_init(mem, size);
+    ESP_LOGI(TAG, "场景分区页池: %lu 页 x %d 字节", (unsigned long)lottie_arena_pool_free_pages(),
+             LOTTIE_ARENA_PAGE_SIZE);
+    return true;
+}
+
+lottie_arena_t *lottie_arena_enter(lottie_arena_t *arena)
+{
+    lottie_arena_t *prev = t_arena;
+    t_arena = arena;
+    return prev;
+}
+
+void *__wrap_malloc(size_t size)
+{
+    lottie_arena_t *arena = t_arena;
+    if (arena) {
+        void *p = lottie_arena_alloc(arena, size);
+        if (p) {
+            return p;
+        }
+    }
+    return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t n, size_t size)
+{
+    lottie_arena_t *arena = t_arena;
+    if (arena && (size == 0 || n <= LOTTIE_ARENA_LARGE / size)) {
+        void *p = lottie_arena_alloc(arena, n * size);
+        if (p) {
+            memset(p, 0, n * size);
+            return p;
+        }
+    }
+    return __real_calloc(n, size);
+}
+
+void *__wrap_realloc(void *ptr, size_t size)
+{
+    lottie_arena_t *arena = ptr ? lottie_arena_of(ptr) : t_arena;
+    if (!arena) {
+        if (ptr && lottie_arena_in_pool(ptr)) {
+            // 过期的分区指针：不知道块的大小，也不能交给通用堆，按分配失败处理
+            lottie_arena_free(ptr);
+            return NULL;
+        }
+        return __real_realloc(ptr, size);
+    }
+    if (!ptr) {
+        return __wrap_malloc(size);
+    }
+    if (size == 0) {
+        lottie_arena_free(ptr);
+        return NULL;
+    }
+
+    // 分区内存：当前级别放得下则原地返回，否则在所属分区（放不下时在通用堆）重新分配
+    size_t old_size = lottie_arena_block_size(ptr);
+    if (size <= old_size) {
+        return ptr;
+    }
+    void *p = NULL;
+    if (atomic_load_explicit(&arena->state, memory_order_relaxed) == ARENA_LIVE) {
+        p = lottie_arena_alloc(arena, size);
+    }
+    if (!p) {
+        p = __real_malloc(size);
+        if (!p) {
+            return NULL;
+        }
+    }
+    memcpy(p, ptr, old_size);
+    lottie_arena_free(ptr);
+    return p;
+}
+
+void __wrap_free(void *ptr)
+{
+    if (lottie_arena_in_pool(ptr)) {
+        lottie_arena_free(ptr);
+        return;
+    }
+    __real_free(ptr);
+}
+
+#endif // CONFIG_LOTTIE_SCENE_ARENA
+
+#endif
@@ -0,0 +1,147 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Description: 动画场景内存分区（每个已加载动画独占一个分区，销毁时整体释放）
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// 分区页大小和页数上限：页从初始化时分配的一整块内存（PSRAM）中划分，与通用堆隔离，
+// 固件中页池大小由 CONFIG_LOTTIE_SCENE_ARENA_POOL_KB 决定
+#define LOTTIE_ARENA_PAGE_SIZE      (16 * 1024)
+#define LOTTIE_ARENA_PAGES          64
+
+// 同时存在的分区数（当前动画 + 预加载 + 背景/测量等临时加载）
+#define LOTTIE_ARENA_MAX            6
+
+// 超过此大小的分配不进入分区，仍由通用堆分配（数量少，不是碎片的主要来源）
+#define LOTTIE_ARENA_LARGE          4096
+
+typedef struct lottie_arena lottie_arena_t;
+
+// 分区统计
+typedef struct {
+    uint32_t pages;             // 占用页数
+    uint32_t used_bytes;        // 当前已分配字节（含块头）
+    uint32_t peak_bytes;        // 已分配字节峰值
+    uint32_t alloc_count;       // 分区内分配次数
+    uint32_t overflow_count;    // 超大分配或页池耗尽而转入通用堆的次数
+} lottie_arena_stats_t;
+
+/**
+ * @brief 初始化页池（只调用一次，之后才能创建分区）
+ * @param mem 页池内存（至少8字节对齐）
+ * @param size 页池大小，超过 LOTTIE_ARENA_PAGES 页的部分不使用
+ * @return true 成功
+ */
+bool lottie_arena_pool_init(void *mem, size_t size);
+
+/**
+ * @brief 创建分区（不预先占用页，首次分配时才从页池取页）
+ * @return 分区，页池未初始化或分区数已满时返回NULL
+ */
+lottie_arena_t *lottie_arena_create(void);
+
+/**
+ * @brief 在分区中分配（按大小分级，释放的块按级复用）
+ *
+ * 分区同一时刻只能由一个任务使用（加载任务加载完成后经队列交给LVGL任务）。
+ *
+ * @param arena 分区
+ * @param size 大小
+ * @return 8字节对齐的内存，超大分配或页池耗尽时返回NULL（由调用者改用通用堆）
+ */
+void *lottie_arena_alloc(lottie_arena_t *arena, size_t size);
+
+/**
+ * @brief 内存是否位于页池中（只比较地址范围，可用于任意指针）
+ * @param ptr 内存
+ * @return true 位于页池
+ */
+bool lottie_arena_in_pool(const void *ptr);
+
+/**
+ * @brief 查找内存所属的分区（块头中的分区序号和页代数须与页的当前所属一致）
+ * @param ptr 内存
+ * @return 分区，不在页池中或为过期指针（所属分区已销毁、页已被其他分区取用）时返回NULL
+ */
+lottie_arena_t *lottie_arena_of(const void *ptr);
+
+/**
+ * @brief 释放分区内存（所属分区已丢弃时什么也不做；过期指针忽略并计入 lottie_arena_pool_stale_frees）
+ *
+ * 页被新分区取用后、在同一地址切出的新块会重写块头，此时对旧块的释放无法与新块区分；
+ * 块头只能拦下地址落在新块之内或页尚未被再次切分的过期释放。
+ *
+ * @param ptr lottie_arena_alloc 返回的内存
+ */
+void lottie_arena_free(void *ptr);
+
+/**
+ * @brief 分区内存块的可用大小
+ * @param ptr lottie_arena_alloc 返回的内存
+ * @return 可用字节数
+ */
+size_t lottie_arena_block_size(const void *ptr);
+
+/**
+ * @brief 丢弃分区：之后对分区内存的释放直接返回，销毁场景时不再逐块回收
+ * @param arena 分区
+ */
+void lottie_arena_drop(lottie_arena_t *arena);
+
+/**
+ * @brief 销毁分区，所有页一次归还页池（调用前分区内的对象必须都已不再使用）
+ * @param arena 分区，可为NULL
+ */
+void lottie_arena_destroy(lottie_arena_t *arena);
+
+/**
+ * @brief 获取分区统计
+ * @param arena 分区
+ * @param stats 输出统计
+ */
+void lottie_arena_get_stats(const lottie_arena_t *arena, lottie_arena_stats_t *stats);
+
+/**
+ * @brief 页池空闲页数
+ */
+uint32_t lottie_arena_pool_free_pages(void);
+
+/**
+ * @brief 被忽略的过期释放次数（块头与页的当前所属分区或代数不符）；非零说明分区销毁后
+ *        仍有代码持有并释放分区内存
+ */
+uint32_t lottie_arena_pool_stale_frees(void);
+
+#ifdef ESP_PLATFORM
+
+/**
+ * @brief 从PSRAM分配页池并初始化（管理器初始化时调用，失败时场景仍使用通用堆）
+ *
+ * 未启用 CONFIG_LOTTIE_SCENE_ARENA 时不分配页池，直接返回false。
+ *
+ * @return true 成功
+ */
+bool lottie_arena_init(void);
+
+/**
+ * @brief 切换当前任务的分区：之后本任务的 malloc/calloc/new 优先从该分区分配
+ *
+ * 启用 CONFIG_LOTTIE_SCENE_ARENA 时链接以 -Wl,--wrap 拦截整个固件的
+ * malloc/calloc/realloc/free：只有当前任务进入了分区时分配才进入分区；释放按地址判断，
+ * 分区内存总是回到所属分区。未启用时为空操作，返回NULL。
+ * 只在构建场景的ThorVG调用前后切换（动画创建、解析、设置尺寸、切帧、插槽覆盖），
+ * 恢复时把返回值再传入。画布/渲染器、共享内存池和光栅化中创建的渲染数据不属于某个
+ * 动画，不能在分区内调用；库内部首次使用时才分配的全局或任务级状态要在进入分区前
+ * 预热（见 lottie_player_warmup），否则会随分区销毁而失效。
+ *
+ * @param arena 分区，NULL表示使用通用堆
+ * @return 切换前的分区
+ */
+lottie_arena_t *lottie_arena_enter(lottie_arena_t *arena);
+
+#endif
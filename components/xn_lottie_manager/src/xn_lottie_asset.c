@@ -0,0 +1,217 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Description: Lottie资源读取实现
+ *
+ * ThorVG的Lottie解析器需要一段连续的JSON，无法逐块增量解析；
+ * 这里保证加载期间只有一份JSON：按块读入最终缓冲区，并交给播放器持有
+ * （ThorVG以不复制方式引用），不再出现 文件缓冲区 + ThorVG副本 两份数据。
+ *
+ * 压缩资源使用ROM中的miniz(tinfl)解压：输出即最终缓冲区（非环绕模式，
+ * 无需32KB字典窗口），输入只占一个 LOTTIE_ASSET_CHUNK_SIZE 窗口。
+ */
+
+#include "xn_lottie_asset.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "rom/miniz.h"
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+
+static const char *TAG = "LOTTIE_ASSET";
+
+// 压缩资源路径最大长度（原路径 + ".z"）
+#define LOTTIE_ASSET_PATH_MAX       72
+
+void lottie_mem_probe_begin(lottie_mem_probe_t *probe)
+{
+    probe->base_free = heap_caps_get_free_size(MALLOC_CAP_SPIRAM);
+    probe->min_free = probe->base_free;
+}
+
+void lottie_mem_probe_sample(lottie_mem_probe_t *probe)
+{
+    if (!probe) {
+        return;
+    }
+
+    size_t free_size = heap_caps_get_free_size(MALLOC_CAP_SPIRAM);
+    if (free_size < probe->min_free) {
+        probe->min_free = free_size;
+    }
+}
+
+size_t lottie_mem_probe_peak(const lottie_mem_probe_t *probe)
+{
+    return probe->base_free - probe->min_free;
+}
+
+// 按块直接读入目标缓冲区
+static uint8_t *asset_read_raw(FILE *fp, size_t file_size, size_t *out_size, lottie_mem_probe_t *probe)
+{
+    uint8_t *data = heap_caps_malloc(file_size + 1, MALLOC_CAP_SPIRAM);
+    if (!data) {
+        ESP_LOGE(TAG, "资源缓冲区分配失败 (需要 %zu 字节)", file_size + 1);
+        return NULL;
+    }
+    lottie_mem_probe_sample(probe);
+
+    size_t offset = 0;
+    while (offset < file_size) {
+        size_t chunk = file_size - offset;
+        if (chunk > LOTTIE_ASSET_CHUNK_SIZE) {
+            chunk = LOTTIE_ASSET_CHUNK_SIZE;
+        }
+        size_t n = fread(data + offset, 1, chunk, fp);
+        if (n == 0) {
+            break;
+        }
+        offset += n;
+    }
+
+    if (offset != file_size) {
+        ESP_LOGE(TAG, "文件读取失败 (%zu/%zu)", offset, file_size);
+        heap_caps_free(data);
+        return NULL;
+    }
+
+    data[file_size] = '\0';
+    *out_size = file_size;
+    return data;
+}
+
+// 分块读取压缩数据并流式解压到目标缓冲区
+static uint8_t *asset_read_inflate(FILE *fp, size_t file_size, size_t *out_size, lottie_mem_probe_t *probe)
+{
+    uint8_t header[LOTTIE_ASSET_Z_HEADER_SIZE];
+    if (file_size < sizeof(header) || fread(header, 1, sizeof(header), fp) != sizeof(header) ||
+        memcmp(header, LOTTIE_ASSET_Z_MAGIC, 4) != 0) {
+        ESP_LOGE(TAG, "压缩资源头无效");
+        return NULL;
+    }
+    size_t raw_size = (size_t)header[4] | ((size_t)header[5] << 8) |
+                      ((size_t)header[6] << 16) | ((size_t)header[7] << 24);
+
+    uint8_t *data = heap_caps_malloc(raw_size + 1, MALLOC_CAP_SPIRAM);
+    // 解压状态和输入窗口是临时的，优先放内部RAM
+    tinfl_decompressor *inflator = heap_caps_malloc(sizeof(tinfl_decompressor), MALLOC_CAP_INTERNAL);
+    uint8_t *window = heap_caps_malloc(LOTTIE_ASSET_CHUNK_SIZE, MALLOC_CAP_INTERNAL);
+    if (!inflator) {
+        inflator = heap_caps_malloc(sizeof(tinfl_decompressor), MALLOC_CAP_SPIRAM);
+    }
+    if (!window) {
+        window = heap_caps_malloc(LOTTIE_ASSET_CHUNK_SIZE, MALLOC_CAP_SPIRAM);
+    }
+    if (!data || !inflator || !window) {
+        ESP_LOGE(TAG, "解压缓冲区分配失败 (需要 %zu 字节)", raw_size + 1);
+        heap_caps_free(data);
+        heap_caps_free(inflator);
+        heap_caps_free(window);
+        return NULL;
+    }
+    lottie_mem_probe_sample(probe);
+
+    tinfl_init(inflator);
+    tinfl_status status = TINFL_STATUS_FAILED;
+    size_t remaining = file_size - sizeof(header);
+    size_t in_avail = 0;
+    size_t in_pos = 0;
+    size_t out_pos = 0;
+
+    while (1) {
+        if (in_pos == in_avail && remaining > 0) {
+            size_t chunk = remaining > LOTTIE_ASSET_CHUNK_SIZE ? LOTTIE_ASSET_CHUNK_SIZE : remaining;
+            in_avail = fread(window, 1, chunk, fp);
+            if (in_avail == 0) {
+                break;
+            }
+            remaining -= in_avail;
+            in_pos = 0;
+        }
+
+        size_t in_bytes = in_avail - in_pos;
+        size_t out_bytes = raw_size - out_pos;
+        mz_uint32 flags = TINFL_FLAG_USING_NON_WRAPPING_OUTPUT_BUF;
+        if (remaining > 0) {
+            flags |= TINFL_FLAG_HAS_MORE_INPUT;
+        }
+        status = tinfl_decompress(inflator, window + in_pos, &in_bytes,
+                                  data, data + out_pos, &out_bytes, flags);
+        in_pos += in_bytes;
+        out_pos += out_bytes;
+
+        if (status != TINFL_STATUS_NEEDS_MORE_INPUT || (in_pos == in_avail && remaining == 0)) {
+            break;
+        }
+    }
+
+    heap_caps_free(window);
+    heap_caps_free(inflator);
+
+    if (status != TINFL_STATUS_DONE || out_pos != raw_size) {
+        ESP_LOGE(TAG, "解压失败: status=%d (%zu/%zu)", (int)status, out_pos, raw_size);
+        heap_caps_free(data);
+        return NULL;
+    }
+
+    data[raw_size] = '\0';
+    *out_size = raw_size;
+    return data;
+}
+
+bool lottie_asset_exists(const char *path)
+{
+    char z_path[LOTTIE_ASSET_PATH_MAX];
+    struct stat st;
+
+    if (stat(path, &st) == 0) {
+        return true;
+    }
+    int n = snprintf(z_path, sizeof(z_path), "%s" LOTTIE_ASSET_Z_SUFFIX, path);
+    return n > 0 && (size_t)n < sizeof(z_path) && stat(z_path, &st) == 0;
+}
+
+uint8_t *lottie_asset_read(const char *path, size_t *out_size, lottie_mem_probe_t *probe)
+{
+    static bool s_footprint_logged = false;
+    char z_path[LOTTIE_ASSET_PATH_MAX];
+    struct stat st;
+
+    // 优先使用构建期生成的压缩版本
+    int n = snprintf(z_path, sizeof(z_path), "%s" LOTTIE_ASSET_Z_SUFFIX, path);
+    bool compressed = n > 0 && (size_t)n < sizeof(z_path) && stat(z_path, &st) == 0;
+    const char *real_path = compressed ? z_path : path;
+    if (!compressed && stat(path, &st) != 0) {
+        ESP_LOGE(TAG, "无法获取文件大小: %s", path);
+        return NULL;
+    }
+
+    FILE *fp = fopen(real_path, "rb");
+    if (!fp) {
+        ESP_LOGE(TAG, "无法打开文件: %s", real_path);
+        return NULL;
+    }
+    // 关闭stdio缓冲，数据直接读入目标缓冲区/解压窗口
+    setvbuf(fp, NULL, _IONBF, 0);
+
+    uint8_t *data;
+    if (compressed) {
+        if (!s_footprint_logged) {
+            ESP_LOGI(TAG, "解压器RAM占用: %u 字节 (状态 %u + 输入窗口 %u)",
+                     (unsigned)(sizeof(tinfl_decompressor) + LOTTIE_ASSET_CHUNK_SIZE),
+                     (unsigned)sizeof(tinfl_decompressor), (unsigned)LOTTIE_ASSET_CHUNK_SIZE);
+            s_footprint_logged = true;
+        }
+        data = asset_read_inflate(fp, (size_t)st.st_size, out_size, probe);
+    } else {
+        data = asset_read_raw(fp, (size_t)st.st_size, out_size, probe);
+    }
+    fclose(fp);
+
+    if (!data) {
+        ESP_LOGE(TAG, "资源读取失败: %s", real_path);
+    } else if (compressed) {
+        ESP_LOGI(TAG, "已解压 %s: %u -> %u 字节", real_path, (unsigned)st.st_size, (unsigned)*out_size);
+    }
+    return data;
+}
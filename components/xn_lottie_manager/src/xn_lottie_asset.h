@@ -0,0 +1,65 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Description: Lottie资源读取（分块读取 + 加载内存统计）
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// 分块读取大小：每次从文件系统读取的字节数（也是解压输入窗口大小）
+#define LOTTIE_ASSET_CHUNK_SIZE     4096
+
+// 构建期压缩资源（tools/lottie_assets.py）：
+//   文件名为 原路径 + ".z"，内容为 magic "LTZ1" + 原始长度(u32 LE) + raw deflate 数据流
+#define LOTTIE_ASSET_Z_SUFFIX       ".z"
+#define LOTTIE_ASSET_Z_MAGIC        "LTZ1"
+#define LOTTIE_ASSET_Z_HEADER_SIZE  8
+
+// 加载期间的PSRAM占用采样
+typedef struct {
+    size_t base_free;           // 开始加载时的空闲字节
+    size_t min_free;            // 加载期间采样到的最小空闲字节
+} lottie_mem_probe_t;
+
+/**
+ * @brief 开始一次加载内存采样
+ * @param probe 采样结构
+ */
+void lottie_mem_probe_begin(lottie_mem_probe_t *probe);
+
+/**
+ * @brief 采样当前空闲内存，更新最小值
+ * @param probe 采样结构，可为NULL
+ */
+void lottie_mem_probe_sample(lottie_mem_probe_t *probe);
+
+/**
+ * @brief 获取加载期间的峰值占用（相对开始加载时）
+ * @param probe 采样结构
+ * @return 峰值占用字节数
+ */
+size_t lottie_mem_probe_peak(const lottie_mem_probe_t *probe);
+
+/**
+ * @brief 资源是否存在（原始或压缩版本）
+ * @param path 文件路径（未压缩时的路径）
+ * @return true 存在
+ */
+bool lottie_asset_exists(const char *path);
+
+/**
+ * @brief 分块读取资源文件到一块PSRAM缓冲区（末尾补'\0'）
+ *
+ * 优先读取压缩版本（path + ".z"），压缩数据按 LOTTIE_ASSET_CHUNK_SIZE 分块读入
+ * 输入窗口并流式解压到目标缓冲区；未压缩文件按块直接读入目标缓冲区。
+ * 不使用stdio缓冲，加载期间只保留一份完整数据。
+ *
+ * @param path 文件路径（未压缩时的路径）
+ * @param out_size 输出数据长度（不含末尾'\0'）
+ * @param probe 内存采样，可为NULL
+ * @return 数据缓冲区（调用者用 heap_caps_free 释放），失败返回NULL
+ */
+uint8_t *lottie_asset_read(const char *path, size_t *out_size, lottie_mem_probe_t *probe);
@@ -0,0 +1,186 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Description: 无锁命令环形队列实现（有界多生产者/单消费者）
+ *
+ * 每个槽带序号：生产者通过CAS抢占写位置，写完后发布序号；
+ * 消费者在LVGL上下文中按序号取出。提交命令不需要任何互斥锁，也不会阻塞。
+ *
+ * 批量命令先存入按任务打开的批次（静态池），提交时整批作为一条命令入队，
+ * 消费者在同一次回调中执行完整批，中间状态不会被渲染。
+ *
+ * 外部驱动数值使用单值邮箱（序号锁）：生产者写入时序号为奇数，写完变为偶数，
+ * 读者只读一次，序号为奇数或前后不一致时视为无新值，下一帧再读（不自旋等待）。
+ * 新值直接覆盖旧值，不排队。
+ */
+
+#include "xn_lottie_cmd.h"
+#include "esp_timer.h"
+#include <stdatomic.h>
+#include <string.h>
+
+#define LOTTIE_CMD_RING_MASK (LOTTIE_CMD_RING_SIZE - 1)
+
+_Static_assert((LOTTIE_CMD_RING_SIZE & LOTTIE_CMD_RING_MASK) == 0, "命令队列容量必须为2的幂");
+
+typedef struct {
+    atomic_uint seq;
+    lottie_cmd_t cmd;
+} lottie_cmd_cell_t;
+
+static lottie_cmd_cell_t g_cells[LOTTIE_CMD_RING_SIZE];
+static atomic_uint g_enqueue_pos;
+static unsigned g_dequeue_pos;      // 仅消费者访问
+
+void lottie_cmd_ring_init(void)
+{
+    for (unsigned i = 0; i < LOTTIE_CMD_RING_SIZE; i++) {
+        atomic_store_explicit(&g_cells[i].seq, i, memory_order_relaxed);
+    }
+    atomic_store_explicit(&g_enqueue_pos, 0, memory_order_relaxed);
+    g_dequeue_pos = 0;
+}
+
+bool lottie_cmd_ring_push(const lottie_cmd_t *cmd)
+{
+    unsigned pos = atomic_load_explicit(&g_enqueue_pos, memory_order_relaxed);
+    lottie_cmd_cell_t *cell;
+
+    while (1) {
+        cell = &g_cells[pos & LOTTIE_CMD_RING_MASK];
+        unsigned seq = atomic_load_explicit(&cell->seq, memory_order_acquire);
+        int diff = (int)(seq - pos);
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&g_enqueue_pos, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return false;   // 队列满
+        } else {
+            pos = atomic_load_explicit(&g_enqueue_pos, memory_order_relaxed);
+        }
+    }
+
+    cell->cmd = *cmd;
+    atomic_store_explicit(&cell->seq, pos + 1, memory_order_release);
+    return true;
+}
+
+bool lottie_cmd_ring_pop(lottie_cmd_t *cmd)
+{
+    lottie_cmd_cell_t *cell = &g_cells[g_dequeue_pos & LOTTIE_CMD_RING_MASK];
+    unsigned seq = atomic_load_explicit(&cell->seq, memory_order_acquire);
+    if ((int)(seq - (g_dequeue_pos + 1)) < 0) {
+        return false;   // 队列空（或生产者尚未写完）
+    }
+
+    *cmd = cell->cmd;
+    atomic_store_explicit(&cell->seq, g_dequeue_pos + LOTTIE_CMD_RING_SIZE, memory_order_release);
+    g_dequeue_pos++;
+    return true;
+}
+
+// 外部驱动数值邮箱
+static atomic_uint g_drive_seq;
+static atomic_uint g_drive_value;       // float位模式
+static atomic_uint g_drive_post_lo;
+static atomic_uint g_drive_post_hi;
+
+void lottie_drive_mailbox_publish(float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    int64_t now = esp_timer_get_time();
+
+    unsigned seq = atomic_load_explicit(&g_drive_seq, memory_order_relaxed);
+    atomic_store_explicit(&g_drive_seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    atomic_store_explicit(&g_drive_value, bits, memory_order_relaxed);
+    atomic_store_explicit(&g_drive_post_lo, (uint32_t)now, memory_order_relaxed);
+    atomic_store_explicit(&g_drive_post_hi, (uint32_t)((uint64_t)now >> 32), memory_order_relaxed);
+    atomic_store_explicit(&g_drive_seq, seq + 2, memory_order_release);
+}
+
+bool lottie_drive_mailbox_read(uint32_t *seq, float *value, int64_t *post_us)
+{
+    unsigned s1, s2;
+    uint32_t bits, lo, hi;
+
+    s1 = atomic_load_explicit(&g_drive_seq, memory_order_acquire);
+    bits = atomic_load_explicit(&g_drive_value, memory_order_relaxed);
+    lo = atomic_load_explicit(&g_drive_post_lo, memory_order_relaxed);
+    hi = atomic_load_explicit(&g_drive_post_hi, memory_order_relaxed);
+    atomic_thread_fence(memory_order_acquire);
+    s2 = atomic_load_explicit(&g_drive_seq, memory_order_relaxed);
+
+    // 只读一次，不自旋：生产者可能在写入中途被LVGL任务抢占（同核、优先级更低），
+    // 自旋会一直等不到它写完；只保留最新值，下一帧再读即可
+    if ((s1 & 1) || s1 != s2 || s1 == *seq) {
+        return false;
+    }
+
+    *seq = s1;
+    memcpy(value, &bits, sizeof(bits));
+    *post_us = (int64_t)(((uint64_t)hi << 32) | lo);
+    return true;
+}
+
+// 命令批次池
+enum {
+    BATCH_FREE = 0,
+    BATCH_OPEN,
+    BATCH_CLOSED,
+};
+
+static lottie_cmd_batch_t g_batches[LOTTIE_CMD_BATCH_POOL];
+
+lottie_cmd_batch_t *lottie_cmd_batch_open(void *owner)
+{
+    if (lottie_cmd_batch_find(owner)) {
+        return NULL;    // 不支持嵌套
+    }
+
+    for (int i = 0; i < LOTTIE_CMD_BATCH_POOL; i++) {
+        lottie_cmd_batch_t *batch = &g_batches[i];
+        unsigned expected = BATCH_FREE;
+        if (atomic_compare_exchange_strong(&batch->state, &expected, BATCH_CLOSED)) {
+            batch->owner = owner;
+            batch->count = 0;
+            atomic_store_explicit(&batch->state, BATCH_OPEN, memory_order_release);
+            return batch;
+        }
+    }
+    return NULL;
+}
+
+lottie_cmd_batch_t *lottie_cmd_batch_find(void *owner)
+{
+    for (int i = 0; i < LOTTIE_CMD_BATCH_POOL; i++) {
+        lottie_cmd_batch_t *batch = &g_batches[i];
+        if (atomic_load_explicit(&batch->state, memory_order_acquire) == BATCH_OPEN &&
+            batch->owner == owner) {
+            return batch;
+        }
+    }
+    return NULL;
+}
+
+bool lottie_cmd_batch_add(lottie_cmd_batch_t *batch, const lottie_cmd_t *cmd)
+{
+    if (batch->count >= LOTTIE_CMD_BATCH_MAX) {
+        return false;
+    }
+    batch->cmds[batch->count++] = *cmd;
+    return true;
+}
+
+void lottie_cmd_batch_close(lottie_cmd_batch_t *batch)
+{
+    atomic_store_explicit(&batch->state, BATCH_CLOSED, memory_order_release);
+}
+
+void lottie_cmd_batch_release(lottie_cmd_batch_t *batch)
+{
+    batch->owner = NULL;
+    atomic_store_explicit(&batch->state, BATCH_FREE, memory_order_release);
+}
@@ -0,0 +1,202 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Description: Lottie管理器命令定义及无锁命令环形队列
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+// 命令中路径的最大长度
+#define LOTTIE_CMD_PATH_MAX         64
+
+// 插槽名最大长度（不含结尾'\0'，与 tools/lottie_assets.py 中 SLOT_NAME_MAX 一致）
+#define LOTTIE_SLOT_NAME_MAX        31
+
+// 命令环形队列容量（必须为2的幂）
+#define LOTTIE_CMD_RING_SIZE        16
+
+// 批量命令：每批最多的命令数，以及可同时打开/等待执行的批次数
+#define LOTTIE_CMD_BATCH_MAX        8
+#define LOTTIE_CMD_BATCH_POOL       2
+
+// 动画命令类型
+typedef enum {
+    LOTTIE_CMD_PLAY,            // 播放（按动画类型或路径）
+    LOTTIE_CMD_STOP,
+    LOTTIE_CMD_HIDE,
+    LOTTIE_CMD_SHOW,
+    LOTTIE_CMD_SET_POS,
+    LOTTIE_CMD_MOVE,            // 位置动画（复用pos数据）
+    LOTTIE_CMD_CENTER,
+    LOTTIE_CMD_SHOW_IMAGE,
+    LOTTIE_CMD_HIDE_IMAGE,
+    LOTTIE_CMD_IMAGE_READY,     // 内部命令：后台图片解码完成
+    LOTTIE_CMD_PUBLISH,         // 内部命令：后台动画加载完成，等待发布
+    LOTTIE_CMD_PRELOADED,       // 内部命令：预测预加载完成（复用publish数据，gen为预加载代数）
+    LOTTIE_CMD_LOAD_FAILED,     // 内部命令：后台加载或预加载失败
+    LOTTIE_CMD_DRIVE,           // 外部数值驱动帧开关
+    LOTTIE_CMD_OVERRIDE,        // 插槽属性覆盖（颜色/可见性）
+    LOTTIE_CMD_BATCH,           // 批量命令：在一次LVGL回调中依次执行，统一刷新
+    LOTTIE_CMD_TRACE,           // 命令流录制控制（开始/停止/导出/回放）
+} lottie_cmd_type_t;
+
+// 命令流录制操作
+typedef enum {
+    LOTTIE_TRACE_OP_START,
+    LOTTIE_TRACE_OP_STOP,
+    LOTTIE_TRACE_OP_DUMP,
+    LOTTIE_TRACE_OP_REPLAY,     // path为空时回放内存中的录制
+} lottie_trace_op_t;
+
+// 插槽覆盖类型
+typedef enum {
+    LOTTIE_OVERRIDE_COLOR,      // 填充/描边颜色，value为0xRRGGBB
+    LOTTIE_OVERRIDE_OPACITY,    // 不透明度，value为0~100
+    LOTTIE_OVERRIDE_CLEAR,      // 清除全部覆盖
+} lottie_override_kind_t;
+
+typedef struct lottie_cmd_batch lottie_cmd_batch_t;
+
+// 动画命令结构
+typedef struct {
+    lottie_cmd_type_t type;
+    int64_t post_us;            // 提交时间（用于统计命令延迟）
+    union {
+        struct {
+            int anim_type;      // 动画类型，-1表示按路径播放
+            char path[LOTTIE_CMD_PATH_MAX];
+            uint16_t width;
+            uint16_t height;
+            uint8_t quality;    // 渲染质量预设
+            uint8_t scale;      // 渲染比例模式
+            uint8_t flags;      // 播放器标志
+            bool center;        // true居中，false按(x, y)中心偏移对齐
+            int16_t x;
+            int16_t y;
+        } play;
+        struct {
+            int anim_type;      // -1表示停止当前动画
+        } stop;
+        struct {
+            int16_t x;
+            int16_t y;
+            uint16_t duration_ms;   // 仅 LOTTIE_CMD_MOVE 使用
+        } pos;
+        struct {
+            char path[LOTTIE_CMD_PATH_MAX];
+            uint16_t width;
+            uint16_t height;
+        } image;
+        struct {
+            char path[LOTTIE_CMD_PATH_MAX];
+            bool ok;
+        } image_ready;
+        struct {
+            bool enable;
+            int32_t start_frame;
+            int32_t end_frame;  // -1表示最后一帧
+        } drive;
+        struct {
+            char slot[LOTTIE_SLOT_NAME_MAX + 1];
+            lottie_override_kind_t kind;
+            uint32_t value;
+        } override;
+        struct {
+            lottie_cmd_batch_t *batch;
+        } batch;
+        struct {
+            lottie_trace_op_t op;
+            char path[LOTTIE_CMD_PATH_MAX];
+        } trace;
+        struct {
+            void *player;       // 已加载的 lottie_player_t
+            uint32_t gen;       // 发起加载时的播放代数，过期则丢弃
+            bool center;
+            int16_t x;
+            int16_t y;
+        } publish;
+        struct {
+            uint32_t gen;       // 失败的加载代数（preload 时为预加载代数）
+            bool preload;
+        } load_failed;
+    } data;
+} lottie_cmd_t;
+
+// 命令批次（静态池）：打开批次的任务提交的命令先存入批次，提交时作为一条命令入队
+struct lottie_cmd_batch {
+    atomic_uint state;          // 空闲/打开/已关闭，由 lottie_cmd_batch_* 维护
+    void *owner;                // 打开批次的任务
+    uint8_t count;
+    lottie_cmd_t cmds[LOTTIE_CMD_BATCH_MAX];
+};
+
+/**
+ * @brief 初始化命令环形队列
+ */
+void lottie_cmd_ring_init(void);
+
+/**
+ * @brief 提交命令（多生产者无锁，不阻塞）
+ * @param cmd 命令
+ * @return true 成功，false 队列满
+ */
+bool lottie_cmd_ring_push(const lottie_cmd_t *cmd);
+
+/**
+ * @brief 取出命令（单消费者，仅在LVGL上下文调用）
+ * @param cmd 输出命令
+ * @return true 取到命令，false 队列空
+ */
+bool lottie_cmd_ring_pop(lottie_cmd_t *cmd);
+
+/**
+ * @brief 发布外部驱动数值（单值邮箱，只保留最新值；单生产者，无锁不阻塞）
+ * @param value 数值
+ */
+void lottie_drive_mailbox_publish(float value);
+
+/**
+ * @brief 读取外部驱动数值（仅在LVGL上下文调用，不等待：生产者正在写入时返回 false）
+ * @param seq 上次读取的序号，读到新值时更新
+ * @param value 输出数值
+ * @param post_us 输出发布时间
+ * @return true 有新值，false 无新值或正在写入（下一帧重试）
+ */
+bool lottie_drive_mailbox_read(uint32_t *seq, float *value, int64_t *post_us);
+
+/**
+ * @brief 为任务打开一个批次
+ * @param owner 任务句柄
+ * @return 批次，该任务已有打开的批次或批次池已满时返回NULL
+ */
+lottie_cmd_batch_t *lottie_cmd_batch_open(void *owner);
+
+/**
+ * @brief 查找任务打开的批次（不含已入队的批次）
+ * @param owner 任务句柄
+ * @return 批次，未打开时返回NULL
+ */
+lottie_cmd_batch_t *lottie_cmd_batch_find(void *owner);
+
+/**
+ * @brief 向打开的批次追加命令（仅由批次所属任务调用）
+ * @param batch 批次
+ * @param cmd 命令
+ * @return true 成功，false 批次已满
+ */
+bool lottie_cmd_batch_add(lottie_cmd_batch_t *batch, const lottie_cmd_t *cmd);
+
+/**
+ * @brief 关闭批次，之后该任务提交的命令不再进入此批次（批次仍被占用，直到释放）
+ * @param batch 批次
+ */
+void lottie_cmd_batch_close(lottie_cmd_batch_t *batch);
+
+/**
+ * @brief 释放批次，归还批次池（批次执行完或未能入队时调用）
+ * @param batch 批次
+ */
+void lottie_cmd_batch_release(lottie_cmd_batch_t *batch);
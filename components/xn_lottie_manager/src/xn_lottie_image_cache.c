@@ -0,0 +1,425 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Description: Lottie管理器图片缓存实现
+ *
+ * 解码全部在后台任务完成：
+ *   - LVGL原生 .bin（构建期由 tools/lottie_assets.py 从PNG转换）：直接读入PSRAM
+ *   - PNG：LodePNG解码后转换为RGB565A8
+ * 显示时只需把缓存中的 lv_image_dsc_t 指针交给 lv_image，不会阻塞LVGL渲染。
+ */
+
+#include "xn_lottie_image_cache.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "src/libs/lodepng/lodepng.h"
+#include <string.h>
+#include <stdio.h>
+#include <strings.h>
+#include <sys/stat.h>
+
+static const char *TAG = "LOTTIE_IMG_CACHE";
+
+// 缓存槽状态
+typedef enum {
+    IMG_SLOT_EMPTY = 0,
+    IMG_SLOT_READY,
+    IMG_SLOT_EVICTING,
+} img_slot_state_t;
+
+// 缓存槽
+typedef struct {
+    img_slot_state_t state;
+    char path[LOTTIE_IMG_PATH_MAX];
+    lv_image_dsc_t dsc;         // 交给 lv_image 的描述符（地址在槽生命周期内不变）
+    uint8_t *data;              // 像素数据（PSRAM）
+    uint32_t refcnt;            // 正在显示的引用数，>0 时不可淘汰
+    uint32_t last_used;         // LRU 时间戳
+} img_slot_t;
+
+// 解码任务（PSRAM栈，LodePNG解码需要较大栈空间）
+#define IMG_DECODE_TASK_STACK_SIZE (1024*16/sizeof(StackType_t))
+static EXT_RAM_BSS_ATTR StackType_t img_decode_task_stack[IMG_DECODE_TASK_STACK_SIZE];
+static StaticTask_t img_decode_task_buffer;
+static TaskHandle_t g_decode_task = NULL;
+
+// 等待LVGL上下文回收淘汰槽的单次超时
+#define IMG_EVICT_WAIT_MS           1000
+
+static img_slot_t g_slots[LOTTIE_IMG_CACHE_SLOTS];
+static size_t g_total_bytes = 0;
+static uint32_t g_use_clock = 0;
+static SemaphoreHandle_t g_cache_mutex = NULL;
+static QueueHandle_t g_decode_queue = NULL;
+static lottie_img_ready_cb_t g_ready_cb = NULL;
+
+// 查找指定路径的就绪槽（调用者需持有互斥锁）
+static img_slot_t *img_slot_find(const char *path)
+{
+    for (int i = 0; i < LOTTIE_IMG_CACHE_SLOTS; i++) {
+        if (g_slots[i].state == IMG_SLOT_READY && strcmp(g_slots[i].path, path) == 0) {
+            return &g_slots[i];
+        }
+    }
+    return NULL;
+}
+
+// 淘汰一个槽（仅在解码任务中调用）
+// LVGL内部图片缓存以src指针为键，释放数据前必须先丢弃；丢弃在LVGL上下文的
+// lottie_img_cache_collect 中完成，这里只标记并等待，不跨任务持有LVGL锁
+static void img_slot_evict(img_slot_t *slot)
+{
+    xSemaphoreTake(g_cache_mutex, portMAX_DELAY);
+    slot->state = IMG_SLOT_EVICTING;
+    g_total_bytes -= slot->dsc.data_size;
+    xSemaphoreGive(g_cache_mutex);
+
+    ESP_LOGI(TAG, "淘汰图片: %s (%lu 字节)", slot->path, (unsigned long)slot->dsc.data_size);
+
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(IMG_EVICT_WAIT_MS));
+        xSemaphoreTake(g_cache_mutex, portMAX_DELAY);
+        bool done = slot->state == IMG_SLOT_EMPTY;
+        xSemaphoreGive(g_cache_mutex);
+        if (done) {
+            break;
+        }
+        ESP_LOGW(TAG, "等待LVGL回收淘汰槽: %s", slot->path);
+    }
+}
+
+// 为新图片腾出空间并返回空槽（仅在解码任务中调用）
+static img_slot_t *img_slot_alloc(size_t need_bytes)
+{
+    while (1) {
+        img_slot_t *empty = NULL;
+        img_slot_t *victim = NULL;
+
+        xSemaphoreTake(g_cache_mutex, portMAX_DELAY);
+        for (int i = 0; i < LOTTIE_IMG_CACHE_SLOTS; i++) {
+            img_slot_t *s = &g_slots[i];
+            if (s->state == IMG_SLOT_EMPTY && !empty) {
+                empty = s;
+            } else if (s->state == IMG_SLOT_READY && s->refcnt == 0 &&
+                       (!victim || s->last_used < victim->last_used)) {
+                victim = s;
+            }
+        }
+        bool fits = g_total_bytes + need_bytes <= LOTTIE_IMG_CACHE_BUDGET;
+        xSemaphoreGive(g_cache_mutex);
+
+        if (empty && fits) {
+            return empty;
+        }
+        if (!victim) {
+            // 全部被引用，超预算也只能放入空槽
+            return empty;
+        }
+        img_slot_evict(victim);
+    }
+}
+
+// 将 .png 路径替换为构建期生成的 .bin 路径
+static bool img_native_path(const char *path, char *out, size_t out_size)
+{
+    const char *ext = strrchr(path, '.');
+    if (!ext || strcasecmp(ext, ".png") != 0) {
+        return false;
+    }
+    int n = snprintf(out, out_size, "%.*s.bin", (int)(ext - path), path);
+    return n > 0 && (size_t)n < out_size;
+}
+
+static uint8_t *img_read_file(const char *path, size_t *out_size)
+{
+    FILE *fp = fopen(path, "rb");
+    if (!fp) {
+        return NULL;
+    }
+
+    fseek(fp, 0, SEEK_END);
+    size_t size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+
+    uint8_t *data = heap_caps_malloc(size, MALLOC_CAP_SPIRAM);
+    if (data && fread(data, 1, size, fp) != size) {
+        heap_caps_free(data);
+        data = NULL;
+    }
+    fclose(fp);
+
+    *out_size = size;
+    return data;
+}
+
+// 加载LVGL原生 .bin：文件头为 lv_image_header_t，其后是像素数据
+static bool img_load_native(const char *path, lv_image_dsc_t *dsc, uint8_t **out_data)
+{
+    size_t size = 0;
+    uint8_t *file = img_read_file(path, &size);
+    if (!file) {
+        return false;
+    }
+
+    if (size <= sizeof(lv_image_header_t)) {
+        heap_caps_free(file);
+        return false;
+    }
+
+    memcpy(&dsc->header, file, sizeof(lv_image_header_t));
+    if (dsc->header.magic != LV_IMAGE_HEADER_MAGIC) {
+        ESP_LOGE(TAG, "无效的图片文件头: %s", path);
+        heap_caps_free(file);
+        return false;
+    }
+
+    // 像素数据原地前移，省去一次额外分配
+    dsc->data_size = size - sizeof(lv_image_header_t);
+    memmove(file, file + sizeof(lv_image_header_t), dsc->data_size);
+    dsc->data = file;
+    *out_data = file;
+    return true;
+}
+
+// LodePNG解码PNG并转换为RGB565A8
+static bool img_decode_png(const char *path, lv_image_dsc_t *dsc, uint8_t **out_data)
+{
+    size_t size = 0;
+    uint8_t *file = img_read_file(path, &size);
+    if (!file) {
+        return false;
+    }
+
+    unsigned char *rgba = NULL;
+    unsigned w = 0, h = 0;
+    unsigned err = lodepng_decode32(&rgba, &w, &h, file, size);
+    heap_caps_free(file);
+    if (err) {
+        ESP_LOGE(TAG, "PNG解码失败: %s (%s)", path, lodepng_error_text(err));
+        return false;
+    }
+
+    size_t px = (size_t)w * h;
+    uint8_t *data = heap_caps_malloc(px * 3, MALLOC_CAP_SPIRAM);
+    if (!data) {
+        lv_free(rgba);
+        return false;
+    }
+
+    uint16_t *color = (uint16_t *)data;
+    uint8_t *alpha = data + px * 2;
+    for (size_t i = 0; i < px; i++) {
+        const uint8_t *p = &rgba[i * 4];
+        color[i] = ((p[0] & 0xF8) << 8) | ((p[1] & 0xFC) << 3) | (p[2] >> 3);
+        alpha[i] = p[3];
+    }
+    lv_free(rgba);
+
+    memset(&dsc->header, 0, sizeof(dsc->header));
+    dsc->header.magic = LV_IMAGE_HEADER_MAGIC;
+    dsc->header.cf = LV_COLOR_FORMAT_RGB565A8;
+    dsc->header.w = w;
+    dsc->header.h = h;
+    dsc->header.stride = w * 2;
+    dsc->data_size = px * 3;
+    dsc->data = data;
+    *out_data = data;
+    return true;
+}
+
+static bool img_decode(const char *path, lv_image_dsc_t *dsc, uint8_t **out_data)
+{
+    char native[LOTTIE_IMG_PATH_MAX];
+    struct stat st;
+
+    // 优先使用构建期预转换的原生格式
+    if (img_native_path(path, native, sizeof(native)) && stat(native, &st) == 0) {
+        return img_load_native(native, dsc, out_data);
+    }
+
+    const char *ext = strrchr(path, '.');
+    if (ext && strcasecmp(ext, ".bin") == 0) {
+        return img_load_native(path, dsc, out_data);
+    }
+    if (ext && strcasecmp(ext, ".png") == 0) {
+        return img_decode_png(path, dsc, out_data);
+    }
+    return false;
+}
+
+// 后台解码任务
+static void img_decode_task(void *pvParameters)
+{
+    char path[LOTTIE_IMG_PATH_MAX];
+
+    ESP_LOGI(TAG, "图片解码任务启动");
+
+    while (1) {
+        if (xQueueReceive(g_decode_queue, path, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+
+        // 重复预取：已在缓存中则直接通知
+        xSemaphoreTake(g_cache_mutex, portMAX_DELAY);
+        bool cached = img_slot_find(path) != NULL;
+        xSemaphoreGive(g_cache_mutex);
+        if (cached) {
+            if (g_ready_cb) {
+                g_ready_cb(path, true);
+            }
+            continue;
+        }
+
+        int64_t start = esp_timer_get_time();
+        lv_image_dsc_t dsc = {0};
+        uint8_t *data = NULL;
+        bool ok = img_decode(path, &dsc, &data);
+
+        if (ok) {
+            img_slot_t *slot = img_slot_alloc(dsc.data_size);
+            if (slot) {
+                xSemaphoreTake(g_cache_mutex, portMAX_DELAY);
+                snprintf(slot->path, sizeof(slot->path), "%s", path);
+                slot->dsc = dsc;
+                slot->data = data;
+                slot->refcnt = 0;
+                slot->last_used = ++g_use_clock;
+                slot->state = IMG_SLOT_READY;
+                g_total_bytes += dsc.data_size;
+                xSemaphoreGive(g_cache_mutex);
+                ESP_LOGI(TAG, "图片已缓存: %s (%dx%d, %lu 字节, %lld us)", path,
+                         dsc.header.w, dsc.header.h, (unsigned long)dsc.data_size,
+                         esp_timer_get_time() - start);
+            } else {
+                ESP_LOGW(TAG, "缓存槽已满且均在使用中: %s", path);
+                heap_caps_free(data);
+                ok = false;
+            }
+        } else {
+            ESP_LOGW(TAG, "图片无法预解码: %s", path);
+        }
+
+        if (g_ready_cb) {
+            g_ready_cb(path, ok);
+        }
+    }
+}
+
+esp_err_t lottie_img_cache_init(lottie_img_ready_cb_t ready_cb)
+{
+    if (g_decode_queue) {
+        return ESP_OK;
+    }
+
+    g_ready_cb = ready_cb;
+
+    g_cache_mutex = xSemaphoreCreateMutex();
+    if (!g_cache_mutex) {
+        ESP_LOGE(TAG, "创建缓存互斥锁失败");
+        return ESP_ERR_NO_MEM;
+    }
+
+    g_decode_queue = xQueueCreate(LOTTIE_IMG_CACHE_SLOTS, LOTTIE_IMG_PATH_MAX);
+    if (!g_decode_queue) {
+        ESP_LOGE(TAG, "创建解码队列失败");
+        vSemaphoreDelete(g_cache_mutex);
+        g_cache_mutex = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+
+    g_decode_task = xTaskCreateStatic(
+                            img_decode_task,              // 任务函数
+                            "lottie_img",                 // 任务名称
+                            IMG_DECODE_TASK_STACK_SIZE,   // 栈大小
+                            NULL,                         // 任务参数
+                            2,                            // 优先级2（低于动画管理任务）
+                            img_decode_task_stack,        // 栈数组(PSRAM)
+                            &img_decode_task_buffer       // 任务控制块(内部RAM)
+                        );
+    if (!g_decode_task) {
+        ESP_LOGE(TAG, "创建图片解码任务失败");
+        vQueueDelete(g_decode_queue);
+        g_decode_queue = NULL;
+        vSemaphoreDelete(g_cache_mutex);
+        g_cache_mutex = NULL;
+        return ESP_FAIL;
+    }
+
+    return ESP_OK;
+}
+
+bool lottie_img_cache_prefetch(const char *path)
+{
+    if (!g_decode_queue || !path) {
+        return false;
+    }
+
+    char buf[LOTTIE_IMG_PATH_MAX];
+    snprintf(buf, sizeof(buf), "%s", path);
+    return xQueueSend(g_decode_queue, buf, 0) == pdTRUE;
+}
+
+const lv_image_dsc_t *lottie_img_cache_acquire(const char *path)
+{
+    if (!g_cache_mutex || !path) {
+        return NULL;
+    }
+
+    const lv_image_dsc_t *dsc = NULL;
+    xSemaphoreTake(g_cache_mutex, portMAX_DELAY);
+    img_slot_t *slot = img_slot_find(path);
+    if (slot) {
+        slot->refcnt++;
+        slot->last_used = ++g_use_clock;
+        dsc = &slot->dsc;
+    }
+    xSemaphoreGive(g_cache_mutex);
+    return dsc;
+}
+
+void lottie_img_cache_release(const lv_image_dsc_t *dsc)
+{
+    if (!g_cache_mutex || !dsc) {
+        return;
+    }
+
+    xSemaphoreTake(g_cache_mutex, portMAX_DELAY);
+    for (int i = 0; i < LOTTIE_IMG_CACHE_SLOTS; i++) {
+        if (&g_slots[i].dsc == dsc && g_slots[i].refcnt > 0) {
+            g_slots[i].refcnt--;
+            break;
+        }
+    }
+    xSemaphoreGive(g_cache_mutex);
+}
+
+void lottie_img_cache_collect(void)
+{
+    if (!g_cache_mutex) {
+        return;
+    }
+
+    bool collected = false;
+    xSemaphoreTake(g_cache_mutex, portMAX_DELAY);
+    for (int i = 0; i < LOTTIE_IMG_CACHE_SLOTS; i++) {
+        img_slot_t *slot = &g_slots[i];
+        if (slot->state != IMG_SLOT_EVICTING) {
+            continue;
+        }
+        lv_image_cache_drop(&slot->dsc);
+        heap_caps_free(slot->data);
+        slot->data = NULL;
+        slot->path[0] = '\0';
+        slot->state = IMG_SLOT_EMPTY;
+        collected = true;
+    }
+    xSemaphoreGive(g_cache_mutex);
+
+    if (collected) {
+        xTaskNotifyGive(g_decode_task);
+    }
+}
@@ -0,0 +1,61 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Description: Lottie管理器图片缓存（后台解码 + 预取）
+ */
+
+#pragma once
+
+#include "lvgl.h"
+#include "esp_err.h"
+#include <stdbool.h>
+
+// 缓存槽数量
+#define LOTTIE_IMG_CACHE_SLOTS      6
+
+// 缓存总字节预算（PSRAM），超出时按LRU淘汰未被使用的图片
+#define LOTTIE_IMG_CACHE_BUDGET     (1024 * 1024)
+
+// 图片路径最大长度（与命令结构中的路径长度一致）
+#define LOTTIE_IMG_PATH_MAX         64
+
+/**
+ * @brief 图片解码完成回调（在解码任务上下文中调用，不可操作LVGL对象）
+ * @param path 图片路径（与预取时传入的路径一致）
+ * @param ok 是否解码成功
+ */
+typedef void (*lottie_img_ready_cb_t)(const char *path, bool ok);
+
+/**
+ * @brief 初始化图片缓存及后台解码任务
+ * @param ready_cb 解码完成回调，可为NULL
+ * @return ESP_OK 成功
+ */
+esp_err_t lottie_img_cache_init(lottie_img_ready_cb_t ready_cb);
+
+/**
+ * @brief 请求后台解码图片（非阻塞，已缓存或正在解码时直接返回true）
+ * @param path 图片路径
+ * @return true 已缓存或已加入解码队列，false 队列满
+ */
+bool lottie_img_cache_prefetch(const char *path);
+
+/**
+ * @brief 获取已解码图片并增加引用（不会触发解码）
+ * @param path 图片路径
+ * @return 图片描述符，未就绪时返回NULL
+ */
+const lv_image_dsc_t *lottie_img_cache_acquire(const char *path);
+
+/**
+ * @brief 释放通过 lottie_img_cache_acquire 获取的图片引用
+ * @param dsc 图片描述符，可为NULL
+ */
+void lottie_img_cache_release(const lv_image_dsc_t *dsc);
+
+/**
+ * @brief 回收已淘汰的缓存槽（仅在LVGL上下文调用）
+ *
+ * 解码任务淘汰图片时只做标记，由本函数丢弃LVGL内部缓存并释放像素数据，
+ * 避免解码任务跨任务获取LVGL锁。
+ */
+void lottie_img_cache_collect(void);
@@ -5,273 +5,1295 @@
  * @LastEditTime: 2025-11-25 17:13:18
  * @FilePath: \xn_esp32_lottie\components\xn_lottie_manager\src\xn_lottie_manager.c
  * @Description: 简单的Lottie动画管理器实现
+ *
+ * 管理器以Actor方式运行：所有公共接口只向无锁命令队列提交命令，
+ * 命令由LVGL定时器在LVGL任务上下文中依次执行（无需 lv_lock）。
+ * 耗时的动画加载交给 lottie_task 在后台完成，完成后再提交发布命令。
  */
 
  #include "xn_lottie_manager.h"
+ #include "xn_lottie_cmd.h"
+ #include "xn_lottie_asset.h"
+ #include "xn_lottie_predict.h"
+ #include "xn_lottie_arena.h"
+ #include "xn_lottie_trace.h"
+ #include "xn_lottie_image_cache.h"
+ #include "xn_lottie_player.h"
  #include "xn_lvgl.h"
  #include "esp_log.h"
  #include "esp_heap_caps.h"
- #include "esp_task_wdt.h"
+ #include "esp_timer.h"
  #include "freertos/FreeRTOS.h"
  #include "freertos/task.h"
  #include "freertos/queue.h"
  #include "esp_spiffs.h"
+ #include "nvs_flash.h"
+ #include <stdatomic.h>
  #include <string.h>
  #include <stdio.h>
  
  static const char *TAG = "LOTTIE_MANAGER";
  
- // 动画命令类型
- typedef enum {
-     LOTTIE_CMD_PLAY,
-     LOTTIE_CMD_PLAY_AT_POS,
-     LOTTIE_CMD_STOP,
-     LOTTIE_CMD_HIDE,
-     LOTTIE_CMD_SHOW,
-     LOTTIE_CMD_SET_POS,
-     LOTTIE_CMD_CENTER,
-     LOTTIE_CMD_SHOW_IMAGE,
-     LOTTIE_CMD_HIDE_IMAGE
- } lottie_cmd_type_t;
- 
- // 动画命令结构
+ // 命令处理定时器周期（LVGL上下文）：提交命令时会唤醒LVGL任务立即处理，
+ // 周期只用于兜底，以及预加载、图片缓存回收等后台轮询
+ #define LOTTIE_CMD_POLL_MS      50
+ 
+ // 后台任务提交加载结果时命令队列满的重试次数（每次间隔 LOTTIE_CMD_POLL_MS）
+ #define LOTTIE_RESULT_POST_RETRIES  20
+ 
+ // 渲染质量预设
+ #define LOTTIE_QUALITY_AUTO     0   // 按目标尺寸自动选择LOD
+ #define LOTTIE_QUALITY_HIGH     1   // 原始数据，全帧率
+ #define LOTTIE_QUALITY_MEDIUM   2   // LOD1简化数据，全帧率
+ #define LOTTIE_QUALITY_LOW      3   // LOD2简化数据（去虚线），半帧率
+ 
+ // 自动LOD的尺寸阈值（与 tools/lottie_assets.py 中 LOD_LEVELS 的参考尺寸对应）
+ #define LOTTIE_LOD1_MAX_SIZE    288
+ #define LOTTIE_LOD2_MAX_SIZE    160
+ 
+ // 渲染比例模式：缩小渲染后由 lv_image 拉伸到目标尺寸
+ #define LOTTIE_SCALE_FULL       0   // 原始尺寸
+ #define LOTTIE_SCALE_3_4        1   // 3/4尺寸
+ #define LOTTIE_SCALE_1_2        2   // 1/2尺寸
+ #define LOTTIE_SCALE_DYNAMIC    3   // 从原始尺寸开始，连续超出帧预算时逐级降低
+ 
+ static const uint16_t render_scales_q8[] = {
+     [LOTTIE_SCALE_FULL]    = LOTTIE_SCALE_Q8_FULL,
+     [LOTTIE_SCALE_3_4]     = LOTTIE_SCALE_Q8_3_4,
+     [LOTTIE_SCALE_1_2]     = LOTTIE_SCALE_Q8_1_2,
+     [LOTTIE_SCALE_DYNAMIC] = LOTTIE_SCALE_Q8_FULL,
+ };
+ 
+ // 质量预设参数
  typedef struct {
-     lottie_cmd_type_t type;
-     union {
-         struct {
-             int anim_type;
-         } play;
-         struct {
-             int anim_type;
-             int16_t x;
-             int16_t y;
-         } play_at_pos;
-         struct {
-             int anim_type;
-         } stop;
-         struct {
-             int16_t x;
-             int16_t y;
-         } pos;
-         struct {
-             char path[64];
-             uint16_t width;
-             uint16_t height;
-         } image;
-     } data;
- } lottie_cmd_t;
+     int8_t lod;             // 使用的LOD变体，-1表示按尺寸自动选择
+     uint8_t frame_step;     // 帧步长，2表示只渲染偶数帧
+ } lottie_quality_preset_t;
+ 
+ static const lottie_quality_preset_t quality_presets[] = {
+     [LOTTIE_QUALITY_AUTO]   = {-1, 1},
+     [LOTTIE_QUALITY_HIGH]   = { 0, 1},
+     [LOTTIE_QUALITY_MEDIUM] = { 1, 1},
+     [LOTTIE_QUALITY_LOW]    = { 2, 2},
+ };
  
  // 动画配置结构
  typedef struct {
      const char *file_path;
      uint16_t width;
      uint16_t height;
+     uint8_t quality;        // 渲染质量预设 LOTTIE_QUALITY_*
+     uint8_t scale;          // 渲染比例 LOTTIE_SCALE_*
+     uint8_t flags;          // 播放器标志 LOTTIE_PLAYER_FLAG_*
  } lottie_anim_config_t;
  
  // 动画配置表 - 全屏显示配置（屏幕尺寸：412x412）
  static const lottie_anim_config_t anim_configs[] = {
-     [LOTTIE_ANIM_WIFI]    = {"/lottie/loading.json",        256, 256},  // WiFi加载
-     [LOTTIE_ANIM_MIC]     = {"/lottie/emoji_kaixin.json",   128, 128},  // mic
-     [LOTTIE_ANIM_SPEAK]   = {"/lottie/speak.json",          400, 277},  // 说话
-     [LOTTIE_ANIM_THINK]   = {"/lottie/emoji_think.json",    400, 400},  // 思考
-     [LOTTIE_ANIM_COOL]    = {"/lottie/emoji_cool.json",     400, 400},  // 酷
-     [LOTTIE_ANIM_LOADING] = {"/lottie/loading.json",        200, 200},  // 通用加载
-     [LOTTIE_ANIM_OTA]     = {"/lottie/loading.json",        400, 400},  // OTA升级动画
+     [LOTTIE_ANIM_WIFI]    = {"/lottie/loading.json",        256, 256, LOTTIE_QUALITY_AUTO, LOTTIE_SCALE_FULL,    0},  // WiFi加载
+     [LOTTIE_ANIM_MIC]     = {"/lottie/emoji_kaixin.json",   128, 128, LOTTIE_QUALITY_AUTO, LOTTIE_SCALE_FULL,    0},  // mic
+     [LOTTIE_ANIM_SPEAK]   = {"/lottie/speak.json",          400, 277, LOTTIE_QUALITY_HIGH, LOTTIE_SCALE_DYNAMIC, 0},  // 说话
+     [LOTTIE_ANIM_THINK]   = {"/lottie/emoji_think.json",    400, 400, LOTTIE_QUALITY_AUTO, LOTTIE_SCALE_DYNAMIC, 0},  // 思考
+     [LOTTIE_ANIM_COOL]    = {"/lottie/emoji_cool.json",     400, 400, LOTTIE_QUALITY_AUTO, LOTTIE_SCALE_DYNAMIC, 0},  // 酷
+     [LOTTIE_ANIM_LOADING] = {"/lottie/loading.json",        200, 200, LOTTIE_QUALITY_AUTO, LOTTIE_SCALE_FULL,    0},  // 通用加载
+     [LOTTIE_ANIM_OTA]     = {"/lottie/loading.json",        400, 400, LOTTIE_QUALITY_LOW,  LOTTIE_SCALE_1_2,     0},  // OTA升级动画（后台升级，降低CPU占用）
      // 可以继续添加更多动画配置...
  };
  
  #define ANIM_CONFIG_COUNT (sizeof(anim_configs) / sizeof(anim_configs[0]))
  
- // 静态任务相关 - 参考main.c的实现
- #define LOTTIE_TASK_STACK_SIZE (1024*350/sizeof(StackType_t))  // 8KB栈
+ // 预测预加载：当前动画发布后空闲多久开始预加载最可能的下一个动画
+ #define LOTTIE_PRELOAD_IDLE_MS      500
+ // 预加载内存预算：渲染缓冲区超过该值的动画不预加载
+ #define LOTTIE_PRELOAD_MEM_BUDGET   (1024 * 1024)
+ // 预加载后PSRAM至少保留的空闲字节
+ #define LOTTIE_PRELOAD_MIN_FREE     (1024 * 1024)
+ // 转移表最短保存间隔（减少Flash擦写）
+ #define LOTTIE_PREDICT_SAVE_MS      (60 * 1000)
+ 
+ // 后台加载任务（ThorVG解析需要较大栈空间）
+ #define LOTTIE_TASK_STACK_SIZE (1024*350/sizeof(StackType_t))
  static EXT_RAM_BSS_ATTR StackType_t lottie_task_stack[LOTTIE_TASK_STACK_SIZE];  // PSRAM栈
  static StaticTask_t lottie_task_buffer;  // 内部RAM控制块
  
- // 全局变量管理
+ // 后台加载任务的工作项
+ typedef struct {
+     lottie_player_t *destroy;   // 非NULL时仅销毁该播放器
+     bool profile;               // true时只测量各渲染比例的耗时和误差，不发布
+     bool preload;               // true时为预测预加载，完成后不发布，等待播放请求认领
+     bool save_predict;          // true时仅保存转移表快照到NVS
+     lottie_trace_t *trace_dump; // 非NULL时仅输出该命令流快照到日志
+     char path[LOTTIE_CMD_PATH_MAX];
+     uint16_t width;
+     uint16_t height;
+     uint8_t lod;                // LOD变体，0为原始数据
+     uint8_t frame_step;
+     uint8_t flags;              // 播放器标志
+     uint16_t scale_q8;          // 初始渲染比例
+     uint32_t gen;
+     bool center;
+     int16_t x;
+     int16_t y;
+ } lottie_load_job_t;
+ 
+ // 全局变量管理（除标注外，均只在LVGL上下文中访问）
  static lv_obj_t *g_lottie_obj = NULL;
- static uint8_t *g_lottie_buffer = NULL;
+ static lottie_player_t *g_player = NULL;    // 当前发布的播放器
  static bool g_initialized = false;
  static int g_current_anim_type = -1;  // 当前播放的动画类型
- static QueueHandle_t g_cmd_queue = NULL;
+ static uint32_t g_load_gen = 0;       // 播放代数，每次播放/停止递增，用于丢弃过期的加载结果
+ static QueueHandle_t g_load_queue = NULL;
  static TaskHandle_t g_anim_task = NULL;
- static SemaphoreHandle_t g_anim_mutex = NULL;  // 动画操作互斥锁
- static volatile bool g_anim_busy = false;      // 动画是否正在操作中
- static lv_obj_t *g_image_obj = NULL;          // 图片对象
+ static lv_timer_t *g_cmd_timer = NULL;
+ static lv_obj_t *g_image_obj = NULL;          // 图片对象（隐藏时保留，复用于下次显示）
+ static const lv_image_dsc_t *g_image_dsc = NULL;  // 当前显示的缓存图片
+ static char g_pending_image[LOTTIE_IMG_PATH_MAX];  // 等待后台解码完成后显示的图片
+ static uint16_t g_pending_width = 0;
+ static uint16_t g_pending_height = 0;
+ 
+ // 命令统计
+ static lottie_manager_stats_t g_stats;
+ static uint64_t g_latency_sum_us = 0;
+ static atomic_uint g_cmd_dropped;      // 任意任务访问
+ 
+ // 外部数值驱动帧（LVGL上下文）
+ static bool g_drive_enabled = false;
+ static int32_t g_drive_start = 0;
+ static int32_t g_drive_end = -1;
+ static uint32_t g_drive_seq = 0;           // 已读取的邮箱序号
+ static int64_t g_drive_pending_us = 0;     // 已渲染、等待刷屏完成的数值发布时间
+ static uint64_t g_drive_latency_sum_us = 0;
+ 
+ // 预测预加载（LVGL上下文）
+ static int g_last_anim_type = -1;          // 上一次按类型播放的动画（停止后保留，用于记录转移）
+ static bool g_load_inflight = false;       // 播放请求的加载尚未发布
+ static int64_t g_idle_since_us = 0;        // 最近一次播放/发布/停止的时间
+ static int g_predicted_from = -1;          // 已为哪个动画做过预测（每次切换只预测一次）
+ static int g_preload_type = -1;            // 预加载中或已完成的动画类型，-1表示无
+ static uint32_t g_preload_gen = 0;         // 预加载代数，取消时递增
+ static lottie_player_t *g_preload_player = NULL;  // 已完成的预加载
+ static bool g_preload_claimed = false;     // 预加载完成前已被播放请求认领
+ static bool g_preload_center = true;       // 认领时的显示位置
+ static int16_t g_preload_x = 0;
+ static int16_t g_preload_y = 0;
+ static int64_t g_play_post_us = 0;         // 当前播放请求的提交时间（统计首帧延迟）
+ static bool g_play_hit = false;            // 当前播放请求是否命中预加载
+ static uint64_t g_cold_latency_sum_us = 0;
+ static uint64_t g_hit_latency_sum_us = 0;
+ static int64_t g_predict_save_us = 0;      // 上次保存转移表的时间
+ 
+ // 插槽属性覆盖表（LVGL上下文），跨播放保留，直到清除
+ #define LOTTIE_OVERRIDE_MAX     8
  
- // 实际执行动画播放的内部函数
- static bool _lottie_play_internal(int anim_type)
+ typedef struct {
+     char slot[LOTTIE_SLOT_NAME_MAX + 1];
+     lottie_override_kind_t kind;
+     uint32_t value;
+ } lottie_override_t;
+ 
+ static lottie_override_t g_overrides[LOTTIE_OVERRIDE_MAX];
+ static int g_override_count = 0;
+ 
+ // 提交命令（任意任务，无锁不阻塞）；当前任务打开了批次时存入批次
+ static bool _lottie_post(lottie_cmd_t *cmd)
  {
-     if (anim_type < 0 || anim_type >= ANIM_CONFIG_COUNT) {
-         ESP_LOGE(TAG, "无效的动画类型: %d", anim_type);
+     cmd->post_us = esp_timer_get_time();
+ 
+     lottie_cmd_batch_t *batch = lottie_cmd_batch_find(xTaskGetCurrentTaskHandle());
+     if (batch) {
+         if (!lottie_cmd_batch_add(batch, cmd)) {
+             atomic_fetch_add(&g_cmd_dropped, 1);
+             ESP_LOGE(TAG, "批次已满，丢弃命令: %d", cmd->type);
+             return false;
+         }
+         return true;
+     }
+ 
+     if (!lottie_cmd_ring_push(cmd)) {
+         atomic_fetch_add(&g_cmd_dropped, 1);
+         ESP_LOGE(TAG, "命令队列已满，丢弃命令: %d", cmd->type);
          return false;
      }
+     lvgl_driver_wakeup();
+     return true;
+ }
  
-     const lottie_anim_config_t *config = &anim_configs[anim_type];
-     if (!config->file_path) {
-         ESP_LOGE(TAG, "动画类型 %d 未配置", anim_type);
+ // 交给后台任务销毁播放器（销毁涉及大量释放，不放在LVGL上下文中）
+ static void _lottie_destroy_async(lottie_player_t *player)
+ {
+     if (!player) {
+         return;
+     }
+ 
+     lottie_load_job_t job = { .destroy = player };
+     if (xQueueSend(g_load_queue, &job, 0) != pdTRUE) {
+         lottie_player_destroy(player);
+     }
+ }
+ 
+ // 构建期生成的变体路径：name.json -> name.<tag>.json，变体不存在时返回false
+ static bool _lottie_variant_path(const char *path, const char *tag, char *buf, size_t buf_size)
+ {
+     const char *ext = strrchr(path, '.');
+     if (!ext) {
          return false;
      }
+     int n = snprintf(buf, buf_size, "%.*s.%s%s", (int)(ext - path), path, tag, ext);
+     return n > 0 && (size_t)n < buf_size && lottie_asset_exists(buf);
+ }
  
-     ESP_LOGI(TAG, "播放动画类型: %d", anim_type);
+ // 选择LOD变体路径：name.json -> name.lodN.json，变体不存在时使用原始数据
+ static const char *_lottie_lod_path(const lottie_load_job_t *job, char *buf, size_t buf_size)
+ {
+     char tag[8];
  
-     // 直接使用现有的lottie_manager_play函数
-     bool result = lottie_manager_play(config->file_path, config->width, config->height);
-     if (result) {
-         g_current_anim_type = anim_type;
+     if (job->lod == 0) {
+         return job->path;
      }
+     snprintf(tag, sizeof(tag), "lod%u", job->lod);
+     return _lottie_variant_path(job->path, tag, buf, buf_size) ? buf : job->path;
+ }
  
-     return result;
+ // 后台任务提交加载/解码结果：结果不能丢（否则加载状态无法复位、待显示的图片不再出现），
+ // 队列满时等LVGL任务取走命令后重试
+ static bool _lottie_post_result(lottie_cmd_t *cmd)
+ {
+     for (int i = 0; i < LOTTIE_RESULT_POST_RETRIES; i++) {
+         cmd->post_us = esp_timer_get_time();
+         if (lottie_cmd_ring_push(cmd)) {
+             lvgl_driver_wakeup();
+             return true;
+         }
+         vTaskDelay(pdMS_TO_TICKS(LOTTIE_CMD_POLL_MS));
+     }
+     atomic_fetch_add(&g_cmd_dropped, 1);
+     ESP_LOGE(TAG, "命令队列持续已满，丢弃后台结果: %d", cmd->type);
+     return false;
  }
  
- // 实际执行动画播放并设置位置的内部函数
- static bool _lottie_play_at_pos_internal(int anim_type, int16_t x, int16_t y)
+ // 通知LVGL任务加载失败，复位加载/预加载状态
+ static void _lottie_post_load_failed(const lottie_load_job_t *job)
  {
-     if (anim_type < 0 || anim_type >= ANIM_CONFIG_COUNT) {
-         ESP_LOGE(TAG, "无效的动画类型: %d", anim_type);
-         return false;
+     lottie_cmd_t cmd;
+     cmd.type = LOTTIE_CMD_LOAD_FAILED;
+     cmd.data.load_failed.gen = job->gen;
+     cmd.data.load_failed.preload = job->preload;
+     _lottie_post_result(&cmd);
+ }
+ 
+ // 后台加载：解析、场景构建和首帧光栅化，完成后提交发布命令，失败时提交失败命令
+ static void _lottie_load_job(const lottie_load_job_t *job)
+ {
+     lottie_mem_probe_t probe;
+     lottie_mem_probe_begin(&probe);
+ 
+     char lod_path[LOTTIE_CMD_PATH_MAX + 8];
+     const char *path = _lottie_lod_path(job, lod_path, sizeof(lod_path));
+ 
+     size_t file_size = 0;
+     uint8_t *file_data = lottie_asset_read(path, &file_size, &probe);
+     if (!file_data) {
+         if (!job->profile) {
+             _lottie_post_load_failed(job);
+         }
+         return;
+     }
+     ESP_LOGI(TAG, "Lottie JSON 文件: %s, 大小: %u 字节", path, (unsigned)file_size);
+ 
+     // 构建工具拆出了静态背景时，动画部分不再满屏覆盖
+     char bg_path[LOTTIE_CMD_PATH_MAX + 8];
+     bool has_bg = _lottie_variant_path(job->path, "bg", bg_path, sizeof(bg_path));
+     uint8_t flags = has_bg ? (job->flags & ~LOTTIE_PLAYER_FLAG_OPAQUE) : job->flags;
+ 
+     int64_t load_start = esp_timer_get_time();
+     // 播放器接管 file_data
+     lottie_player_t *player = lottie_player_load(file_data, file_size, job->width, job->height,
+                                                  job->scale_q8, flags);
+     lottie_mem_probe_sample(&probe);
+     if (!player) {
+         ESP_LOGE(TAG, "动画加载失败: %s", path);
+         if (!job->profile) {
+             _lottie_post_load_failed(job);
+         }
+         return;
      }
  
-     const lottie_anim_config_t *config = &anim_configs[anim_type];
-     if (!config->file_path) {
-         ESP_LOGE(TAG, "动画类型 %d 未配置", anim_type);
-         return false;
+     // 静态背景只在加载时光栅化一次（测量时只关心动画部分）
+     if (has_bg && !job->profile) {
+         size_t bg_size = 0;
+         uint8_t *bg_data = lottie_asset_read(bg_path, &bg_size, &probe);
+         if (!bg_data || !lottie_player_load_background(player, bg_data, bg_size)) {
+             ESP_LOGE(TAG, "静态背景加载失败: %s", bg_path);
+         }
+         lottie_mem_probe_sample(&probe);
+     }
+     // 静止区间与LOD无关，所有变体共用 name.hold
+     char hold_path[LOTTIE_CMD_PATH_MAX + 8];
+     const char *ext = strrchr(job->path, '.');
+     int base_len = ext ? (int)(ext - job->path) : (int)strlen(job->path);
+     int n = snprintf(hold_path, sizeof(hold_path), "%.*s.hold", base_len, job->path);
+     if (n > 0 && (size_t)n < sizeof(hold_path) && lottie_asset_exists(hold_path)) {
+         size_t hold_size = 0;
+         uint8_t *hold_data = lottie_asset_read(hold_path, &hold_size, &probe);
+         if (hold_data && lottie_player_load_holds(player, hold_data, hold_size)) {
+             ESP_LOGI(TAG, "静止区间: %u 段", player->hold_count);
+         }
+     }
+     player->frame_step = job->frame_step;
+     player->lod = (path == job->path) ? 0 : job->lod;
+     ESP_LOGI(TAG, "动画加载完成: %lld us, 总帧数: %d, 加载峰值内存: %u 字节",
+              esp_timer_get_time() - load_start, (int)player->total_frames,
+              (unsigned)lottie_mem_probe_peak(&probe));
+ 
+     if (job->profile) {
+         lottie_player_profile_scales(player);
+         lottie_player_destroy(player);
+         return;
+     }
+ 
+     lottie_cmd_t cmd;
+     cmd.type = job->preload ? LOTTIE_CMD_PRELOADED : LOTTIE_CMD_PUBLISH;
+     cmd.data.publish.player = player;
+     cmd.data.publish.gen = job->gen;
+     cmd.data.publish.center = job->center;
+     cmd.data.publish.x = job->x;
+     cmd.data.publish.y = job->y;
+     if (!_lottie_post_result(&cmd)) {
+         lottie_player_destroy(player);
+     }
+ }
+ 
+ // 后台加载任务
+ static void lottie_task(void *pvParameters)
+ {
+     lottie_load_job_t job;
+ 
+     ESP_LOGI(TAG, "动画加载任务启动");
+     // 进入场景分区前预热，渲染器和C库的按需状态留在通用堆
+     lottie_player_warmup();
+ 
+     while (1) {
+         if (xQueueReceive(g_load_queue, &job, portMAX_DELAY) != pdTRUE) {
+             continue;
+         }
+ 
+         if (job.destroy) {
+             lottie_player_destroy(job.destroy);
+         } else if (job.save_predict) {
+             lottie_predict_save();
+         } else if (job.trace_dump) {
+             lottie_trace_dump(job.trace_dump);
+             heap_caps_free(job.trace_dump);
+         } else {
+             _lottie_load_job(&job);
+         }
+     }
+ }
+ 
+ // 动画帧回调（LVGL任务上下文）：渲染新帧并刷新
+ static void _lottie_anim_exec_cb(void *var, int32_t v)
+ {
+     lottie_player_t *player = (lottie_player_t *)var;
+ 
+     // 动态比例：连续超出帧预算时降低渲染比例，缓冲区尺寸变化需重新设置图片源
+     uint16_t scale_q8 = lottie_player_scale_downgrade(player);
+     if (scale_q8 && g_lottie_obj) {
+         lv_image_cache_drop(&player->dsc);
+         if (lottie_player_set_scale(player, scale_q8)) {
+             lv_image_set_src(g_lottie_obj, &player->dsc);
+             ESP_LOGW(TAG, "超出帧预算，渲染比例降为 %u/256 (%dx%d)", scale_q8,
+                      player->render_width, player->render_height);
+         }
+     }
+ 
+     // 与上一次渲染之间跳过的帧（刷新间隔超过动画帧间隔时LVGL动画直接跳帧）
+     int32_t last = player->last_frame;
+     int32_t step = player->frame_step > 1 ? player->frame_step : 1;
+     int32_t frame = v - v % step;
+     uint32_t dropped = (last >= 0 && frame > last + step) ? (uint32_t)((frame - last) / step - 1) : 0;
+ 
+     if (lottie_player_render(player, v) && g_lottie_obj) {
+         lv_obj_invalidate(g_lottie_obj);
+         lottie_trace_note_frame(dropped);
+     }
+ }
+ 
+ // 启动播放器的循环动画
+ static void _lottie_start_anim(lottie_player_t *player)
+ {
+     lv_anim_t a;
+     lv_anim_init(&a);
+     lv_anim_set_var(&a, player);
+     lv_anim_set_exec_cb(&a, _lottie_anim_exec_cb);
+     lv_anim_set_values(&a, 0, (int32_t)player->total_frames - 1);
+     lv_anim_set_duration(&a, (uint32_t)(player->duration * 1000));
+     lv_anim_set_repeat_count(&a, LV_ANIM_REPEAT_INFINITE);
+     lv_anim_start(&a);
+ }
+ 
+ // 解除当前播放器与显示对象的关联，返回旧播放器
+ static lottie_player_t *_lottie_unpublish(void)
+ {
+     lottie_player_t *old = g_player;
+     g_player = NULL;
+     if (old) {
+         lv_anim_delete(old, NULL);
+         lv_image_cache_drop(&old->dsc);
+         if (old->bg_buf) {
+             lv_image_cache_drop(&old->bg_dsc);
+         }
+         if (old->render_count > 0) {
+             ESP_LOGI(TAG, "LOD%u 步长%u 平均光栅化: %lu us/帧 (%lu 帧, 静止跳过 %lu 帧)", old->lod,
+                      old->frame_step, (unsigned long)(old->render_us_total / old->render_count),
+                      (unsigned long)old->render_count, (unsigned long)old->hold_skipped);
+         }
+         g_stats.hold_skipped += old->hold_skipped;
+     }
+     return old;
+ }
+ 
+ // 将覆盖表拼接为插槽JSON并应用到播放器，返回是否需要重新渲染
+ static bool _lottie_apply_overrides(lottie_player_t *player)
+ {
+     char json[LOTTIE_OVERRIDE_MAX * (LOTTIE_SLOT_NAME_MAX + 48) + 4];
+     size_t len = 0;
+ 
+     if (g_override_count == 0) {
+         return lottie_player_override(player, NULL);
+     }
+ 
+     json[len++] = '{';
+     for (int i = 0; i < g_override_count; i++) {
+         const lottie_override_t *o = &g_overrides[i];
+         int n;
+         if (o->kind == LOTTIE_OVERRIDE_COLOR) {
+             n = snprintf(json + len, sizeof(json) - len, "%s\"%s\":{\"p\":{\"a\":0,\"k\":[%.3f,%.3f,%.3f]}}",
+                          i ? "," : "", o->slot,
+                          ((o->value >> 16) & 0xFF) / 255.0f,
+                          ((o->value >> 8) & 0xFF) / 255.0f,
+                          (o->value & 0xFF) / 255.0f);
+         } else {
+             n = snprintf(json + len, sizeof(json) - len, "%s\"%s\":{\"p\":{\"a\":0,\"k\":%lu}}",
+                          i ? "," : "", o->slot, (unsigned long)o->value);
+         }
+         if (n <= 0 || (size_t)n >= sizeof(json) - len - 1) {
+             ESP_LOGE(TAG, "插槽JSON过长");
+             return false;
+         }
+         len += n;
+     }
+     json[len++] = '}';
+     json[len] = '\0';
+ 
+     return lottie_player_override(player, json);
+ }
+ 
+ // 更新覆盖表并立即应用到当前动画
+ static void _lottie_override_internal(const lottie_cmd_t *cmd)
+ {
+     lottie_override_kind_t kind = cmd->data.override.kind;
+ 
+     if (kind == LOTTIE_OVERRIDE_CLEAR) {
+         g_override_count = 0;
+     } else {
+         int i;
+         for (i = 0; i < g_override_count; i++) {
+             if (strcmp(g_overrides[i].slot, cmd->data.override.slot) == 0) {
+                 break;
+             }
+         }
+         if (i == g_override_count) {
+             if (g_override_count >= LOTTIE_OVERRIDE_MAX) {
+                 ESP_LOGE(TAG, "覆盖表已满，忽略插槽: %s", cmd->data.override.slot);
+                 return;
+             }
+             snprintf(g_overrides[i].slot, sizeof(g_overrides[i].slot), "%s", cmd->data.override.slot);
+             g_override_count++;
+         }
+         g_overrides[i].kind = kind;
+         g_overrides[i].value = cmd->data.override.value;
+     }
+ 
+     if (!g_player) {
+         return;
+     }
+ 
+     // 场景无需重新解析，只重新光栅化当前帧
+     int32_t frame = g_player->last_frame;
+     if (!_lottie_apply_overrides(g_player)) {
+         return;
+     }
+     if (lottie_player_render(g_player, frame < 0 ? 0 : frame) && g_lottie_obj) {
+         lv_obj_invalidate(g_lottie_obj);
+     }
+ }
+ 
+ // 按质量预设和目标尺寸选择LOD
+ static uint8_t _lottie_pick_lod(const lottie_quality_preset_t *preset, uint16_t width, uint16_t height)
+ {
+     if (preset->lod >= 0) {
+         return (uint8_t)preset->lod;
+     }
+ 
+     uint16_t size = width > height ? width : height;
+     if (size <= LOTTIE_LOD2_MAX_SIZE) {
+         return 2;
+     }
+     if (size <= LOTTIE_LOD1_MAX_SIZE) {
+         return 1;
+     }
+     return 0;
+ }
+ 
+ // 发布：原子交换显示对象的图片源
+ static void _lottie_publish_internal(const lottie_cmd_t *cmd)
+ {
+     lottie_player_t *player = (lottie_player_t *)cmd->data.publish.player;
+ 
+     if (cmd->data.publish.gen != g_load_gen) {
+         // 加载期间又有新的播放/停止请求，结果已过期
+         ESP_LOGI(TAG, "丢弃过期的加载结果 (gen %lu != %lu)",
+                  (unsigned long)cmd->data.publish.gen, (unsigned long)g_load_gen);
+         _lottie_destroy_async(player);
+         return;
+     }
+ 
+     if (!g_lottie_obj) {
+         g_lottie_obj = lv_image_create(lv_screen_active());
+         if (!g_lottie_obj) {
+             ESP_LOGE(TAG, "创建 Lottie 显示对象失败");
+             g_load_inflight = false;
+             _lottie_destroy_async(player);
+             return;
+         }
+         // 缩小渲染的缓冲区拉伸到对象尺寸显示（原始比例时不做变换）
+         lv_image_set_inner_align(g_lottie_obj, LV_IMAGE_ALIGN_STRETCH);
+     }
+ 
+     // 首帧已在后台渲染，有覆盖时在显示前按覆盖后的属性重新渲染
+     if (g_override_count > 0 && _lottie_apply_overrides(player)) {
+         lottie_player_render(player, 0);
+     }
+ 
+     lottie_player_t *old = _lottie_unpublish();
+     g_player = player;
+     lv_image_set_src(g_lottie_obj, &player->dsc);
+     // 静态背景作为对象的背景图片，绘制在动画帧下方，随对象一起移动/隐藏
+     lv_obj_set_style_bg_image_src(g_lottie_obj, player->bg_buf ? &player->bg_dsc : NULL, 0);
+     lv_obj_set_size(g_lottie_obj, player->width, player->height);
+     if (cmd->data.publish.center) {
+         lv_obj_center(g_lottie_obj);
+     } else {
+         lv_obj_align(g_lottie_obj, LV_ALIGN_CENTER, cmd->data.publish.x, cmd->data.publish.y);
+     }
+     lv_obj_clear_flag(g_lottie_obj, LV_OBJ_FLAG_HIDDEN);
+     lv_obj_invalidate(g_lottie_obj);
+     if (g_drive_enabled) {
+         g_drive_seq = 1;    // 邮箱序号总为偶数，强制新播放器读取当前值
+     } else {
+         _lottie_start_anim(player);
+     }
+ 
+     _lottie_destroy_async(old);
+ 
+     // 首帧延迟：播放请求提交到新动画发布
+     int64_t now = esp_timer_get_time();
+     uint32_t latency_us = (uint32_t)(now - g_play_post_us);
+     if (g_play_hit) {
+         g_hit_latency_sum_us += latency_us;
+         g_stats.first_frame_hit_count++;
+         g_stats.first_frame_hit_avg_us = (uint32_t)(g_hit_latency_sum_us / g_stats.first_frame_hit_count);
+     } else {
+         g_cold_latency_sum_us += latency_us;
+         g_stats.first_frame_cold_count++;
+         g_stats.first_frame_cold_avg_us = (uint32_t)(g_cold_latency_sum_us / g_stats.first_frame_cold_count);
+     }
+     lottie_trace_note_switch(latency_us);
+     g_load_inflight = false;
+     g_idle_since_us = now;
+     g_predicted_from = -1;
+     ESP_LOGI(TAG, "动画播放成功，首帧延迟 %lu us%s", (unsigned long)latency_us, g_play_hit ? "（预加载）" : "");
+ }
+ 
+ // 按播放参数填充加载任务
+ static void _lottie_fill_job(lottie_load_job_t *job, const char *path, uint16_t width, uint16_t height,
+                              uint8_t quality, uint8_t scale, uint8_t flags)
+ {
+     const lottie_quality_preset_t *preset = &quality_presets[quality];
+     snprintf(job->path, sizeof(job->path), "%s", path);
+     job->width = width;
+     job->height = height;
+     job->lod = _lottie_pick_lod(preset, width, height);
+     job->frame_step = preset->frame_step;
+     job->flags = flags;
+     job->scale_q8 = render_scales_q8[scale];
+     if (scale == LOTTIE_SCALE_DYNAMIC) {
+         job->flags |= LOTTIE_PLAYER_FLAG_DYNAMIC_SCALE;
+     }
+ }
+ 
+ // 丢弃预加载（进行中的预加载通过代数作废，完成后由后台任务销毁）
+ static void _lottie_preload_discard(void)
+ {
+     if (g_preload_type < 0) {
+         return;
+     }
+ 
+     ESP_LOGI(TAG, "丢弃未命中的预加载: %d", g_preload_type);
+     g_stats.preload_wasted++;
+     g_preload_gen++;
+     _lottie_destroy_async(g_preload_player);
+     g_preload_player = NULL;
+     g_preload_type = -1;
+     g_preload_claimed = false;
+ }
+ 
+ // 发布已完成的预加载
+ static void _lottie_preload_publish(void)
+ {
+     lottie_cmd_t cmd;
+     cmd.type = LOTTIE_CMD_PUBLISH;
+     cmd.data.publish.player = g_preload_player;
+     cmd.data.publish.gen = g_load_gen;
+     cmd.data.publish.center = g_preload_center;
+     cmd.data.publish.x = g_preload_x;
+     cmd.data.publish.y = g_preload_y;
+ 
+     g_preload_player = NULL;
+     g_preload_type = -1;
+     g_preload_claimed = false;
+     _lottie_publish_internal(&cmd);
+ }
+ 
+ // 预加载完成：已被播放请求认领则立即发布，否则保留等待
+ static void _lottie_preloaded_internal(const lottie_cmd_t *cmd)
+ {
+     lottie_player_t *player = (lottie_player_t *)cmd->data.publish.player;
+ 
+     if (cmd->data.publish.gen != g_preload_gen || g_preload_type < 0) {
+         _lottie_destroy_async(player);
+         return;
+     }
+ 
+     g_preload_player = player;
+     ESP_LOGI(TAG, "预加载完成: %d%s", g_preload_type, g_preload_claimed ? "，已被认领" : "");
+     if (g_preload_claimed) {
+         _lottie_preload_publish();
+     }
+ }
+ 
+ // 空闲时预加载最可能的下一个动画，并定期保存转移表（LVGL上下文）
+ static void _lottie_preload_poll(void)
+ {
+     int64_t now = esp_timer_get_time();
+ 
+     // 写Flash交给后台任务
+     if (now - g_predict_save_us >= LOTTIE_PREDICT_SAVE_MS * 1000LL && lottie_predict_begin_save()) {
+         lottie_load_job_t job = { .save_predict = true };
+         if (xQueueSend(g_load_queue, &job, 0) == pdTRUE) {
+             g_predict_save_us = now;
+         } else {
+             lottie_predict_abort_save();
+         }
+     }
+ 
+     if (g_load_inflight || g_preload_type >= 0 || g_last_anim_type < 0 ||
+         g_predicted_from == g_last_anim_type ||
+         now - g_idle_since_us < LOTTIE_PRELOAD_IDLE_MS * 1000LL) {
+         return;
+     }
+     g_predicted_from = g_last_anim_type;
+ 
+     uint8_t share = 0;
+     int next = lottie_predict_next(g_last_anim_type, &share);
+     if (next < 0 || next >= (int)ANIM_CONFIG_COUNT || !anim_configs[next].file_path) {
+         return;
+     }
+ 
+     const lottie_anim_config_t *config = &anim_configs[next];
+     size_t buf_size = (size_t)config->width * config->height * 4;
+     size_t free_size = heap_caps_get_free_size(MALLOC_CAP_SPIRAM);
+     if (buf_size > LOTTIE_PRELOAD_MEM_BUDGET || free_size < buf_size + LOTTIE_PRELOAD_MIN_FREE) {
+         ESP_LOGI(TAG, "预测下一个动画: %d (%u%%)，超出预加载内存预算，跳过 (空闲 %u 字节)",
+                  next, share, (unsigned)free_size);
+         return;
+     }
+ 
+     lottie_load_job_t job = {0};
+     job.preload = true;
+     _lottie_fill_job(&job, config->file_path, config->width, config->height,
+                      config->quality, config->scale, config->flags);
+     job.gen = ++g_preload_gen;
+     if (xQueueSend(g_load_queue, &job, 0) != pdTRUE) {
+         return;
+     }
+ 
+     g_preload_type = next;
+     g_stats.preload_issued++;
+     ESP_LOGI(TAG, "预加载预测的下一个动画: %d (%u%%)", next, share);
+ }
+ 
+ // 提交普通加载任务，当前动画继续播放直到新动画发布
+ static void _lottie_load_start(int anim_type, const char *path, uint16_t width, uint16_t height,
+                                uint8_t quality, uint8_t scale, uint8_t flags,
+                                bool center, int16_t x, int16_t y)
+ {
+     lottie_load_job_t job = {0};
+     _lottie_fill_job(&job, path, width, height, quality, scale, flags);
+     job.gen = ++g_load_gen;
+     job.center = center;
+     job.x = x;
+     job.y = y;
+ 
+     ESP_LOGI(TAG, "播放动画: %s (%dx%d), 类型: %d, 当前动画: %d",
+              job.path, job.width, job.height, anim_type, g_current_anim_type);
+ 
+     if (xQueueSend(g_load_queue, &job, 0) != pdTRUE) {
+         ESP_LOGE(TAG, "加载队列已满: %s", job.path);
+         return;
      }
+     g_current_anim_type = anim_type;
+     g_load_inflight = true;
+ }
  
-     ESP_LOGI(TAG, "播放动画类型: %d，中心偏移: (%d, %d)", anim_type, x, y);
+ // 播放：交给后台任务加载，当前动画继续播放直到新动画发布
+ static void _lottie_play_internal(const lottie_cmd_t *cmd)
+ {
+     int anim_type = cmd->data.play.anim_type;
  
-     // 直接使用新的lottie_manager_play_at_pos函数
-     bool result = lottie_manager_play_at_pos(config->file_path, config->width, config->height, x, y);
-     if (result) {
+     // 记录切换，用于预测下一个动画
+     if (anim_type >= 0) {
+         lottie_predict_record(g_last_anim_type, anim_type);
+         g_last_anim_type = anim_type;
+     }
+     g_idle_since_us = esp_timer_get_time();
+     g_play_post_us = cmd->post_us;
+ 
+     if (anim_type >= 0 && anim_type == g_preload_type) {
+         // 命中预加载：已完成则直接发布，否则等待预加载完成后发布
+         ESP_LOGI(TAG, "播放动画类型 %d: 命中预加载%s", anim_type, g_preload_player ? "" : "（加载中）");
+         g_stats.preload_hits++;
+         g_play_hit = true;
+         g_load_gen++;   // 取消其他进行中的加载
          g_current_anim_type = anim_type;
+         g_preload_center = cmd->data.play.center;
+         g_preload_x = cmd->data.play.x;
+         g_preload_y = cmd->data.play.y;
+         if (g_preload_player) {
+             _lottie_preload_publish();
+         } else {
+             g_preload_claimed = true;
+             g_load_inflight = true;
+         }
+         return;
      }
  
-     return result;
+     if (anim_type >= 0) {
+         g_stats.preload_misses++;
+     }
+     _lottie_preload_discard();
+     g_play_hit = false;
+     _lottie_load_start(anim_type, cmd->data.play.path, cmd->data.play.width, cmd->data.play.height,
+                        cmd->data.play.quality, cmd->data.play.scale, cmd->data.play.flags,
+                        cmd->data.play.center, cmd->data.play.x, cmd->data.play.y);
+ }
+ 
+ // 加载失败：复位加载状态；已被认领的预加载失败时改为普通加载
+ static void _lottie_load_failed_internal(const lottie_cmd_t *cmd)
+ {
+     if (cmd->data.load_failed.preload) {
+         if (cmd->data.load_failed.gen != g_preload_gen || g_preload_type < 0) {
+             return;
+         }
+         int anim_type = g_preload_type;
+         bool claimed = g_preload_claimed;
+         ESP_LOGW(TAG, "预加载失败: %d%s", anim_type, claimed ? "，改为普通加载" : "");
+         g_preload_type = -1;
+         g_preload_claimed = false;
+         if (claimed) {
+             const lottie_anim_config_t *config = &anim_configs[anim_type];
+             g_load_inflight = false;
+             g_play_hit = false;
+             _lottie_load_start(anim_type, config->file_path, config->width, config->height,
+                                config->quality, config->scale, config->flags,
+                                g_preload_center, g_preload_x, g_preload_y);
+         }
+         return;
+     }
+ 
+     if (cmd->data.load_failed.gen != g_load_gen) {
+         return;
+     }
+     ESP_LOGW(TAG, "动画加载失败，保留当前显示");
+     g_load_inflight = false;
+     g_idle_since_us = esp_timer_get_time();
  }
  
- // 停止动画的内部函数
+ // 位置动画回调：只修改对象位置，LVGL用已渲染的缓冲区重新合成，不触发光栅化
+ static void _lottie_move_x_cb(void *var, int32_t v)
+ {
+     lv_obj_set_x((lv_obj_t *)var, v);
+ }
+ 
+ static void _lottie_move_y_cb(void *var, int32_t v)
+ {
+     lv_obj_set_y((lv_obj_t *)var, v);
+ }
+ 
+ // 取消进行中的位置动画
+ static void _lottie_move_cancel(void)
+ {
+     lv_anim_delete(g_lottie_obj, _lottie_move_x_cb);
+     lv_anim_delete(g_lottie_obj, _lottie_move_y_cb);
+ }
+ 
+ // 以显示刷新节奏把对象移动到 (x, y)（与 lv_obj_set_pos 相同的坐标含义）
+ static void _lottie_move_internal(const lottie_cmd_t *cmd)
+ {
+     if (!g_lottie_obj) {
+         return;
+     }
+ 
+     _lottie_move_cancel();
+     if (cmd->data.pos.duration_ms == 0) {
+         lv_obj_set_pos(g_lottie_obj, cmd->data.pos.x, cmd->data.pos.y);
+         return;
+     }
+ 
+     int32_t from[2] = {lv_obj_get_x_aligned(g_lottie_obj), lv_obj_get_y_aligned(g_lottie_obj)};
+     int32_t to[2] = {cmd->data.pos.x, cmd->data.pos.y};
+     lv_anim_exec_xcb_t cbs[2] = {_lottie_move_x_cb, _lottie_move_y_cb};
+ 
+     for (int i = 0; i < 2; i++) {
+         if (from[i] == to[i]) {
+             continue;
+         }
+         lv_anim_t a;
+         lv_anim_init(&a);
+         lv_anim_set_var(&a, g_lottie_obj);
+         lv_anim_set_exec_cb(&a, cbs[i]);
+         lv_anim_set_values(&a, from[i], to[i]);
+         lv_anim_set_duration(&a, cmd->data.pos.duration_ms);
+         lv_anim_set_path_cb(&a, lv_anim_path_ease_in_out);
+         lv_anim_start(&a);
+     }
+ }
+ 
+ // 停止动画
  static void _lottie_stop_internal(int anim_type)
  {
      // -1 表示停止所有动画，或者检查是否是当前播放的动画类型
-     if (anim_type == -1 || anim_type == g_current_anim_type) {
-         ESP_LOGI(TAG, "停止动画类型: %d (当前: %d)", anim_type, g_current_anim_type);
+     if (anim_type != -1 && anim_type != g_current_anim_type) {
+         ESP_LOGW(TAG, "动画类型 %d 未在播放中，当前播放: %d", anim_type, g_current_anim_type);
+         return;
+     }
+ 
+     ESP_LOGI(TAG, "停止动画类型: %d (当前: %d)", anim_type, g_current_anim_type);
+ 
+     g_load_gen++;   // 取消正在进行的加载
+     g_current_anim_type = -1;
+     g_load_inflight = false;
+     g_preload_claimed = false;     // 已完成的预加载保留，供下次播放
+     g_idle_since_us = esp_timer_get_time();
+ 
+     lottie_player_t *old = _lottie_unpublish();
+     if (g_lottie_obj) {
+         // 显示对象保留复用，只解除对渲染缓冲区的引用
+         lv_obj_add_flag(g_lottie_obj, LV_OBJ_FLAG_HIDDEN);
+         lv_image_set_src(g_lottie_obj, NULL);
+         lv_obj_set_style_bg_image_src(g_lottie_obj, NULL, 0);
+     }
+ 
+     // LVGL已不再引用旧缓冲区，交给后台任务释放
+     _lottie_destroy_async(old);
+ }
+ 
+ // 外部数值驱动开关
+ static void _lottie_drive_internal(const lottie_cmd_t *cmd)
+ {
+     g_drive_enabled = cmd->data.drive.enable;
+     g_drive_start = cmd->data.drive.start_frame;
+     g_drive_end = cmd->data.drive.end_frame;
+     g_drive_seq = 1;
+     g_drive_pending_us = 0;
+ 
+     ESP_LOGI(TAG, "外部数值驱动: %s (帧 %ld ~ %ld)", g_drive_enabled ? "开启" : "关闭",
+              (long)g_drive_start, (long)g_drive_end);
+ 
+     if (g_player) {
+         lv_anim_delete(g_player, NULL);
+         if (!g_drive_enabled) {
+             _lottie_start_anim(g_player);
+         }
+     }
+ }
+ 
+ // 每次刷新开始时读取最新驱动值并渲染对应帧（LVGL上下文）
+ static void _lottie_refr_start_cb(lv_event_t *e)
+ {
+     (void)e;
+     float value;
+     int64_t post_us;
+ 
+     if (!g_drive_enabled || !g_player || !g_lottie_obj ||
+         lv_obj_has_flag(g_lottie_obj, LV_OBJ_FLAG_HIDDEN) ||
+         !lottie_drive_mailbox_read(&g_drive_seq, &value, &post_us)) {
+         return;
+     }
+ 
+     int32_t last = (int32_t)g_player->total_frames - 1;
+     int32_t start = g_drive_start < 0 ? 0 : (g_drive_start > last ? last : g_drive_start);
+     int32_t end = (g_drive_end < 0 || g_drive_end > last) ? last : g_drive_end;
+     value = value < 0.0f ? 0.0f : (value > 1.0f ? 1.0f : value);
+     int32_t frame = start + (int32_t)((end - start) * value + 0.5f);
+ 
+     if (lottie_player_render(g_player, frame)) {
+         lv_obj_invalidate(g_lottie_obj);
+         g_drive_pending_us = post_us;
+     }
+ }
+ 
+ // 刷新完成：统计从数值发布到刷屏完成的延迟
+ static void _lottie_refr_ready_cb(lv_event_t *e)
+ {
+     (void)e;
+     if (!g_drive_pending_us) {
+         return;
+     }
+ 
+     uint32_t latency_us = (uint32_t)(esp_timer_get_time() - g_drive_pending_us);
+     g_drive_pending_us = 0;
+     g_stats.drive_frames++;
+     g_drive_latency_sum_us += latency_us;
+     g_stats.drive_latency_avg_us = (uint32_t)(g_drive_latency_sum_us / g_stats.drive_frames);
+     if (latency_us > g_stats.drive_latency_max_us) {
+         g_stats.drive_latency_max_us = latency_us;
+     }
+ }
  
-         // 直接使用现有的lottie_manager_stop函数
-         lottie_manager_stop();
-         g_current_anim_type = -1;
+ // 将图片源设置到图片对象并显示
+ static void _lottie_image_apply(const void *src, uint16_t width, uint16_t height)
+ {
+     if (!g_image_obj) {
+         g_image_obj = lv_image_create(lv_screen_active());
+         if (!g_image_obj) {
+             ESP_LOGE(TAG, "❌ 创建图片对象失败");
+             return;
+         }
+         ESP_LOGI(TAG, "图片对象创建成功");
+     }
+ 
+     lv_image_set_src(g_image_obj, src);
+     if (width > 0 && height > 0) {
+         lv_obj_set_size(g_image_obj, width, height);
      } else {
-         ESP_LOGW(TAG, "动画类型 %d 未在播放中，当前播放: %d", anim_type, g_current_anim_type);
+         lv_obj_set_size(g_image_obj, LV_SIZE_CONTENT, LV_SIZE_CONTENT);
      }
+     lv_obj_center(g_image_obj);
+     lv_obj_clear_flag(g_image_obj, LV_OBJ_FLAG_HIDDEN);
  }
  
- // 动画处理静态任务 - 参考main.c的lvgl_timer_task
- static void lottie_task(void *pvParameters)
+ // 显示图片：缓存命中时仅交换图片指针，未命中时交给后台解码
+ static void _lottie_show_image_internal(const char *path, uint16_t width, uint16_t height)
+ {
+     if (g_lottie_obj) {
+         lv_obj_add_flag(g_lottie_obj, LV_OBJ_FLAG_HIDDEN);
+         ESP_LOGI(TAG, "已隐藏Lottie动画");
+     }
+ 
+     const lv_image_dsc_t *dsc = lottie_img_cache_acquire(path);
+     if (dsc) {
+         _lottie_image_apply(dsc, width, height);
+         lottie_img_cache_release(g_image_dsc);
+         g_image_dsc = dsc;
+         g_pending_image[0] = '\0';
+         ESP_LOGI(TAG, "✅ 图片显示成功(缓存): %s", path);
+         return;
+     }
+ 
+     // 未缓存：后台解码完成后由 LOTTIE_CMD_IMAGE_READY 显示
+     snprintf(g_pending_image, sizeof(g_pending_image), "%s", path);
+     g_pending_width = width;
+     g_pending_height = height;
+     if (!lottie_img_cache_prefetch(path)) {
+         // 解码队列已满，退回到LVGL按路径解码
+         ESP_LOGW(TAG, "解码队列已满，直接按路径显示: %s", path);
+         g_pending_image[0] = '\0';
+         _lottie_image_apply(path, width, height);
+         lottie_img_cache_release(g_image_dsc);
+         g_image_dsc = NULL;
+     }
+ }
+ 
+ // 后台解码完成
+ static void _lottie_image_ready_internal(const char *path, bool ok)
+ {
+     if (g_pending_image[0] == '\0' || strcmp(g_pending_image, path) != 0) {
+         return;  // 仅预取，或已被新的显示/隐藏请求取代
+     }
+ 
+     if (ok) {
+         _lottie_show_image_internal(path, g_pending_width, g_pending_height);
+     } else {
+         // 无法预解码的格式（如JPG），退回到LVGL按路径解码
+         g_pending_image[0] = '\0';
+         _lottie_image_apply(path, g_pending_width, g_pending_height);
+         lottie_img_cache_release(g_image_dsc);
+         g_image_dsc = NULL;
+         ESP_LOGI(TAG, "✅ 图片显示成功(路径): %s", path);
+     }
+ }
+ 
+ // 隐藏图片并恢复动画
+ static void _lottie_hide_image_internal(void)
+ {
+     g_pending_image[0] = '\0';
+     if (g_image_obj) {
+         // 仅隐藏，保留对象供下次显示复用
+         lv_obj_add_flag(g_image_obj, LV_OBJ_FLAG_HIDDEN);
+         lv_image_set_src(g_image_obj, NULL);
+         ESP_LOGI(TAG, "图片已隐藏");
+     }
+     lottie_img_cache_release(g_image_dsc);
+     g_image_dsc = NULL;
+     if (g_lottie_obj && g_player) {
+         lv_obj_clear_flag(g_lottie_obj, LV_OBJ_FLAG_HIDDEN);
+         ESP_LOGI(TAG, "已恢复Lottie动画");
+     }
+ }
+ 
+ // 解码任务回调：转交给LVGL上下文执行
+ static void _lottie_image_ready_cb(const char *path, bool ok)
  {
      lottie_cmd_t cmd;
+     cmd.type = LOTTIE_CMD_IMAGE_READY;
+     snprintf(cmd.data.image_ready.path, sizeof(cmd.data.image_ready.path), "%s", path);
+     cmd.data.image_ready.ok = ok;
+     // 在解码任务中调用：显示图片时动画已隐藏，丢掉这条命令屏幕会一直空白
+     _lottie_post_result(&cmd);
+ }
  
-     ESP_LOGI(TAG, "动画处理任务启动");
+ // 命令流录制控制
+ static void _lottie_trace_internal(const lottie_cmd_t *cmd)
+ {
+     switch (cmd->data.trace.op) {
+     case LOTTIE_TRACE_OP_START:
+         lottie_trace_start();
+         break;
+ 
+     case LOTTIE_TRACE_OP_STOP:
+         lottie_trace_stop();
+         break;
+ 
+     case LOTTIE_TRACE_OP_DUMP: {
+         // 输出日志较慢，交给后台任务
+         lottie_load_job_t job = { .trace_dump = lottie_trace_snapshot() };
+         if (job.trace_dump && xQueueSend(g_load_queue, &job, 0) != pdTRUE) {
+             ESP_LOGW(TAG, "加载队列已满，放弃导出命令流");
+             heap_caps_free(job.trace_dump);
+         }
+         break;
+     }
  
-     while (1) {
-         if (xQueueReceive(g_cmd_queue, &cmd, portMAX_DELAY) == pdTRUE) {
-             switch (cmd.type) {
-             case LOTTIE_CMD_PLAY:
-                 _lottie_play_internal(cmd.data.play.anim_type);
-                 break;
+     case LOTTIE_TRACE_OP_REPLAY:
+         // 回放的命令不再录制
+         lottie_trace_stop();
+         if (cmd->data.trace.path[0]) {
+             lottie_trace_replay_start(NULL, cmd->data.trace.path);
+         } else {
+             lottie_trace_t *trace = lottie_trace_snapshot();
+             if (trace) {
+                 lottie_trace_replay_start(trace, NULL);
+             }
+         }
+         break;
+     }
+ }
  
-             case LOTTIE_CMD_PLAY_AT_POS:
-                 _lottie_play_at_pos_internal(cmd.data.play_at_pos.anim_type,
-                                              cmd.data.play_at_pos.x,
-                                              cmd.data.play_at_pos.y);
-                 break;
+ static void _lottie_exec_cmd(const lottie_cmd_t *cmd);
  
-             case LOTTIE_CMD_STOP:
-                 _lottie_stop_internal(cmd.data.stop.anim_type);
-                 break;
+ // 记录对象刷新前的区域（隐藏或不存在时记为空）
+ static bool _lottie_batch_area(lv_obj_t *obj, lv_area_t *area)
+ {
+     if (!obj || lv_obj_has_flag(obj, LV_OBJ_FLAG_HIDDEN)) {
+         return false;
+     }
+     lv_obj_get_coords(obj, area);
+     return true;
+ }
  
-             case LOTTIE_CMD_HIDE:
-                 if (g_lottie_obj) {
-                     lv_lock();
-                     lv_obj_add_flag(g_lottie_obj, LV_OBJ_FLAG_HIDDEN);
-                     lv_unlock();
-                 }
-                 break;
+ // 批量命令：执行期间禁止刷新区域，结束后只刷新动画/图片对象的新旧区域各一次
+ static void _lottie_batch_internal(const lottie_cmd_t *cmd)
+ {
+     lottie_cmd_batch_t *batch = cmd->data.batch.batch;
+     lv_display_t *disp = lv_display_get_default();
+     lv_area_t old_area[2];
+     bool old_visible[2];
+ 
+     old_visible[0] = _lottie_batch_area(g_lottie_obj, &old_area[0]);
+     old_visible[1] = _lottie_batch_area(g_image_obj, &old_area[1]);
+ 
+     lv_display_enable_invalidation(disp, false);
+     for (int i = 0; i < batch->count; i++) {
+         if (batch->cmds[i].type != LOTTIE_CMD_BATCH) {
+             _lottie_exec_cmd(&batch->cmds[i]);
+         }
+     }
+     // 位置/尺寸在布局更新时才生效，刷新禁用期间完成布局，避免中间位置产生刷新区域
+     lv_obj_t *objs[2] = {g_lottie_obj, g_image_obj};
+     for (int i = 0; i < 2; i++) {
+         if (objs[i]) {
+             lv_obj_update_layout(objs[i]);
+         }
+     }
+     lv_display_enable_invalidation(disp, true);
  
-             case LOTTIE_CMD_SHOW:
-                 if (g_lottie_obj) {
-                     lv_lock();
-                     lv_obj_clear_flag(g_lottie_obj, LV_OBJ_FLAG_HIDDEN);
-                     lv_unlock();
-                 }
-                 break;
+     for (int i = 0; i < 2; i++) {
+         if (old_visible[i]) {
+             lv_inv_area(disp, &old_area[i]);
+         }
+         if (objs[i] && !lv_obj_has_flag(objs[i], LV_OBJ_FLAG_HIDDEN)) {
+             lv_obj_invalidate(objs[i]);
+         }
+     }
  
-             case LOTTIE_CMD_SET_POS:
-                 if (g_lottie_obj) {
-                     lv_lock();
-                     lv_obj_set_pos(g_lottie_obj, cmd.data.pos.x, cmd.data.pos.y);
-                     lv_unlock();
-                 }
-                 break;
+     ESP_LOGD(TAG, "批量执行 %u 条命令", batch->count);
+     lottie_cmd_batch_release(batch);
+ }
  
-             case LOTTIE_CMD_CENTER:
-                 if (g_lottie_obj) {
-                     lv_lock();
-                     lv_obj_center(g_lottie_obj);
-                     lv_unlock();
-                 }
-                 break;
+ // 执行单条命令（LVGL上下文）
+ static void _lottie_exec_cmd(const lottie_cmd_t *cmd)
+ {
+     switch (cmd->type) {
+     case LOTTIE_CMD_PLAY:
+         _lottie_play_internal(cmd);
+         break;
+ 
+     case LOTTIE_CMD_PUBLISH:
+         _lottie_publish_internal(cmd);
+         break;
+ 
+     case LOTTIE_CMD_PRELOADED:
+         _lottie_preloaded_internal(cmd);
+         break;
+ 
+     case LOTTIE_CMD_LOAD_FAILED:
+         _lottie_load_failed_internal(cmd);
+         break;
+ 
+     case LOTTIE_CMD_BATCH:
+         _lottie_batch_internal(cmd);
+         break;
+ 
+     case LOTTIE_CMD_DRIVE:
+         _lottie_drive_internal(cmd);
+         break;
+ 
+     case LOTTIE_CMD_OVERRIDE:
+         _lottie_override_internal(cmd);
+         break;
+ 
+     case LOTTIE_CMD_STOP:
+         _lottie_stop_internal(cmd->data.stop.anim_type);
+         break;
+ 
+     case LOTTIE_CMD_HIDE:
+         if (g_lottie_obj) {
+             lv_obj_add_flag(g_lottie_obj, LV_OBJ_FLAG_HIDDEN);
+         }
+         break;
  
-             case LOTTIE_CMD_SHOW_IMAGE:
-                 ESP_LOGI(TAG, "处理显示图片命令: %s (%dx%d)", 
-                          cmd.data.image.path, cmd.data.image.width, cmd.data.image.height);
-                 
-                 lv_lock();
-                 if (g_lottie_obj) {
-                     lv_obj_add_flag(g_lottie_obj, LV_OBJ_FLAG_HIDDEN);
-                     ESP_LOGI(TAG, "已隐藏Lottie动画");
-                 }
-                 if (g_image_obj) {
-                     lv_obj_delete(g_image_obj);
-                     g_image_obj = NULL;
-                     ESP_LOGI(TAG, "已删除旧图片");
-                 }
-                 
-                 g_image_obj = lv_image_create(lv_screen_active());
-                 if (g_image_obj) {
-                     ESP_LOGI(TAG, "图片对象创建成功");
-                     lv_image_set_src(g_image_obj, cmd.data.image.path);
-                     if (cmd.data.image.width > 0 && cmd.data.image.height > 0) {
-                         lv_obj_set_size(g_image_obj, cmd.data.image.width, cmd.data.image.height);
-                     }
-                     lv_obj_center(g_image_obj);
-                     ESP_LOGI(TAG, "✅ 图片显示成功: %s", cmd.data.image.path);
-                 } else {
-                     ESP_LOGE(TAG, "❌ 创建图片对象失败");
-                 }
-                 lv_unlock();
-                 break;
+     case LOTTIE_CMD_SHOW:
+         if (g_lottie_obj && g_player) {
+             lv_obj_clear_flag(g_lottie_obj, LV_OBJ_FLAG_HIDDEN);
+         }
+         break;
  
-             case LOTTIE_CMD_HIDE_IMAGE:
-                 ESP_LOGI(TAG, "处理隐藏图片命令");
-                 lv_lock();
-                 if (g_image_obj) {
-                     lv_obj_delete(g_image_obj);
-                     g_image_obj = NULL;
-                     ESP_LOGI(TAG, "图片已删除");
-                 }
-                 if (g_lottie_obj) {
-                     lv_obj_clear_flag(g_lottie_obj, LV_OBJ_FLAG_HIDDEN);
-                     ESP_LOGI(TAG, "已恢复Lottie动画");
-                 }
-                 lv_unlock();
-                 break;
+     case LOTTIE_CMD_SET_POS:
+         // 只改变位置：播放器按帧号渲染，位置变化不会使帧失效，LVGL直接复用缓冲区
+         if (g_lottie_obj) {
+             _lottie_move_cancel();
+             lv_obj_set_pos(g_lottie_obj, cmd->data.pos.x, cmd->data.pos.y);
+         }
+         break;
  
-             default:
-                 ESP_LOGW(TAG, "未知命令类型: %d", cmd.type);
-                 break;
-             }
+     case LOTTIE_CMD_MOVE:
+         _lottie_move_internal(cmd);
+         break;
+ 
+     case LOTTIE_CMD_CENTER:
+         if (g_lottie_obj) {
+             _lottie_move_cancel();
+             lv_obj_center(g_lottie_obj);
          }
+         break;
+ 
+     case LOTTIE_CMD_SHOW_IMAGE:
+         ESP_LOGI(TAG, "处理显示图片命令: %s (%dx%d)",
+                  cmd->data.image.path, cmd->data.image.width, cmd->data.image.height);
+         _lottie_show_image_internal(cmd->data.image.path,
+                                     cmd->data.image.width,
+                                     cmd->data.image.height);
+         break;
+ 
+     case LOTTIE_CMD_IMAGE_READY:
+         _lottie_image_ready_internal(cmd->data.image_ready.path, cmd->data.image_ready.ok);
+         break;
+ 
+     case LOTTIE_CMD_HIDE_IMAGE:
+         ESP_LOGI(TAG, "处理隐藏图片命令");
+         _lottie_hide_image_internal();
+         break;
+ 
+     case LOTTIE_CMD_TRACE:
+         _lottie_trace_internal(cmd);
+         break;
+ 
+     default:
+         ESP_LOGW(TAG, "未知命令类型: %d", cmd->type);
+         break;
      }
  }
  
+ // 命令处理定时器（LVGL上下文，已持有LVGL锁）
+ static void _lottie_cmd_timer_cb(lv_timer_t *timer)
+ {
+     (void)timer;
+     lottie_cmd_t cmd;
+     static bool warmed_up = false;
+ 
+     // LVGL任务第一次渲染/覆盖插槽前预热（播放器只能经本回调发布，首次执行必在其前）
+     if (!warmed_up) {
+         lottie_player_warmup();
+         warmed_up = true;
+     }
+ 
+     // 回收图片缓存中已淘汰的槽
+     lottie_img_cache_collect();
+ 
+     while (lottie_cmd_ring_pop(&cmd)) {
+         lottie_trace_record(&cmd);
+         int64_t start = esp_timer_get_time();
+         _lottie_exec_cmd(&cmd);
+         int64_t end = esp_timer_get_time();
+ 
+         uint32_t latency_us = (uint32_t)(start - cmd.post_us);
+         uint32_t exec_us = (uint32_t)(end - start);
+         g_stats.cmd_count++;
+         g_latency_sum_us += latency_us;
+         g_stats.cmd_latency_avg_us = (uint32_t)(g_latency_sum_us / g_stats.cmd_count);
+         if (latency_us > g_stats.cmd_latency_max_us) {
+             g_stats.cmd_latency_max_us = latency_us;
+         }
+         if (exec_us > g_stats.exec_max_us) {
+             g_stats.exec_max_us = exec_us;
+             ESP_LOGI(TAG, "命令 %d 最长执行时间: %lu us", cmd.type, (unsigned long)exec_us);
+         }
+     }
+ 
+     _lottie_preload_poll();
+     lottie_trace_note_memory();
+ }
+ 
  static bool lottie_manager_init(void)
  {
      if (g_initialized) {
@@ -281,51 +1303,99 @@
  
      ESP_LOGI(TAG, "初始化 Lottie 管理器");
  
-     // 检查屏幕是否有效
-     lv_obj_t *screen = lv_screen_active();
-     if (screen == NULL) {
-         ESP_LOGE(TAG, "无法获取活动屏幕");
-         return false;
-     }
+     lottie_cmd_ring_init();
+     lottie_predict_init(ANIM_CONFIG_COUNT);
+     lottie_arena_init();
  
-     // 创建互斥锁
-     g_anim_mutex = xSemaphoreCreateMutex();
-     if (!g_anim_mutex) {
-         ESP_LOGE(TAG, "创建互斥锁失败");
+     // 创建后台加载队列
+     g_load_queue = xQueueCreate(4, sizeof(lottie_load_job_t));
+     if (!g_load_queue) {
+         ESP_LOGE(TAG, "创建加载队列失败");
          return false;
      }
  
-     // 创建命令队列
-     g_cmd_queue = xQueueCreate(10, sizeof(lottie_cmd_t));
-     if (!g_cmd_queue) {
-         ESP_LOGE(TAG, "创建命令队列失败");
-         vSemaphoreDelete(g_anim_mutex);
+     // 初始化图片缓存（后台解码任务）
+     if (lottie_img_cache_init(_lottie_image_ready_cb) != ESP_OK) {
+         ESP_LOGE(TAG, "初始化图片缓存失败");
+         vQueueDelete(g_load_queue);
+         g_load_queue = NULL;
          return false;
      }
  
-     // 创建动画处理静态任务 - 参考main.c的实现
+     // 创建后台加载静态任务
      g_anim_task = xTaskCreateStatic(
                        lottie_task,                // 任务函数
                        "lottie_task",              // 任务名称
                        LOTTIE_TASK_STACK_SIZE,     // 栈大小
                        NULL,                       // 任务参数
-                       3,                          // 优先级3（动画管理，可被抢占）
+                       3,                          // 优先级3（动画加载，可被抢占）
                        lottie_task_stack,          // 栈数组(PSRAM)
                        &lottie_task_buffer         // 任务控制块(内部RAM)
                    );
  
-     if (g_anim_task == NULL) {
-         ESP_LOGE(TAG, "创建动画处理任务失败");
-         vQueueDelete(g_cmd_queue);
-         g_cmd_queue = NULL;
+     if (g_anim_task == NULL) {
+         ESP_LOGE(TAG, "创建动画加载任务失败");
+         vQueueDelete(g_load_queue);
+         g_load_queue = NULL;
+         return false;
+     }
+ 
+     // 命令在LVGL任务中执行（初始化时一次性持锁创建定时器）
+     lv_lock();
+     lv_obj_t *screen = lv_screen_active();
+     if (screen) {
+         g_cmd_timer = lv_timer_create(_lottie_cmd_timer_cb, LOTTIE_CMD_POLL_MS, NULL);
+         if (g_cmd_timer) {
+             lvgl_driver_add_wake_timer(g_cmd_timer);
+         }
+         lv_display_add_event_cb(lv_display_get_default(), _lottie_refr_start_cb, LV_EVENT_REFR_START, NULL);
+         lv_display_add_event_cb(lv_display_get_default(), _lottie_refr_ready_cb, LV_EVENT_REFR_READY, NULL);
+     }
+     lv_unlock();
+ 
+     if (!screen || !g_cmd_timer) {
+         ESP_LOGE(TAG, "无法获取活动屏幕或创建命令定时器");
          return false;
      }
  
      g_initialized = true;
-     ESP_LOGI(TAG, "Lottie 管理器初始化完成，动画任务已启动");
+     ESP_LOGI(TAG, "Lottie 管理器初始化完成，命令在LVGL任务中执行");
      return true;
  }
  
+ // 提交播放命令
+ static bool _lottie_post_play(int anim_type, const char *file_path, uint16_t width, uint16_t height,
+                               uint8_t quality, uint8_t scale, uint8_t flags,
+                               bool center, int16_t x, int16_t y)
+ {
+     lottie_cmd_t cmd;
+     cmd.type = LOTTIE_CMD_PLAY;
+     cmd.data.play.anim_type = anim_type;
+     snprintf(cmd.data.play.path, sizeof(cmd.data.play.path), "%s", file_path);
+     cmd.data.play.width = width;
+     cmd.data.play.height = height;
+     cmd.data.play.quality = quality;
+     cmd.data.play.scale = scale;
+     cmd.data.play.flags = flags;
+     cmd.data.play.center = center;
+     cmd.data.play.x = x;
+     cmd.data.play.y = y;
+     return _lottie_post(&cmd);
+ }
+ 
+ // 提交无参数命令
+ static void _lottie_post_simple(lottie_cmd_type_t type)
+ {
+     if (!g_initialized) {
+         ESP_LOGW(TAG, "管理器未初始化");
+         return;
+     }
+ 
+     lottie_cmd_t cmd;
+     cmd.type = type;
+     _lottie_post(&cmd);
+ }
+ 
  bool lottie_manager_play(const char *file_path, uint16_t width, uint16_t height)
  {
      if (!g_initialized) {
@@ -338,449 +1408,358 @@
          return false;
      }
  
-     // 获取互斥锁，确保同一时间只有一个动画操作
-     if (xSemaphoreTake(g_anim_mutex, pdMS_TO_TICKS(1000)) != pdTRUE) {
-         ESP_LOGE(TAG, "获取互斥锁超时");
-         return false;
-     }
+     return _lottie_post_play(-1, file_path, width, height, LOTTIE_QUALITY_AUTO, LOTTIE_SCALE_FULL, 0, true, 0, 0);
+ }
  
-     // 等待之前的操作完全完成
-     uint32_t wait_count = 0;
-     while (g_anim_busy && wait_count < 100) {
-         vTaskDelay(pdMS_TO_TICKS(10));
-         wait_count++;
+ bool lottie_manager_play_at_pos(const char *file_path, uint16_t width, uint16_t height, int16_t x, int16_t y)
+ {
+     if (!g_initialized) {
+         ESP_LOGE(TAG, "管理器未初始化");
+         return false;
      }
  
-     if (g_anim_busy) {
-         ESP_LOGE(TAG, "等待动画操作完成超时");
-         xSemaphoreGive(g_anim_mutex);
+     if (!file_path) {
+         ESP_LOGE(TAG, "文件路径无效");
          return false;
      }
  
-     g_anim_busy = true;
+     return _lottie_post_play(-1, file_path, width, height, LOTTIE_QUALITY_AUTO, LOTTIE_SCALE_FULL, 0, false, x, y);
+ }
  
-     ESP_LOGI(TAG, "播放动画: %s (%dx%d), 当前动画: %d", file_path, width, height, g_current_anim_type);
+ void lottie_manager_stop(void)
+ {
+     lottie_manager_stop_anim(-1);
+ }
  
-     // 先清理之前的动画（包含同步等待）
-     lottie_manager_stop();
+ void lottie_manager_hide(void)
+ {
+     _lottie_post_simple(LOTTIE_CMD_HIDE);
+ }
  
-     // 等待确保LVGL完全处理完删除操作和内存释放
-     // 增加延迟以避免SPI传输队列冲突
-     vTaskDelay(pdMS_TO_TICKS(100));
+ void lottie_manager_show(void)
+ {
+     _lottie_post_simple(LOTTIE_CMD_SHOW);
+ }
  
-     // 第一步：在锁外读取文件到内存（耗时操作）
-     FILE *fp = fopen(file_path, "rb");
-     if (!fp) {
-         ESP_LOGE(TAG, "无法打开文件: %s", file_path);
-         g_anim_busy = false;
-         xSemaphoreGive(g_anim_mutex);
-         return false;
+ void lottie_manager_set_pos(int16_t x, int16_t y)
+ {
+     if (!g_initialized) {
+         ESP_LOGW(TAG, "管理器未初始化");
+         return;
      }
  
-     fseek(fp, 0, SEEK_END);
-     size_t file_size = ftell(fp);
-     fseek(fp, 0, SEEK_SET);
-
-    ESP_LOGI(TAG, "Lottie JSON 文件: %s, 大小: %u 字节", file_path, (unsigned)file_size);
-     uint8_t *file_data = (uint8_t *)heap_caps_malloc(file_size, MALLOC_CAP_SPIRAM);
-     if (!file_data) {
-         ESP_LOGE(TAG, "文件缓冲区分配失败 (需要 %zu 字节)", file_size);
-         fclose(fp);
-         g_anim_busy = false;
-         xSemaphoreGive(g_anim_mutex);
+     lottie_cmd_t cmd;
+     cmd.type = LOTTIE_CMD_SET_POS;
+     cmd.data.pos.x = x;
+     cmd.data.pos.y = y;
+     _lottie_post(&cmd);
+ }
+ 
+ bool lottie_manager_move_to(int16_t x, int16_t y, uint16_t duration_ms)
+ {
+     if (!g_initialized) {
+         ESP_LOGE(TAG, "管理器未初始化");
          return false;
      }
  
-     size_t read_size = fread(file_data, 1, file_size, fp);
-     fclose(fp);
+     lottie_cmd_t cmd;
+     cmd.type = LOTTIE_CMD_MOVE;
+     cmd.data.pos.x = x;
+     cmd.data.pos.y = y;
+     cmd.data.pos.duration_ms = duration_ms;
+     return _lottie_post(&cmd);
+ }
+ 
+ void lottie_manager_center(void)
+ {
+     _lottie_post_simple(LOTTIE_CMD_CENTER);
+ }
  
-     if (read_size != file_size) {
-         ESP_LOGE(TAG, "文件读取失败");
-         heap_caps_free(file_data);
-         g_anim_busy = false;
-         xSemaphoreGive(g_anim_mutex);
+ bool lottie_manager_play_anim(int anim_type)
+ {
+     if (!g_initialized) {
+         ESP_LOGE(TAG, "管理器未初始化");
          return false;
      }
  
-     // 第二步：在锁内操作LVGL对象（快速操作）
-     lv_lock();
- 
-     g_lottie_obj = lv_lottie_create(lv_screen_active());
-     if (!g_lottie_obj) {
-         lv_unlock();
-         ESP_LOGE(TAG, "创建 Lottie 对象失败");
-         heap_caps_free(file_data);
-         g_anim_busy = false;
-         xSemaphoreGive(g_anim_mutex);
+     if (anim_type < 0 || anim_type >= ANIM_CONFIG_COUNT || !anim_configs[anim_type].file_path) {
+         ESP_LOGE(TAG, "无效的动画类型: %d", anim_type);
          return false;
      }
  
-     // 分配渲染缓冲区
-     size_t buffer_size = width * height * 4; // ARGB8888
-     g_lottie_buffer = heap_caps_malloc(buffer_size, MALLOC_CAP_SPIRAM);
-     if (!g_lottie_buffer) {
-         ESP_LOGE(TAG, "PSRAM缓冲区分配失败 (需要 %zu 字节)", buffer_size);
-         lv_obj_del(g_lottie_obj);
-         lv_unlock();
-         heap_caps_free(file_data);
-         g_lottie_obj = NULL;
-         g_anim_busy = false;
-         xSemaphoreGive(g_anim_mutex);
+     const lottie_anim_config_t *config = &anim_configs[anim_type];
+     if (!_lottie_post_play(anim_type, config->file_path, config->width, config->height, config->quality, config->scale,
+                            config->flags, true, 0, 0)) {
+         ESP_LOGE(TAG, "发送播放命令失败，动画类型: %d", anim_type);
          return false;
      }
  
-     // 设置缓冲区和数据源（使用内存数据，避免文件IO）
-     lv_lottie_set_buffer(g_lottie_obj, width, height, g_lottie_buffer);
-     lv_lottie_set_src_data(g_lottie_obj, file_data, file_size);
-     lv_obj_center(g_lottie_obj);
- 
-     lv_unlock();
- 
-     // 释放文件数据（已被ThorVG解析）
-     heap_caps_free(file_data);
- 
-     ESP_LOGI(TAG, "动画播放成功");
- 
-     g_anim_busy = false;
-     xSemaphoreGive(g_anim_mutex);
+     ESP_LOGI(TAG, "播放命令已发送，动画类型: %d", anim_type);
      return true;
  }
  
- bool lottie_manager_play_at_pos(const char *file_path, uint16_t width, uint16_t height, int16_t x, int16_t y)
+ bool lottie_manager_play_anim_at_pos(int anim_type, int16_t x, int16_t y)
  {
      if (!g_initialized) {
          ESP_LOGE(TAG, "管理器未初始化");
          return false;
      }
  
-     if (!file_path) {
-         ESP_LOGE(TAG, "文件路径无效");
+     if (anim_type < 0 || anim_type >= ANIM_CONFIG_COUNT || !anim_configs[anim_type].file_path) {
+         ESP_LOGE(TAG, "无效的动画类型: %d", anim_type);
          return false;
      }
  
-     // 获取互斥锁，确保同一时间只有一个动画操作
-     if (xSemaphoreTake(g_anim_mutex, pdMS_TO_TICKS(1000)) != pdTRUE) {
-         ESP_LOGE(TAG, "获取互斥锁超时");
+     const lottie_anim_config_t *config = &anim_configs[anim_type];
+     if (!_lottie_post_play(anim_type, config->file_path, config->width, config->height, config->quality, config->scale,
+                            config->flags, false, x, y)) {
+         ESP_LOGE(TAG, "发送播放命令失败，动画类型: %d，位置: (%d, %d)", anim_type, x, y);
          return false;
      }
  
-     // 等待之前的操作完全完成
-     uint32_t wait_count = 0;
-     while (g_anim_busy && wait_count < 100) {
-         vTaskDelay(pdMS_TO_TICKS(10));
-         wait_count++;
-     }
+     ESP_LOGI(TAG, "播放命令已发送，动画类型: %d，位置: (%d, %d)", anim_type, x, y);
+     return true;
+ }
  
-     if (g_anim_busy) {
-         ESP_LOGE(TAG, "等待动画操作完成超时");
-         xSemaphoreGive(g_anim_mutex);
-         return false;
+ void lottie_manager_stop_anim(int anim_type)
+ {
+     if (!g_initialized) {
+         ESP_LOGW(TAG, "管理器未初始化");
+         return;
      }
  
-     g_anim_busy = true;
- 
-     ESP_LOGI(TAG, "播放动画: %s (%dx%d) 中心偏移: (%d, %d), 当前动画: %d",
-              file_path, width, height, x, y, g_current_anim_type);
- 
-     // 先清理之前的动画（包含同步等待）
-     lottie_manager_stop();
+     lottie_cmd_t cmd;
+     cmd.type = LOTTIE_CMD_STOP;
+     cmd.data.stop.anim_type = anim_type;
  
-     // 等待确保LVGL完全处理完删除操作和内存释放
-     // 增加延迟以避免SPI传输队列冲突
-     vTaskDelay(pdMS_TO_TICKS(100));
+     if (_lottie_post(&cmd)) {
+         ESP_LOGI(TAG, "停止命令已发送，动画类型: %d", anim_type);
+     }
+ }
  
-     // 第一步：在锁外读取文件到内存（耗时操作）
-     FILE *fp = fopen(file_path, "rb");
-     if (!fp) {
-         ESP_LOGE(TAG, "无法打开文件: %s", file_path);
-         g_anim_busy = false;
-         xSemaphoreGive(g_anim_mutex);
+ bool lottie_manager_show_image(const char *img_path, uint16_t width, uint16_t height)
+ {
+     if (!g_initialized) {
+         ESP_LOGE(TAG, "管理器未初始化");
          return false;
      }
  
-     fseek(fp, 0, SEEK_END);
-     size_t file_size = ftell(fp);
-     fseek(fp, 0, SEEK_SET);
- 
-     uint8_t *file_data = (uint8_t *)heap_caps_malloc(file_size, MALLOC_CAP_SPIRAM);
-     if (!file_data) {
-         ESP_LOGE(TAG, "文件缓冲区分配失败 (需要 %zu 字节)", file_size);
-         fclose(fp);
-         g_anim_busy = false;
-         xSemaphoreGive(g_anim_mutex);
+     if (!img_path) {
+         ESP_LOGE(TAG, "图片路径为空");
          return false;
      }
  
-     size_t read_size = fread(file_data, 1, file_size, fp);
-     fclose(fp);
+     ESP_LOGI(TAG, "发送显示图片命令: %s (%dx%d)", img_path, width, height);
  
-     if (read_size != file_size) {
-         ESP_LOGE(TAG, "文件读取失败");
-         heap_caps_free(file_data);
-         g_anim_busy = false;
-         xSemaphoreGive(g_anim_mutex);
-         return false;
-     }
+     lottie_cmd_t cmd;
+     cmd.type = LOTTIE_CMD_SHOW_IMAGE;
+     snprintf(cmd.data.image.path, sizeof(cmd.data.image.path), "%s", img_path);
+     cmd.data.image.width = width;
+     cmd.data.image.height = height;
  
-     // 第二步：在锁内操作LVGL对象（快速操作）
-     lv_lock();
+     return _lottie_post(&cmd);
+ }
  
-     g_lottie_obj = lv_lottie_create(lv_screen_active());
-     if (!g_lottie_obj) {
-         lv_unlock();
-         ESP_LOGE(TAG, "创建 Lottie 对象失败");
-         heap_caps_free(file_data);
-         g_anim_busy = false;
-         xSemaphoreGive(g_anim_mutex);
+ bool lottie_manager_prefetch_image(const char *img_path)
+ {
+     if (!g_initialized) {
+         ESP_LOGE(TAG, "管理器未初始化");
          return false;
      }
  
-     // 分配渲染缓冲区
-     size_t buffer_size = width * height * 4; // ARGB8888
-     g_lottie_buffer = heap_caps_malloc(buffer_size, MALLOC_CAP_SPIRAM);
-     if (!g_lottie_buffer) {
-         ESP_LOGE(TAG, "PSRAM缓冲区分配失败 (需要 %zu 字节)", buffer_size);
-         lv_obj_del(g_lottie_obj);
-         lv_unlock();
-         heap_caps_free(file_data);
-         g_lottie_obj = NULL;
-         g_anim_busy = false;
-         xSemaphoreGive(g_anim_mutex);
+     if (!img_path) {
+         ESP_LOGE(TAG, "图片路径为空");
          return false;
      }
  
-     // 设置缓冲区和数据源（使用内存数据，避免文件IO）
-     lv_lottie_set_buffer(g_lottie_obj, width, height, g_lottie_buffer);
-     lv_lottie_set_src_data(g_lottie_obj, file_data, file_size);
-     lv_obj_align(g_lottie_obj, LV_ALIGN_CENTER, x, y);
- 
-     lv_unlock();
- 
-     // 释放文件数据（已被ThorVG解析）
-     heap_caps_free(file_data);
- 
-     ESP_LOGI(TAG, "动画播放成功，中心对齐偏移: (%d, %d)", x, y);
+     if (!lottie_img_cache_prefetch(img_path)) {
+         ESP_LOGE(TAG, "图片预取请求失败(解码队列满): %s", img_path);
+         return false;
+     }
  
-     g_anim_busy = false;
-     xSemaphoreGive(g_anim_mutex);
+     ESP_LOGI(TAG, "图片预取已请求: %s", img_path);
      return true;
  }
  
- void lottie_manager_stop(void)
+ void lottie_manager_hide_image(void)
  {
-     if (g_lottie_obj) {
-         ESP_LOGI(TAG, "停止动画");
- 
-         // 先隐藏对象，避免在删除过程中继续渲染
-         lv_lock();
-         lv_obj_add_flag(g_lottie_obj, LV_OBJ_FLAG_HIDDEN);
-         lv_obj_invalidate(g_lottie_obj);  // 标记需要重绘
-         lv_unlock();
- 
-         // 【关键修复】等待所有LVGL刷新和DMA传输完成
-         // 这样可以确保在删除对象前，所有屏幕刷新的DMA都已完成
-         lv_display_t *disp = lv_display_get_default();
-         if (disp) {
-             uint32_t wait_count = 0;
-             const uint32_t max_wait_ms = 500;  // 最多等待500ms
-             const uint32_t check_interval_ms = 10;
- 
-             // 循环等待直到显示器空闲（无刷新活动）
-             while (wait_count < max_wait_ms) {
-                 vTaskDelay(pdMS_TO_TICKS(check_interval_ms));
- 
-                 uint32_t inactive_time = lv_display_get_inactive_time(disp);
-                 // ⚠️ 增加空闲阈值到500ms，更保守地删除对象
-                 if (inactive_time > 500) {
-                     ESP_LOGI(TAG, "LVGL显示已空闲 %lu ms，安全删除", inactive_time);
-                     break;
-                 }
- 
-                 wait_count += check_interval_ms;
-             }
- 
-             if (wait_count >= max_wait_ms) {
-                 ESP_LOGW(TAG, "等待LVGL空闲超时，强制删除");
-             }
-         } else {
-             // 后备方案：如果无法获取display，使用固定延迟
-             vTaskDelay(pdMS_TO_TICKS(200));
-         }
- 
-         // 安全删除LVGL对象（增加延迟避免释放后使用）
-         lv_lock();
-         lv_obj_del(g_lottie_obj);
-         lv_unlock();
-         g_lottie_obj = NULL;
+     ESP_LOGI(TAG, "发送隐藏图片命令");
+     _lottie_post_simple(LOTTIE_CMD_HIDE_IMAGE);
+ }
  
-         // 增加等待时间，确保LVGL主循环完全处理完删除操作
-         vTaskDelay(pdMS_TO_TICKS(300));
+ bool lottie_manager_drive_enable(bool enable, int32_t start_frame, int32_t end_frame)
+ {
+     if (!g_initialized) {
+         ESP_LOGE(TAG, "管理器未初始化");
+         return false;
      }
  
-     if (g_lottie_buffer) {
-         heap_caps_free(g_lottie_buffer);
-         g_lottie_buffer = NULL;
+     lottie_cmd_t cmd;
+     cmd.type = LOTTIE_CMD_DRIVE;
+     cmd.data.drive.enable = enable;
+     cmd.data.drive.start_frame = start_frame;
+     cmd.data.drive.end_frame = end_frame;
+     return _lottie_post(&cmd);
+ }
  
-         // 等待内存完全释放
-         vTaskDelay(pdMS_TO_TICKS(50));
-     }
+ void lottie_manager_drive_value(float value)
+ {
+     lottie_drive_mailbox_publish(value);
  }
  
- void lottie_manager_hide(void)
+ // 提交插槽覆盖命令
+ static bool _lottie_post_override(const char *slot, lottie_override_kind_t kind, uint32_t value)
  {
-     if (g_lottie_obj) {
-         lv_lock();
-         lv_obj_add_flag(g_lottie_obj, LV_OBJ_FLAG_HIDDEN);
-         lv_unlock();
+     if (!g_initialized) {
+         ESP_LOGE(TAG, "管理器未初始化");
+         return false;
+     }
+ 
+     lottie_cmd_t cmd;
+     cmd.type = LOTTIE_CMD_OVERRIDE;
+     cmd.data.override.slot[0] = '\0';
+     if (kind != LOTTIE_OVERRIDE_CLEAR) {
+         if (!slot || !slot[0] || strlen(slot) > LOTTIE_SLOT_NAME_MAX) {
+             ESP_LOGE(TAG, "无效的插槽名: %s", slot ? slot : "(null)");
+             return false;
+         }
+         snprintf(cmd.data.override.slot, sizeof(cmd.data.override.slot), "%s", slot);
      }
+     cmd.data.override.kind = kind;
+     cmd.data.override.value = value;
+     return _lottie_post(&cmd);
  }
  
- void lottie_manager_show(void)
+ bool lottie_manager_set_color(const char *slot, uint32_t rgb)
  {
-     if (g_lottie_obj) {
-         lv_lock();
-         lv_obj_clear_flag(g_lottie_obj, LV_OBJ_FLAG_HIDDEN);
-         lv_unlock();
-     }
+     return _lottie_post_override(slot, LOTTIE_OVERRIDE_COLOR, rgb & 0xFFFFFF);
  }
  
- void lottie_manager_set_pos(int16_t x, int16_t y)
+ bool lottie_manager_set_visible(const char *slot, bool visible)
  {
-     if (g_lottie_obj) {
-         lv_lock();
-         lv_obj_set_pos(g_lottie_obj, x, y);
-         lv_unlock();
-     }
+     return _lottie_post_override(slot, LOTTIE_OVERRIDE_OPACITY, visible ? 100 : 0);
  }
  
- void lottie_manager_center(void)
+ bool lottie_manager_clear_overrides(void)
  {
-     if (g_lottie_obj) {
-         lv_lock();
-         lv_obj_center(g_lottie_obj);
-         lv_unlock();
-     }
+     return _lottie_post_override(NULL, LOTTIE_OVERRIDE_CLEAR, 0);
  }
  
- bool lottie_manager_play_anim(int anim_type)
+ bool lottie_manager_batch_begin(void)
  {
-     if (!g_initialized || !g_cmd_queue) {
+     if (!g_initialized) {
          ESP_LOGE(TAG, "管理器未初始化");
          return false;
      }
  
-     if (anim_type < 0 || anim_type >= ANIM_CONFIG_COUNT) {
-         ESP_LOGE(TAG, "无效的动画类型: %d", anim_type);
-         return false;
-     }
- 
-     lottie_cmd_t cmd;
-     cmd.type = LOTTIE_CMD_PLAY;
-     cmd.data.play.anim_type = anim_type;
- 
-     if (xQueueSend(g_cmd_queue, &cmd, pdMS_TO_TICKS(100)) != pdTRUE) {
-         ESP_LOGE(TAG, "发送播放命令失败，动画类型: %d", anim_type);
+     if (!lottie_cmd_batch_open(xTaskGetCurrentTaskHandle())) {
+         ESP_LOGE(TAG, "无法打开批次（已打开或批次池已满）");
          return false;
      }
- 
-     ESP_LOGI(TAG, "播放命令已发送，动画类型: %d", anim_type);
      return true;
  }
  
- bool lottie_manager_play_anim_at_pos(int anim_type, int16_t x, int16_t y)
+ bool lottie_manager_batch_commit(void)
  {
-     if (!g_initialized || !g_cmd_queue) {
-         ESP_LOGE(TAG, "管理器未初始化");
+     lottie_cmd_batch_t *batch = lottie_cmd_batch_find(xTaskGetCurrentTaskHandle());
+     if (!batch) {
+         ESP_LOGE(TAG, "当前任务没有打开的批次");
          return false;
      }
  
-     if (anim_type < 0 || anim_type >= ANIM_CONFIG_COUNT) {
-         ESP_LOGE(TAG, "无效的动画类型: %d", anim_type);
-         return false;
+     lottie_cmd_batch_close(batch);
+     if (batch->count == 0) {
+         lottie_cmd_batch_release(batch);
+         return true;
      }
  
      lottie_cmd_t cmd;
-     cmd.type = LOTTIE_CMD_PLAY_AT_POS;
-     cmd.data.play_at_pos.anim_type = anim_type;
-     cmd.data.play_at_pos.x = x;
-     cmd.data.play_at_pos.y = y;
- 
-     if (xQueueSend(g_cmd_queue, &cmd, pdMS_TO_TICKS(100)) != pdTRUE) {
-         ESP_LOGE(TAG, "发送播放命令失败，动画类型: %d，位置: (%d, %d)", anim_type, x, y);
+     cmd.type = LOTTIE_CMD_BATCH;
+     cmd.data.batch.batch = batch;
+     if (!_lottie_post(&cmd)) {
+         lottie_cmd_batch_release(batch);
          return false;
      }
- 
-     ESP_LOGI(TAG, "播放命令已发送，动画类型: %d，位置: (%d, %d)", anim_type, x, y);
      return true;
  }
  
- void lottie_manager_stop_anim(int anim_type)
+ // 提交命令流录制操作
+ static bool _lottie_post_trace(lottie_trace_op_t op, const char *path)
  {
-     if (!g_initialized || !g_cmd_queue) {
-         ESP_LOGW(TAG, "管理器未初始化");
-         return;
+     if (!g_initialized) {
+         ESP_LOGE(TAG, "管理器未初始化");
+         return false;
      }
  
      lottie_cmd_t cmd;
-     cmd.type = LOTTIE_CMD_STOP;
-     cmd.data.stop.anim_type = anim_type;
+     cmd.type = LOTTIE_CMD_TRACE;
+     cmd.data.trace.op = op;
+     snprintf(cmd.data.trace.path, sizeof(cmd.data.trace.path), "%s", path ? path : "");
+     return _lottie_post(&cmd);
+ }
  
-     if (xQueueSend(g_cmd_queue, &cmd, pdMS_TO_TICKS(100)) != pdTRUE) {
-         ESP_LOGE(TAG, "发送停止命令失败，动画类型: %d", anim_type);
-     } else {
-         ESP_LOGI(TAG, "停止命令已发送，动画类型: %d", anim_type);
-     }
+ bool lottie_manager_trace_start(void)
+ {
+     return _lottie_post_trace(LOTTIE_TRACE_OP_START, NULL);
  }
  
- bool lottie_manager_show_image(const char *img_path, uint16_t width, uint16_t height)
+ bool lottie_manager_trace_stop(void)
+ {
+     return _lottie_post_trace(LOTTIE_TRACE_OP_STOP, NULL);
+ }
+ 
+ bool lottie_manager_trace_dump(void)
+ {
+     return _lottie_post_trace(LOTTIE_TRACE_OP_DUMP, NULL);
+ }
+ 
+ bool lottie_manager_trace_replay(const char *trace_path)
+ {
+     return _lottie_post_trace(LOTTIE_TRACE_OP_REPLAY, trace_path);
+ }
+ 
+ bool lottie_manager_profile_anim(int anim_type)
  {
      if (!g_initialized) {
          ESP_LOGE(TAG, "管理器未初始化");
          return false;
      }
-     
-     if (!img_path) {
-         ESP_LOGE(TAG, "图片路径为空");
+ 
+     if (anim_type < 0 || anim_type >= ANIM_CONFIG_COUNT || !anim_configs[anim_type].file_path) {
+         ESP_LOGE(TAG, "无效的动画类型: %d", anim_type);
          return false;
      }
  
-     ESP_LOGI(TAG, "发送显示图片命令: %s (%dx%d)", img_path, width, height);
- 
-     lottie_cmd_t cmd;
-     cmd.type = LOTTIE_CMD_SHOW_IMAGE;
-     snprintf(cmd.data.image.path, sizeof(cmd.data.image.path), "%s", img_path);
-     cmd.data.image.width = width;
-     cmd.data.image.height = height;
- 
-     if (xQueueSend(g_cmd_queue, &cmd, pdMS_TO_TICKS(100)) == pdTRUE) {
-         ESP_LOGI(TAG, "图片命令已发送到队列");
-         return true;
-     } else {
-         ESP_LOGE(TAG, "发送图片命令到队列失败");
+     const lottie_anim_config_t *config = &anim_configs[anim_type];
+     lottie_load_job_t job = {0};
+     job.profile = true;
+     snprintf(job.path, sizeof(job.path), "%s", config->file_path);
+     job.width = config->width;
+     job.height = config->height;
+     job.lod = _lottie_pick_lod(&quality_presets[config->quality], job.width, job.height);
+     job.frame_step = 1;
+     job.flags = config->flags;
+     job.scale_q8 = LOTTIE_SCALE_Q8_FULL;
+ 
+     // 直接交给后台加载任务，不经过LVGL上下文
+     if (xQueueSend(g_load_queue, &job, 0) != pdTRUE) {
+         ESP_LOGE(TAG, "加载队列已满，无法测量动画类型: %d", anim_type);
          return false;
      }
+     return true;
  }
  
- void lottie_manager_hide_image(void)
+ void lottie_manager_get_stats(lottie_manager_stats_t *stats)
  {
-     if (!g_initialized) {
-         ESP_LOGW(TAG, "管理器未初始化");
+     if (!stats) {
          return;
      }
  
-     ESP_LOGI(TAG, "发送隐藏图片命令");
- 
-     lottie_cmd_t cmd;
-     cmd.type = LOTTIE_CMD_HIDE_IMAGE;
-     
-     if (xQueueSend(g_cmd_queue, &cmd, pdMS_TO_TICKS(100)) == pdTRUE) {
-         ESP_LOGI(TAG, "隐藏图片命令已发送");
-     } else {
-         ESP_LOGE(TAG, "发送隐藏图片命令失败");
-     }
+     *stats = g_stats;
+     stats->cmd_dropped = atomic_load(&g_cmd_dropped);
  }
-
-// ---------------- Lottie 应用初始化封装 ----------------
+ 
+ // ---------------- Lottie 应用初始化封装 ----------------
 
 static esp_err_t xn_lottie_mount_spiffs(void)
 {
@@ -799,6 +1778,16 @@ static esp_err_t xn_lottie_mount_spiffs(void)
     return ret;
 }
 
+static esp_err_t xn_lottie_init_nvs(void)
+{
+    // 默认NVS分区属于整个应用（可能保存Wi-Fi凭据、校准数据），只初始化，不擦除
+    esp_err_t ret = nvs_flash_init();
+    if (ret == ESP_ERR_NVS_NO_FREE_PAGES || ret == ESP_ERR_NVS_NEW_VERSION_FOUND) {
+        ESP_LOGW(TAG, "NVS 分区已满或版本不兼容，需由应用擦除后重新初始化");
+    }
+    return ret;
+}
+
 esp_err_t xn_lottie_manager_init(const xn_lottie_app_config_t *cfg)
 {
     (void)cfg; // 目前暂未使用，预留给多屏等扩展
@@ -816,6 +1805,12 @@ esp_err_t xn_lottie_manager_init(const xn_lottie_app_config_t *cfg)
         return ret;
     }
 
+    // 动画切换转移表保存在NVS中，失败时只在内存中学习
+    ret = xn_lottie_init_nvs();
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "NVS 初始化失败，动画切换预测不会保存: %s", esp_err_to_name(ret));
+    }
+
     // 初始化 Lottie 管理器本身
     if (!lottie_manager_init()) {
         ESP_LOGE(TAG, "Lottie 管理器初始化失败");
@@ -826,4 +1821,4 @@ esp_err_t xn_lottie_manager_init(const xn_lottie_app_config_t *cfg)
     // lottie_manager_play_anim(LOTTIE_ANIM_LOADING);
 
     return ESP_OK;
-}
\ No newline at end of file
+}
@@ -0,0 +1,505 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Description: 基于ThorVG的Lottie播放器实现
+ *
+ * 与 lv_lottie 不同，播放器不是LVGL对象：JSON解析、场景构建和首帧光栅化
+ * 都可以在管理器任务中完成，LVGL只通过 lv_image 引用最终的渲染缓冲区。
+ *
+ * 只有构建场景的ThorVG调用（动画创建、JSON解析、设置尺寸、切帧、插槽覆盖）进入
+ * 播放器的场景分区，解析树和场景节点都属于这一个动画，销毁时整体释放。
+ * 画布、渲染器及其共享的内存池（轮廓/描边缓冲，渲染时按需realloc增长）、
+ * 每个节点的渲染数据（update/draw中创建）跨动画存在或生命周期不同，
+ * 在分区外调用，留在通用堆；这些状态的首次初始化由 lottie_player_warmup 完成。
+ */
+
+#include "xn_lottie_player.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *TAG = "LOTTIE_PLAYER";
+
+// 设置ThorVG目标尺寸和描述符（缓冲区按原始尺寸分配，缩小渲染时只使用前一部分）
+static bool player_apply_scale(lottie_player_t *player, uint16_t scale_q8)
+{
+    uint16_t rw = (uint16_t)(((uint32_t)player->width * scale_q8 + 128) >> 8);
+    uint16_t rh = (uint16_t)(((uint32_t)player->height * scale_q8 + 128) >> 8);
+    if (rw == 0 || rh == 0) {
+        return false;
+    }
+
+    // 渲染目标属于画布，不进入分区
+    if (tvg_swcanvas_set_target(player->canvas, player->buf, rw, rw, rh,
+                                TVG_COLORSPACE_ARGB8888) != TVG_RESULT_SUCCESS) {
+        ESP_LOGE(TAG, "设置渲染目标失败 (%dx%d)", rw, rh);
+        return false;
+    }
+    lottie_arena_t *prev = lottie_arena_enter(player->arena);
+    tvg_picture_set_size(tvg_animation_get_picture(player->anim), rw, rh);
+    lottie_arena_enter(prev);
+
+    player->render_width = rw;
+    player->render_height = rh;
+    player->scale_q8 = scale_q8;
+    player->dsc.header.w = rw;
+    player->dsc.header.h = rh;
+    player->dsc.header.stride = rw * 4;
+    player->dsc.data_size = (uint32_t)rw * rh * 4;
+    player->last_frame = -1;
+    player->miss_count = 0;
+    return true;
+}
+
+lottie_player_t *lottie_player_load(uint8_t *data, size_t size, uint16_t width, uint16_t height,
+                                    uint16_t scale_q8, uint8_t flags)
+{
+    lottie_player_t *player = heap_caps_calloc(1, sizeof(lottie_player_t), MALLOC_CAP_SPIRAM);
+    if (!player) {
+        ESP_LOGE(TAG, "播放器分配失败");
+        heap_caps_free(data);
+        return NULL;
+    }
+
+    player->json = data;
+    player->width = width;
+    player->height = height;
+    player->flags = flags;
+    player->last_frame = -1;
+    player->frame_step = 1;
+
+    // 分配渲染缓冲区（按原始尺寸，动态比例切换时无需重新分配）
+    size_t buffer_size = (size_t)width * height * 4; // ARGB8888
+    player->buf = heap_caps_malloc(buffer_size, MALLOC_CAP_SPIRAM);
+    if (!player->buf) {
+        ESP_LOGE(TAG, "PSRAM缓冲区分配失败 (需要 %zu 字节)", buffer_size);
+        goto error;
+    }
+
+    // 场景分区：未启用、分区数或页池用尽时退回通用堆
+    player->arena = lottie_arena_create();
+#if CONFIG_LOTTIE_SCENE_ARENA
+    if (!player->arena) {
+        ESP_LOGW(TAG, "无可用场景分区，使用通用堆");
+    }
+#endif
+
+    // 画布（含渲染器）在分区外创建，动画和解析树进入分区
+    player->canvas = tvg_swcanvas_create();
+    lottie_arena_t *prev = lottie_arena_enter(player->arena);
+    player->anim = tvg_lottie_animation_new();
+    if (!player->canvas || !player->anim) {
+        lottie_arena_enter(prev);
+        ESP_LOGE(TAG, "创建ThorVG画布/动画失败");
+        goto error;
+    }
+
+    // 解析JSON并构建场景（最耗时的一步），不复制JSON，数据由播放器持有到销毁
+    Tvg_Paint *picture = tvg_animation_get_picture(player->anim);
+    if (tvg_picture_load_data(picture, (const char *)data, size, "lottie", false) != TVG_RESULT_SUCCESS) {
+        lottie_arena_enter(prev);
+        ESP_LOGE(TAG, "Lottie数据解析失败");
+        goto error;
+    }
+    lottie_arena_enter(prev);
+
+    player->dsc.header.magic = LV_IMAGE_HEADER_MAGIC;
+    player->dsc.header.cf = (flags & LOTTIE_PLAYER_FLAG_OPAQUE) ?
+                            LV_COLOR_FORMAT_XRGB8888 : LV_COLOR_FORMAT_ARGB8888;
+    player->dsc.data = (const uint8_t *)player->buf;
+    if (!player_apply_scale(player, scale_q8)) {
+        goto error;
+    }
+    tvg_canvas_push(player->canvas, picture);
+
+    tvg_animation_get_total_frame(player->anim, &player->total_frames);
+    tvg_animation_get_duration(player->anim, &player->duration);
+
+    // 帧预算：动画帧间隔与LVGL刷新周期中较长者，留1/4给混合和刷屏
+    uint32_t frame_us = player->total_frames > 0 ?
+                        (uint32_t)(player->duration * 1000000.0f / player->total_frames) : 0;
+    if (frame_us < LV_DEF_REFR_PERIOD * 1000) {
+        frame_us = LV_DEF_REFR_PERIOD * 1000;
+    }
+    player->frame_budget_us = frame_us * 3 / 4;
+
+    // 首帧光栅化，发布后可立即显示
+    lottie_player_render(player, 0);
+    return player;
+
+error:
+    lottie_player_destroy(player);
+    return NULL;
+}
+
+bool lottie_player_load_background(lottie_player_t *player, uint8_t *data, size_t size)
+{
+    if (!player) {
+        heap_caps_free(data);
+        return false;
+    }
+
+    lottie_player_t *bg = lottie_player_load(data, size, player->width, player->height,
+                                             LOTTIE_SCALE_Q8_FULL, 0);
+    if (!bg) {
+        return false;
+    }
+
+    uint32_t count = (uint32_t)player->width * player->height;
+    bool opaque = true;
+    for (uint32_t i = 0; i < count && opaque; i++) {
+        opaque = (bg->buf[i] >> 24) == 0xFF;
+    }
+
+    // RGB565A8：RGB565平面后接A8平面
+    size_t size_out = (size_t)count * (opaque ? 2 : 3);
+    uint8_t *out = heap_caps_malloc(size_out, MALLOC_CAP_SPIRAM);
+    if (!out) {
+        ESP_LOGE(TAG, "背景缓冲区分配失败 (需要 %zu 字节)", size_out);
+        lottie_player_destroy(bg);
+        return false;
+    }
+
+    uint16_t *rgb = (uint16_t *)out;
+    uint8_t *alpha = out + (size_t)count * 2;
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t c = bg->buf[i];
+        uint32_t a = c >> 24;
+        uint32_t r = (c >> 16) & 0xFF;
+        uint32_t g = (c >> 8) & 0xFF;
+        uint32_t b = c & 0xFF;
+        // ThorVG输出预乘alpha，转回直通alpha
+        if (a && a < 0xFF) {
+            r = r * 255 / a;
+            g = g * 255 / a;
+            b = b * 255 / a;
+        }
+        rgb[i] = (uint16_t)(((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3));
+        if (!opaque) {
+            alpha[i] = (uint8_t)a;
+        }
+    }
+    lottie_player_destroy(bg);
+
+    heap_caps_free(player->bg_buf);
+    player->bg_buf = out;
+    memset(&player->bg_dsc, 0, sizeof(player->bg_dsc));
+    player->bg_dsc.header.magic = LV_IMAGE_HEADER_MAGIC;
+    player->bg_dsc.header.cf = opaque ? LV_COLOR_FORMAT_RGB565 : LV_COLOR_FORMAT_RGB565A8;
+    player->bg_dsc.header.w = player->width;
+    player->bg_dsc.header.h = player->height;
+    player->bg_dsc.header.stride = player->width * 2;
+    player->bg_dsc.data = out;
+    player->bg_dsc.data_size = (uint32_t)size_out;
+
+    ESP_LOGI(TAG, "静态背景: %dx%d %s, %zu 字节", player->width, player->height,
+             opaque ? "RGB565" : "RGB565A8", size_out);
+    return true;
+}
+
+bool lottie_player_load_holds(lottie_player_t *player, uint8_t *data, size_t size)
+{
+    if (!player || !data) {
+        heap_caps_free(data);
+        return false;
+    }
+
+    // magic u32 + version u16 + count u16，之后 count 组 (start u16, end u16)
+    uint32_t magic;
+    uint16_t version, count;
+    if (size < 8) {
+        goto invalid;
+    }
+    memcpy(&magic, data, 4);
+    memcpy(&version, data + 4, 2);
+    memcpy(&count, data + 6, 2);
+    if (magic != LOTTIE_HOLD_MAGIC || version != LOTTIE_HOLD_VERSION || size != 8 + (size_t)count * 4) {
+        goto invalid;
+    }
+
+    heap_caps_free(player->hold_data);
+    player->hold_data = data;
+    player->holds = (const uint16_t *)(data + 8);
+    player->hold_count = count;
+    player->hold_skipped = 0;
+    return true;
+
+invalid:
+    ESP_LOGW(TAG, "静止区间文件格式不符，忽略");
+    heap_caps_free(data);
+    return false;
+}
+
+// 两帧是否处于同一静止区间（区间按帧号升序，二分查找）
+static bool player_same_hold(const lottie_player_t *player, int32_t a, int32_t b)
+{
+    int lo = 0;
+    int hi = (int)player->hold_count - 1;
+    while (lo <= hi) {
+        int mid = (lo + hi) / 2;
+        int32_t start = player->holds[mid * 2];
+        int32_t end = player->holds[mid * 2 + 1];
+        if (a < start) {
+            hi = mid - 1;
+        } else if (a > end) {
+            lo = mid + 1;
+        } else {
+            return b >= start && b <= end;
+        }
+    }
+    return false;
+}
+
+bool lottie_player_render(lottie_player_t *player, int32_t frame)
+{
+    if (!player) {
+        return false;
+    }
+    if (player->frame_step > 1) {
+        frame -= frame % player->frame_step;
+    }
+    if (frame == player->last_frame) {
+        return false;
+    }
+    // 缓冲区中已是同一画面，不光栅化，调用方也无需刷新
+    if (player->last_frame >= 0 && player->hold_count &&
+        player_same_hold(player, player->last_frame, frame)) {
+        player->last_frame = frame;
+        player->hold_skipped++;
+        return false;
+    }
+
+    int64_t start = esp_timer_get_time();
+    // 不透明动画每帧完整覆盖缓冲区，只有首帧需要清空
+    if (!(player->flags & LOTTIE_PLAYER_FLAG_OPAQUE) || player->last_frame < 0) {
+        memset(player->buf, 0, player->dsc.data_size);
+    }
+    // 切帧重建场景节点（属于动画，进入分区）；光栅化使用渲染器的共享内存池，在分区外
+    lottie_arena_t *prev = lottie_arena_enter(player->arena);
+    tvg_animation_set_frame(player->anim, (float)frame);
+    lottie_arena_enter(prev);
+    tvg_canvas_update(player->canvas);
+    tvg_canvas_draw(player->canvas);
+    tvg_canvas_sync(player->canvas);
+    uint32_t render_us = (uint32_t)(esp_timer_get_time() - start);
+    player->render_us_total += render_us;
+    player->render_count++;
+
+    if (render_us > player->frame_budget_us) {
+        if (player->miss_count < UINT8_MAX) {
+            player->miss_count++;
+        }
+    } else {
+        player->miss_count = 0;
+    }
+
+    player->last_frame = frame;
+    return true;
+}
+
+bool lottie_player_override(lottie_player_t *player, const char *slots_json)
+{
+    if (!player) {
+        return false;
+    }
+
+    lottie_arena_t *prev = lottie_arena_enter(player->arena);
+    Tvg_Result ret = tvg_lottie_animation_override(player->anim, slots_json);
+    lottie_arena_enter(prev);
+    if (ret != TVG_RESULT_SUCCESS) {
+        ESP_LOGE(TAG, "插槽覆盖失败: %s", slots_json ? slots_json : "(reset)");
+        return false;
+    }
+    player->last_frame = -1;
+    return true;
+}
+
+bool lottie_player_set_scale(lottie_player_t *player, uint16_t scale_q8)
+{
+    if (!player || scale_q8 == player->scale_q8) {
+        return false;
+    }
+
+    return player_apply_scale(player, scale_q8);
+}
+
+uint16_t lottie_player_scale_downgrade(const lottie_player_t *player)
+{
+    if (!(player->flags & LOTTIE_PLAYER_FLAG_DYNAMIC_SCALE) ||
+        player->miss_count < LOTTIE_SCALE_MISS_LIMIT) {
+        return 0;
+    }
+
+    if (player->scale_q8 > LOTTIE_SCALE_Q8_3_4) {
+        return LOTTIE_SCALE_Q8_3_4;
+    }
+    if (player->scale_q8 > LOTTIE_SCALE_Q8_1_2) {
+        return LOTTIE_SCALE_Q8_1_2;
+    }
+    return 0;
+}
+
+// 双线性采样缩小渲染结果（与LVGL拉伸显示一致），返回与参考帧的平方误差和
+static uint64_t player_upscale_sse(const uint32_t *ref, uint16_t w, uint16_t h,
+                                   const uint32_t *src, uint16_t sw, uint16_t sh)
+{
+    uint64_t sse = 0;
+    for (uint16_t y = 0; y < h; y++) {
+        float fy = ((float)y + 0.5f) * sh / h - 0.5f;
+        int y0 = fy < 0 ? 0 : (int)fy;
+        int y1 = y0 + 1 < sh ? y0 + 1 : y0;
+        float ty = fy < 0 ? 0 : fy - y0;
+        for (uint16_t x = 0; x < w; x++) {
+            float fx = ((float)x + 0.5f) * sw / w - 0.5f;
+            int x0 = fx < 0 ? 0 : (int)fx;
+            int x1 = x0 + 1 < sw ? x0 + 1 : x0;
+            float tx = fx < 0 ? 0 : fx - x0;
+            uint32_t p00 = src[y0 * sw + x0], p01 = src[y0 * sw + x1];
+            uint32_t p10 = src[y1 * sw + x0], p11 = src[y1 * sw + x1];
+            uint32_t r = ref[y * w + x];
+            for (int shift = 0; shift < 32; shift += 8) {
+                float top = ((p00 >> shift) & 0xFF) * (1 - tx) + ((p01 >> shift) & 0xFF) * tx;
+                float bot = ((p10 >> shift) & 0xFF) * (1 - tx) + ((p11 >> shift) & 0xFF) * tx;
+                int d = (int)(top * (1 - ty) + bot * ty + 0.5f) - (int)((r >> shift) & 0xFF);
+                sse += (uint64_t)(d * d);
+            }
+        }
+    }
+    return sse;
+}
+
+void lottie_player_profile_scales(lottie_player_t *player)
+{
+    static const uint16_t scales[] = {LOTTIE_SCALE_Q8_FULL, LOTTIE_SCALE_Q8_3_4, LOTTIE_SCALE_Q8_1_2};
+    const int samples = 4;
+    size_t ref_size = (size_t)player->width * player->height * 4;
+    uint32_t *ref = heap_caps_malloc(ref_size, MALLOC_CAP_SPIRAM);
+    if (!ref) {
+        ESP_LOGE(TAG, "参考帧缓冲区分配失败 (需要 %zu 字节)", ref_size);
+        return;
+    }
+
+    uint16_t old_scale = player->scale_q8;
+    uint8_t old_flags = player->flags;
+    player->flags &= ~LOTTIE_PLAYER_FLAG_OPAQUE;    // 每次都清空，保证各比例可比
+    uint64_t time_us[3] = {0};
+    uint64_t sse[3] = {0};
+
+    for (int i = 0; i < samples; i++) {
+        int32_t frame = (int32_t)(player->total_frames * i / samples);
+
+        player_apply_scale(player, LOTTIE_SCALE_Q8_FULL);
+        lottie_player_render(player, frame);
+        memcpy(ref, player->buf, ref_size);
+
+        for (int s = 0; s < 3; s++) {
+            player_apply_scale(player, scales[s]);
+            int64_t start = esp_timer_get_time();
+            lottie_player_render(player, frame);
+            time_us[s] += esp_timer_get_time() - start;
+            sse[s] += player_upscale_sse(ref, player->width, player->height,
+                                         player->buf, player->render_width, player->render_height);
+        }
+    }
+
+    for (int s = 0; s < 3; s++) {
+        double mse = (double)sse[s] / ((double)player->width * player->height * 4 * samples);
+        double psnr = mse > 0 ? 10.0 * log10(255.0 * 255.0 / mse) : INFINITY;
+        ESP_LOGI(TAG, "渲染比例 %3u/256 (%dx%d): 光栅化 %lu us/帧, PSNR %.1f dB", scales[s],
+                 player->width, player->height, (unsigned long)(time_us[s] / samples), psnr);
+    }
+
+    heap_caps_free(ref);
+    player->flags = old_flags;
+    player_apply_scale(player, old_scale);
+}
+
+// 预热用的最小Lottie：一个填充矩形，覆盖解析、场景构建和光栅化的路径
+static const char s_warmup_json[] =
+    "{\"v\":\"5.7.0\",\"fr\":30,\"ip\":0,\"op\":2,\"w\":16,\"h\":16,\"layers\":[{\"ty\":4,"
+    "\"ip\":0,\"op\":2,\"st\":0,\"ks\":{},\"shapes\":[{\"ty\":\"rc\",\"p\":{\"a\":0,\"k\":[8,8]},"
+    "\"s\":{\"a\":0,\"k\":[12,12]},\"r\":{\"a\":0,\"k\":2}},{\"ty\":\"fl\","
+    "\"c\":{\"a\":0,\"k\":[1,0.5,0.25,1]},\"o\":{\"a\":0,\"k\":100}}]}]}";
+
+void lottie_player_warmup(void)
+{
+    lottie_arena_t *prev = lottie_arena_enter(NULL);
+
+    // 库内部按需分配、之后一直持有的状态（渲染器共享内存池、newlib的浮点转换缓冲等）
+    // 在这里首次分配，不会落进之后某个动画的分区
+    uint32_t *buf = heap_caps_malloc(16 * 16 * 4, MALLOC_CAP_SPIRAM);
+    Tvg_Canvas *canvas = tvg_swcanvas_create();
+    Tvg_Animation *anim = tvg_lottie_animation_new();
+    if (buf && canvas && anim &&
+        tvg_swcanvas_set_target(canvas, buf, 16, 16, 16, TVG_COLORSPACE_ARGB8888) == TVG_RESULT_SUCCESS &&
+        tvg_picture_load_data(tvg_animation_get_picture(anim), s_warmup_json, sizeof(s_warmup_json) - 1,
+                              "lottie", true) == TVG_RESULT_SUCCESS) {
+        tvg_canvas_push(canvas, tvg_animation_get_picture(anim));
+        tvg_animation_set_frame(anim, 1.0f);
+        tvg_canvas_update(canvas);
+        tvg_canvas_draw(canvas);
+        tvg_canvas_sync(canvas);
+    } else {
+        ESP_LOGW(TAG, "ThorVG预热失败");
+    }
+    if (anim) {
+        tvg_animation_del(anim);
+    }
+    if (canvas) {
+        tvg_canvas_destroy(canvas);
+    }
+    heap_caps_free(buf);
+
+    char num[48];
+    snprintf(num, sizeof(num), "%f %g", 123456789.125, 1e-7);
+    (void)strtod(num, NULL);
+
+    lottie_arena_enter(prev);
+}
+
+void lottie_player_destroy(lottie_player_t *player)
+{
+    if (!player) {
+        return;
+    }
+
+    if (player->arena) {
+        lottie_arena_stats_t stats;
+        lottie_arena_get_stats(player->arena, &stats);
+        ESP_LOGD(TAG, "场景分区: %lu 页, 峰值 %lu 字节, %lu 次分配, %lu 次转入通用堆",
+                 (unsigned long)stats.pages, (unsigned long)stats.peak_bytes,
+                 (unsigned long)stats.alloc_count, (unsigned long)stats.overflow_count);
+        // 分区销毁后仍被释放的内存说明有状态不属于场景却落进了分区
+        static uint32_t stale_reported;
+        uint32_t stale = lottie_arena_pool_stale_frees();
+        if (stale != stale_reported) {
+            ESP_LOGW(TAG, "已忽略 %lu 次过期的分区内存释放", (unsigned long)stale);
+            stale_reported = stale;
+        }
+        // 丢弃后ThorVG析构中对分区内存的释放直接返回，最后整体归还页池
+        lottie_arena_drop(player->arena);
+    }
+    if (player->anim) {
+        tvg_animation_del(player->anim);
+    }
+    if (player->canvas) {
+        tvg_canvas_destroy(player->canvas);
+    }
+    lottie_arena_destroy(player->arena);
+    if (player->buf) {
+        heap_caps_free(player->buf);
+    }
+    if (player->json) {
+        heap_caps_free(player->json);
+    }
+    if (player->bg_buf) {
+        heap_caps_free(player->bg_buf);
+    }
+    if (player->hold_data) {
+        heap_caps_free(player->hold_data);
+    }
+    heap_caps_free(player);
+}
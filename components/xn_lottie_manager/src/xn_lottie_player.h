@@ -0,0 +1,160 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Description: 基于ThorVG的Lottie播放器（脱离LVGL对象独立加载/渲染）
+ */
+
+#pragma once
+
+#include "lvgl.h"
+#include "src/libs/thorvg/thorvg_capi.h"
+#include "xn_lottie_arena.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// 播放器标志
+// 不透明：动画每帧都完整覆盖画面（如带满屏背景）。渲染前不再清空缓冲区，
+// 并以 XRGB8888 交给LVGL，LVGL按不透明图片直接转换复制，不做逐像素alpha混合，
+// 同时该对象可遮挡下层，LVGL不再重绘其下方的背景
+#define LOTTIE_PLAYER_FLAG_OPAQUE   (1 << 0)
+// 动态渲染比例：连续超出帧预算时逐级降低渲染比例（1 -> 3/4 -> 1/2）
+#define LOTTIE_PLAYER_FLAG_DYNAMIC_SCALE (1 << 1)
+
+// 渲染比例（Q8定点，256为原始尺寸）。缩小渲染后由 lv_image 拉伸到目标尺寸
+#define LOTTIE_SCALE_Q8_FULL        256
+#define LOTTIE_SCALE_Q8_3_4         192
+#define LOTTIE_SCALE_Q8_1_2         128
+
+// 动态比例：连续超出帧预算多少帧后降级
+#define LOTTIE_SCALE_MISS_LIMIT     3
+
+// 静止区间文件（构建工具按关键帧时间线生成的 name.hold）
+#define LOTTIE_HOLD_MAGIC           0x444C484C  // "LHLD"
+#define LOTTIE_HOLD_VERSION         1
+
+// Lottie播放器：ThorVG场景 + ARGB8888渲染缓冲区
+typedef struct {
+    Tvg_Canvas *canvas;         // ThorVG软件画布
+    Tvg_Animation *anim;        // ThorVG Lottie动画（持有解析后的场景，支持插槽覆盖）
+    uint32_t *buf;              // ARGB8888渲染缓冲区（PSRAM，按原始尺寸分配）
+    uint8_t *json;              // JSON数据（ThorVG不复制，直接引用，随播放器释放）
+    lv_image_dsc_t dsc;         // 交给 lv_image 显示的描述符
+    uint16_t width;             // 目标显示尺寸
+    uint16_t height;
+    uint16_t render_width;      // 实际光栅化尺寸（按渲染比例缩小）
+    uint16_t render_height;
+    uint16_t scale_q8;          // 当前渲染比例
+    uint8_t flags;              // LOTTIE_PLAYER_FLAG_*
+    float total_frames;         // 总帧数
+    float duration;             // 时长（秒）
+    int32_t last_frame;         // 最近一次渲染的帧，-1表示未渲染
+    uint8_t frame_step;         // 帧步长（质量预设），帧号向下取整到步长的倍数
+    uint8_t lod;                // 加载的LOD变体
+    uint32_t render_count;      // 光栅化次数
+    uint64_t render_us_total;   // 光栅化累计耗时
+    uint32_t frame_budget_us;   // 帧预算（动态比例判断超时用）
+    uint8_t miss_count;         // 连续超出帧预算的帧数
+    uint8_t *bg_buf;            // 静态背景（加载时光栅化一次，RGB565/RGB565A8），无背景为NULL
+    lv_image_dsc_t bg_dsc;      // 背景描述符
+    lottie_arena_t *arena;      // 场景内存分区（解析树和场景节点在其中），NULL表示使用通用堆
+    uint8_t *hold_data;         // 静止区间文件数据，无则为NULL
+    const uint16_t *holds;      // 静止区间 (start, end) 对，按帧号升序，区间内各帧画面相同
+    uint16_t hold_count;
+    uint32_t hold_skipped;      // 静止区间内跳过光栅化的帧数
+} lottie_player_t;
+
+/**
+ * @brief 加载Lottie数据并渲染首帧（耗时操作，不访问任何LVGL对象，无需持有lv_lock）
+ *
+ * 播放器接管 data（无论成功失败都由播放器释放），ThorVG直接引用该数据而不再复制一份。
+ *
+ * @param data JSON数据（heap_caps_malloc分配，末尾需有'\0'）
+ * @param size 数据长度（不含末尾'\0'）
+ * @param width 渲染宽度
+ * @param height 渲染高度
+ * @param scale_q8 渲染比例 LOTTIE_SCALE_Q8_*
+ * @param flags 播放器标志 LOTTIE_PLAYER_FLAG_*
+ * @return 播放器指针，失败返回NULL
+ */
+lottie_player_t *lottie_player_load(uint8_t *data, size_t size, uint16_t width, uint16_t height,
+                                    uint16_t scale_q8, uint8_t flags);
+
+/**
+ * @brief 加载静态背景（构建工具拆分出的 name.bg.json），光栅化一次后只保留像素
+ *
+ * 背景按目标显示尺寸渲染首帧，转换为 RGB565（全不透明时）或 RGB565A8 后释放场景，
+ * 之后每帧只光栅化动画部分。接管 data，与 lottie_player_load 相同。
+ *
+ * @param player 播放器
+ * @param data 背景JSON数据
+ * @param size 数据长度
+ * @return true 成功
+ */
+bool lottie_player_load_background(lottie_player_t *player, uint8_t *data, size_t size);
+
+/**
+ * @brief 加载静止区间（构建工具生成的 name.hold），之后同一区间内的帧不再光栅化
+ *
+ * 接管 data，与 lottie_player_load 相同；格式不符时丢弃，按普通方式渲染。
+ *
+ * @param player 播放器
+ * @param data 静止区间文件数据
+ * @param size 数据长度
+ * @return true 成功
+ */
+bool lottie_player_load_holds(lottie_player_t *player, uint8_t *data, size_t size);
+
+/**
+ * @brief 渲染指定帧到缓冲区（按帧步长取整后与上次相同的帧、与上次处于同一静止区间的帧直接跳过）
+ * @param player 播放器
+ * @param frame 帧号
+ * @return true 缓冲区内容有变化
+ */
+bool lottie_player_render(lottie_player_t *player, int32_t frame);
+
+/**
+ * @brief 覆盖插槽属性（不重新解析场景），下次渲染生效
+ * @param player 播放器
+ * @param slots_json 插槽JSON，如 {"ring_fill":{"p":{"a":0,"k":[1,0,0]}}}；NULL恢复原始属性
+ * @return true 成功
+ */
+bool lottie_player_override(lottie_player_t *player, const char *slots_json);
+
+/**
+ * @brief 修改渲染比例（修改 dsc 尺寸，已发布的播放器需先丢弃LVGL图片缓存再重新设置图片源）
+ * @param player 播放器
+ * @param scale_q8 渲染比例 LOTTIE_SCALE_Q8_*
+ * @return true 成功
+ */
+bool lottie_player_set_scale(lottie_player_t *player, uint16_t scale_q8);
+
+/**
+ * @brief 动态比例是否需要降级（连续超出帧预算且尚未到最低比例）
+ * @param player 播放器
+ * @return 建议的新渲染比例，无需降级时返回0
+ */
+uint16_t lottie_player_scale_downgrade(const lottie_player_t *player);
+
+/**
+ * @brief 测量各渲染比例的光栅化时间和视觉误差（调试用，耗时，只能在后台任务中对未发布的播放器调用）
+ *
+ * 对若干采样帧，以原始尺寸渲染结果为参考，把缩小渲染的结果双线性放大后计算PSNR。
+ *
+ * @param player 播放器
+ */
+void lottie_player_profile_scales(lottie_player_t *player);
+
+/**
+ * @brief 在分区外预热ThorVG和C库（加载一个内置的最小动画并渲染一帧）
+ *
+ * 渲染器共享内存池、C库的浮点转换缓冲等在首次使用时分配并一直持有，
+ * 必须在本任务第一次进入场景分区之前调用，否则会落进某个动画的分区，随分区销毁。
+ * 每个调用播放器接口的任务（加载任务、LVGL任务）各调用一次。
+ */
+void lottie_player_warmup(void);
+
+/**
+ * @brief 销毁播放器（调用前需确保LVGL不再引用其缓冲区）
+ * @param player 播放器，可为NULL
+ */
+void lottie_player_destroy(lottie_player_t *player);
@@ -0,0 +1,148 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Description: 动画切换预测实现
+ *
+ * 转移表只在LVGL上下文中读写；保存时先在LVGL上下文复制快照，再由后台任务写入NVS，
+ * 避免擦写Flash阻塞刷新。
+ */
+
+#include "xn_lottie_predict.h"
+#include "esp_log.h"
+#include "nvs.h"
+#include <stdatomic.h>
+#include <string.h>
+
+static const char *TAG = "LOTTIE_PREDICT";
+
+#define PREDICT_NVS_NAMESPACE   "xn_lottie"
+#define PREDICT_NVS_KEY         "markov"
+#define PREDICT_VERSION         1
+
+typedef struct {
+    uint16_t version;
+    uint16_t anim_count;
+    uint16_t counts[LOTTIE_PREDICT_MAX_ANIMS][LOTTIE_PREDICT_MAX_ANIMS];
+} predict_table_t;
+
+static predict_table_t g_table;         // LVGL上下文
+static predict_table_t g_snapshot;      // 待保存的快照（后台任务写入NVS）
+static bool g_dirty = false;
+static atomic_bool g_saving;
+
+void lottie_predict_init(int anim_count)
+{
+    if (anim_count > LOTTIE_PREDICT_MAX_ANIMS) {
+        ESP_LOGW(TAG, "动画类型数 %d 超出转移表容量，只预测前 %d 个", anim_count, LOTTIE_PREDICT_MAX_ANIMS);
+        anim_count = LOTTIE_PREDICT_MAX_ANIMS;
+    }
+
+    memset(&g_table, 0, sizeof(g_table));
+    g_table.version = PREDICT_VERSION;
+    g_table.anim_count = (uint16_t)anim_count;
+
+    nvs_handle_t handle;
+    if (nvs_open(PREDICT_NVS_NAMESPACE, NVS_READONLY, &handle) != ESP_OK) {
+        ESP_LOGI(TAG, "无已保存的转移表，重新学习");
+        return;
+    }
+
+    predict_table_t saved;
+    size_t size = sizeof(saved);
+    esp_err_t ret = nvs_get_blob(handle, PREDICT_NVS_KEY, &saved, &size);
+    nvs_close(handle);
+
+    if (ret != ESP_OK || size != sizeof(saved) || saved.version != PREDICT_VERSION ||
+        saved.anim_count != anim_count) {
+        ESP_LOGI(TAG, "转移表不存在或动画配置已变化，重新学习");
+        return;
+    }
+
+    g_table = saved;
+    ESP_LOGI(TAG, "已恢复转移表 (%d 种动画)", anim_count);
+}
+
+void lottie_predict_record(int from, int to)
+{
+    // 重复播放同一个动画不算切换，否则会预测（并预加载）正在显示的动画
+    if (from < 0 || to < 0 || from >= g_table.anim_count || to >= g_table.anim_count || from == to) {
+        return;
+    }
+
+    uint16_t *row = g_table.counts[from];
+    uint32_t total = 0;
+    for (int i = 0; i < g_table.anim_count; i++) {
+        total += row[i];
+    }
+    if (total >= LOTTIE_PREDICT_ROW_MAX) {
+        for (int i = 0; i < g_table.anim_count; i++) {
+            row[i] /= 2;
+        }
+    }
+    row[to]++;
+    g_dirty = true;
+}
+
+int lottie_predict_next(int from, uint8_t *share_pct)
+{
+    if (from < 0 || from >= g_table.anim_count) {
+        return -1;
+    }
+
+    const uint16_t *row = g_table.counts[from];
+    uint32_t total = 0;
+    int best = -1;
+    for (int i = 0; i < g_table.anim_count; i++) {
+        // 旧版本保存的转移表可能含自身转移，忽略
+        if (i == from) {
+            continue;
+        }
+        total += row[i];
+        if (best < 0 || row[i] > row[best]) {
+            best = i;
+        }
+    }
+    if (best < 0 || row[best] < LOTTIE_PREDICT_MIN_COUNT) {
+        return -1;
+    }
+
+    uint8_t share = (uint8_t)(row[best] * 100 / total);
+    if (share_pct) {
+        *share_pct = share;
+    }
+    return share >= LOTTIE_PREDICT_MIN_SHARE ? best : -1;
+}
+
+bool lottie_predict_begin_save(void)
+{
+    if (!g_dirty || atomic_load(&g_saving)) {
+        return false;
+    }
+
+    g_snapshot = g_table;
+    g_dirty = false;
+    atomic_store(&g_saving, true);
+    return true;
+}
+
+void lottie_predict_abort_save(void)
+{
+    g_dirty = true;
+    atomic_store(&g_saving, false);
+}
+
+void lottie_predict_save(void)
+{
+    nvs_handle_t handle;
+    esp_err_t ret = nvs_open(PREDICT_NVS_NAMESPACE, NVS_READWRITE, &handle);
+    if (ret == ESP_OK) {
+        ret = nvs_set_blob(handle, PREDICT_NVS_KEY, &g_snapshot, sizeof(g_snapshot));
+        if (ret == ESP_OK) {
+            ret = nvs_commit(handle);
+        }
+        nvs_close(handle);
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "保存转移表失败: %s", esp_err_to_name(ret));
+    }
+    atomic_store(&g_saving, false);
+}
@@ -0,0 +1,56 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Description: 动画切换预测（一阶马尔可夫转移计数表，持久化到NVS）
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// 转移表支持的最大动画类型数
+#define LOTTIE_PREDICT_MAX_ANIMS    16
+
+// 预测下一动画所需的最少转移次数和最低占比（百分比）
+#define LOTTIE_PREDICT_MIN_COUNT    3
+#define LOTTIE_PREDICT_MIN_SHARE    40
+
+// 单行计数达到上限时整行减半，让旧习惯逐渐淡出
+#define LOTTIE_PREDICT_ROW_MAX      1024
+
+/**
+ * @brief 初始化转移表并从NVS恢复（动画类型数与保存时不同则重新学习）
+ * @param anim_count 动画类型数
+ */
+void lottie_predict_init(int anim_count);
+
+/**
+ * @brief 记录一次动画切换（仅在LVGL上下文调用，from == to 时忽略）
+ * @param from 上一个动画类型
+ * @param to 新动画类型
+ */
+void lottie_predict_record(int from, int to);
+
+/**
+ * @brief 预测下一个动画（仅在LVGL上下文调用）
+ * @param from 当前动画类型
+ * @param share_pct 输出该转移的占比（百分比），可为NULL
+ * @return 最可能的下一个动画类型（不会是 from），样本不足或不够确定时返回-1
+ */
+int lottie_predict_next(int from, uint8_t *share_pct);
+
+/**
+ * @brief 有未保存的修改时生成快照，准备保存（仅在LVGL上下文调用）
+ * @return true 已生成快照，需调用 lottie_predict_save 或 lottie_predict_abort_save
+ */
+bool lottie_predict_begin_save(void);
+
+/**
+ * @brief 放弃本次保存（快照未能交给后台任务时调用），修改保留到下次保存
+ */
+void lottie_predict_abort_save(void);
+
+/**
+ * @brief 将快照写入NVS（写Flash，只在后台任务中调用）
+ */
+void lottie_predict_save(void);
@@ -0,0 +1,458 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Description: 管理器命令流录制与回放实现
+ *
+ * 录制在LVGL上下文中按执行顺序进行（与提交顺序一致），时间取命令的提交时间，
+ * 每条命令压缩为20字节的记录，路径和插槽名放入字符串表。
+ * 回放在独立任务中按记录的时间间隔重新调用管理器公共接口，与现场一样经过命令队列；
+ * 回放期间LVGL上下文累计切换延迟、渲染/丢帧和最低空闲内存，结束后输出报告。
+ */
+
+#include "xn_lottie_trace.h"
+#include "xn_lottie_manager.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <stdatomic.h>
+#include <stdio.h>
+#include <string.h>
+
+static const char *TAG = "LOTTIE_TRACE";
+
+// 回放任务
+#define TRACE_REPLAY_STACK_SIZE     4096
+#define TRACE_REPLAY_PRIORITY       2
+
+// 录制（LVGL上下文）
+static EXT_RAM_BSS_ATTR lottie_trace_rec_t g_recs[LOTTIE_TRACE_RECORDS];
+static char g_strings[LOTTIE_TRACE_STRINGS][LOTTIE_CMD_PATH_MAX];
+static uint8_t g_str_count = 0;
+static uint32_t g_head = 0;             // 已录制的总条数
+static bool g_recording = false;
+static int64_t g_start_us = 0;
+
+// 回放统计（LVGL上下文写入，回放任务在结束后读取）
+typedef struct {
+    uint32_t switches;
+    uint64_t switch_sum_us;
+    uint32_t switch_max_us;
+    uint32_t frames;
+    uint32_t dropped;
+    size_t min_free_psram;
+    size_t min_free_internal;
+} trace_replay_stats_t;
+
+static trace_replay_stats_t g_replay;
+static atomic_bool g_replaying;         // 回放任务运行中
+static atomic_bool g_measuring;         // 已进入统一初始状态，开始统计
+
+typedef struct {
+    lottie_trace_t *trace;
+    char path[LOTTIE_CMD_PATH_MAX];
+} trace_replay_arg_t;
+
+void lottie_trace_start(void)
+{
+    g_head = 0;
+    g_str_count = 0;
+    g_start_us = esp_timer_get_time();
+    g_recording = true;
+    ESP_LOGI(TAG, "开始录制命令流（最多 %d 条，超出后覆盖最早的记录）", LOTTIE_TRACE_RECORDS);
+}
+
+void lottie_trace_stop(void)
+{
+    if (g_recording) {
+        g_recording = false;
+        ESP_LOGI(TAG, "停止录制，共 %lu 条命令", (unsigned long)g_head);
+    }
+}
+
+static uint8_t trace_intern(const char *s)
+{
+    for (uint8_t i = 0; i < g_str_count; i++) {
+        if (strcmp(g_strings[i], s) == 0) {
+            return i;
+        }
+    }
+    if (g_str_count >= LOTTIE_TRACE_STRINGS) {
+        return LOTTIE_TRACE_NO_STR;
+    }
+    snprintf(g_strings[g_str_count], LOTTIE_CMD_PATH_MAX, "%s", s);
+    return g_str_count++;
+}
+
+static int16_t trace_clamp16(int32_t v)
+{
+    return v > INT16_MAX ? INT16_MAX : (v < INT16_MIN ? INT16_MIN : (int16_t)v);
+}
+
+void lottie_trace_record(const lottie_cmd_t *cmd)
+{
+    if (!g_recording) {
+        return;
+    }
+
+    switch (cmd->type) {
+    case LOTTIE_CMD_IMAGE_READY:
+    case LOTTIE_CMD_PUBLISH:
+    case LOTTIE_CMD_PRELOADED:
+    case LOTTIE_CMD_TRACE:
+        return;     // 内部命令和录制控制本身不录制
+    default:
+        break;
+    }
+
+    lottie_trace_rec_t *rec = &g_recs[g_head % LOTTIE_TRACE_RECORDS];
+    g_head++;
+    memset(rec, 0, sizeof(*rec));
+    int64_t t = cmd->post_us - g_start_us;
+    rec->time_ms = t > 0 ? (uint32_t)(t / 1000) : 0;
+    rec->type = (uint8_t)cmd->type;
+    rec->str = LOTTIE_TRACE_NO_STR;
+
+    switch (cmd->type) {
+    case LOTTIE_CMD_PLAY:
+        rec->arg = cmd->data.play.center;
+        rec->a = (int16_t)cmd->data.play.anim_type;
+        rec->b = cmd->data.play.x;
+        rec->c = cmd->data.play.y;
+        rec->value = ((uint32_t)cmd->data.play.width << 16) | cmd->data.play.height;
+        if (cmd->data.play.anim_type < 0) {
+            rec->str = trace_intern(cmd->data.play.path);
+        }
+        break;
+    case LOTTIE_CMD_STOP:
+        rec->a = (int16_t)cmd->data.stop.anim_type;
+        break;
+    case LOTTIE_CMD_SET_POS:
+    case LOTTIE_CMD_MOVE:
+        rec->a = cmd->data.pos.x;
+        rec->b = cmd->data.pos.y;
+        rec->value = cmd->type == LOTTIE_CMD_MOVE ? cmd->data.pos.duration_ms : 0;
+        break;
+    case LOTTIE_CMD_SHOW_IMAGE:
+        rec->str = trace_intern(cmd->data.image.path);
+        rec->value = ((uint32_t)cmd->data.image.width << 16) | cmd->data.image.height;
+        break;
+    case LOTTIE_CMD_DRIVE:
+        rec->arg = cmd->data.drive.enable;
+        rec->a = trace_clamp16(cmd->data.drive.start_frame);
+        rec->b = trace_clamp16(cmd->data.drive.end_frame);
+        break;
+    case LOTTIE_CMD_OVERRIDE:
+        rec->arg = (uint8_t)cmd->data.override.kind;
+        rec->value = cmd->data.override.value;
+        if (cmd->data.override.kind != LOTTIE_OVERRIDE_CLEAR) {
+            rec->str = trace_intern(cmd->data.override.slot);
+        }
+        break;
+    case LOTTIE_CMD_BATCH: {
+        // 批次头记录条数，随后逐条展开
+        const lottie_cmd_batch_t *batch = cmd->data.batch.batch;
+        rec->arg = batch->count;
+        for (uint8_t i = 0; i < batch->count; i++) {
+            lottie_trace_record(&batch->cmds[i]);
+        }
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+lottie_trace_t *lottie_trace_snapshot(void)
+{
+    uint32_t count = g_head < LOTTIE_TRACE_RECORDS ? g_head : LOTTIE_TRACE_RECORDS;
+    if (count == 0) {
+        ESP_LOGW(TAG, "没有录制的命令");
+        return NULL;
+    }
+
+    lottie_trace_t *trace = heap_caps_calloc(1, sizeof(lottie_trace_t), MALLOC_CAP_SPIRAM);
+    if (!trace) {
+        ESP_LOGE(TAG, "命令流快照分配失败");
+        return NULL;
+    }
+
+    trace->header.magic = LOTTIE_TRACE_MAGIC;
+    trace->header.version = LOTTIE_TRACE_VERSION;
+    trace->header.count = (uint16_t)count;
+    trace->header.str_count = g_str_count;
+    memcpy(trace->strings, g_strings, sizeof(g_strings));
+    uint32_t first = g_head - count;
+    for (uint32_t i = 0; i < count; i++) {
+        trace->recs[i] = g_recs[(first + i) % LOTTIE_TRACE_RECORDS];
+    }
+    return trace;
+}
+
+void lottie_trace_dump(const lottie_trace_t *trace)
+{
+    char hex[sizeof(lottie_trace_rec_t) * 2 + 1];
+
+    ESP_LOGI(TAG, "TRACE BEGIN %u %u", trace->header.count, trace->header.str_count);
+    for (uint8_t i = 0; i < trace->header.str_count; i++) {
+        ESP_LOGI(TAG, "TRACE S %u %s", i, trace->strings[i]);
+    }
+    for (uint16_t i = 0; i < trace->header.count; i++) {
+        const uint8_t *p = (const uint8_t *)&trace->recs[i];
+        for (size_t j = 0; j < sizeof(lottie_trace_rec_t); j++) {
+            snprintf(&hex[j * 2], 3, "%02x", p[j]);
+        }
+        ESP_LOGI(TAG, "TRACE R %s", hex);
+    }
+    ESP_LOGI(TAG, "TRACE END");
+}
+
+// 读取命令流文件（回放任务中调用）
+static lottie_trace_t *trace_load(const char *path)
+{
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        ESP_LOGE(TAG, "无法打开命令流文件: %s", path);
+        return NULL;
+    }
+
+    lottie_trace_t *trace = heap_caps_calloc(1, sizeof(lottie_trace_t), MALLOC_CAP_SPIRAM);
+    if (!trace) {
+        ESP_LOGE(TAG, "命令流分配失败");
+        fclose(f);
+        return NULL;
+    }
+
+    lottie_trace_header_t *hdr = &trace->header;
+    bool ok = fread(hdr, sizeof(*hdr), 1, f) == 1 &&
+              hdr->magic == LOTTIE_TRACE_MAGIC && hdr->version == LOTTIE_TRACE_VERSION &&
+              hdr->count <= LOTTIE_TRACE_RECORDS && hdr->str_count <= LOTTIE_TRACE_STRINGS &&
+              fread(trace->strings, LOTTIE_CMD_PATH_MAX, hdr->str_count, f) == hdr->str_count &&
+              fread(trace->recs, sizeof(lottie_trace_rec_t), hdr->count, f) == hdr->count;
+    fclose(f);
+    if (!ok) {
+        ESP_LOGE(TAG, "命令流文件格式错误: %s", path);
+        heap_caps_free(trace);
+        return NULL;
+    }
+
+    for (uint8_t i = 0; i < hdr->str_count; i++) {
+        trace->strings[i][LOTTIE_CMD_PATH_MAX - 1] = '\0';
+    }
+    return trace;
+}
+
+// 按记录调用管理器接口；批次头之后的 arg 条命令放入同一批次
+static void trace_replay_rec(const lottie_trace_t *trace, const lottie_trace_rec_t *rec, int *batch_left)
+{
+    const char *str = rec->str < trace->header.str_count ? trace->strings[rec->str] : NULL;
+    uint16_t w = (uint16_t)(rec->value >> 16);
+    uint16_t h = (uint16_t)(rec->value & 0xFFFF);
+
+    switch (rec->type) {
+    case LOTTIE_CMD_PLAY:
+        if (rec->a >= 0) {
+            rec->arg ? lottie_manager_play_anim(rec->a) : lottie_manager_play_anim_at_pos(rec->a, rec->b, rec->c);
+        } else if (str) {
+            rec->arg ? lottie_manager_play(str, w, h) : lottie_manager_play_at_pos(str, w, h, rec->b, rec->c);
+        } else {
+            ESP_LOGW(TAG, "跳过路径未录制的播放命令");
+        }
+        break;
+    case LOTTIE_CMD_STOP:
+        lottie_manager_stop_anim(rec->a);
+        break;
+    case LOTTIE_CMD_HIDE:
+        lottie_manager_hide();
+        break;
+    case LOTTIE_CMD_SHOW:
+        lottie_manager_show();
+        break;
+    case LOTTIE_CMD_SET_POS:
+        lottie_manager_set_pos(rec->a, rec->b);
+        break;
+    case LOTTIE_CMD_MOVE:
+        lottie_manager_move_to(rec->a, rec->b, (uint16_t)rec->value);
+        break;
+    case LOTTIE_CMD_CENTER:
+        lottie_manager_center();
+        break;
+    case LOTTIE_CMD_SHOW_IMAGE:
+        if (str) {
+            lottie_manager_show_image(str, w, h);
+        }
+        break;
+    case LOTTIE_CMD_HIDE_IMAGE:
+        lottie_manager_hide_image();
+        break;
+    case LOTTIE_CMD_DRIVE:
+        lottie_manager_drive_enable(rec->arg, rec->a, rec->b);
+        break;
+    case LOTTIE_CMD_OVERRIDE:
+        if (rec->arg == LOTTIE_OVERRIDE_CLEAR) {
+            lottie_manager_clear_overrides();
+        } else if (str && rec->arg == LOTTIE_OVERRIDE_COLOR) {
+            lottie_manager_set_color(str, rec->value);
+        } else if (str) {
+            lottie_manager_set_visible(str, rec->value != 0);
+        }
+        break;
+    case LOTTIE_CMD_BATCH:
+        if (*batch_left == 0 && rec->arg && lottie_manager_batch_begin()) {
+            *batch_left = rec->arg;
+        }
+        return;
+    default:
+        ESP_LOGW(TAG, "跳过未知命令记录: %u", rec->type);
+        break;
+    }
+
+    if (*batch_left > 0 && --(*batch_left) == 0) {
+        lottie_manager_batch_commit();
+    }
+}
+
+static void trace_replay_task(void *arg)
+{
+    trace_replay_arg_t *job = (trace_replay_arg_t *)arg;
+    lottie_trace_t *trace = job->trace ? job->trace : trace_load(job->path);
+    heap_caps_free(job);
+    if (!trace || trace->header.count == 0) {
+        heap_caps_free(trace);
+        atomic_store(&g_replaying, false);
+        vTaskDelete(NULL);
+        return;
+    }
+
+    // 统一初始状态
+    lottie_manager_stop();
+    lottie_manager_clear_overrides();
+    lottie_manager_drive_enable(false, 0, -1);
+    lottie_manager_hide_image();
+    vTaskDelay(pdMS_TO_TICKS(500));
+
+    lottie_manager_stats_t before, after;
+    lottie_manager_get_stats(&before);
+    size_t base_psram = heap_caps_get_free_size(MALLOC_CAP_SPIRAM);
+    size_t base_internal = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+    memset(&g_replay, 0, sizeof(g_replay));
+    g_replay.min_free_psram = base_psram;
+    g_replay.min_free_internal = base_internal;
+    atomic_store(&g_measuring, true);
+
+    uint16_t count = trace->header.count;
+    uint32_t base_ms = trace->recs[0].time_ms;
+    ESP_LOGI(TAG, "开始回放: %u 条命令, 时长 %lu ms", count,
+             (unsigned long)(trace->recs[count - 1].time_ms - base_ms));
+
+    TickType_t start = xTaskGetTickCount();
+    TickType_t wake = start;
+    int batch_left = 0;
+    for (uint16_t i = 0; i < count; i++) {
+        const lottie_trace_rec_t *rec = &trace->recs[i];
+        // 按记录的时间间隔提交；批次内的命令连续提交
+        int32_t dt_ms = (int32_t)(rec->time_ms - base_ms);
+        if (batch_left == 0 && dt_ms > 0) {
+            TickType_t target = pdMS_TO_TICKS(dt_ms);
+            TickType_t elapsed = wake - start;
+            if (target > elapsed) {
+                xTaskDelayUntil(&wake, target - elapsed);
+            }
+        }
+        trace_replay_rec(trace, rec, &batch_left);
+    }
+    if (batch_left > 0) {
+        lottie_manager_batch_commit();
+    }
+
+    vTaskDelay(pdMS_TO_TICKS(LOTTIE_TRACE_SETTLE_MS));
+    atomic_store(&g_measuring, false);
+    lottie_manager_get_stats(&after);
+
+    trace_replay_stats_t r = g_replay;
+    uint32_t total = r.frames + r.dropped;
+    ESP_LOGI(TAG, "回放报告: 命令 %u, 切换 %lu 次 (平均 %lu us, 最大 %lu us), 渲染 %lu 帧, 丢帧 %lu (%.1f%%), "
+             "命令丢弃 %lu, 峰值内存 PSRAM %u 字节, 内部 %u 字节",
+             count, (unsigned long)r.switches,
+             (unsigned long)(r.switches ? r.switch_sum_us / r.switches : 0), (unsigned long)r.switch_max_us,
+             (unsigned long)r.frames, (unsigned long)r.dropped, total ? 100.0 * r.dropped / total : 0.0,
+             (unsigned long)(after.cmd_dropped - before.cmd_dropped),
+             (unsigned)(base_psram - r.min_free_psram), (unsigned)(base_internal - r.min_free_internal));
+
+    heap_caps_free(trace);
+    atomic_store(&g_replaying, false);
+    vTaskDelete(NULL);
+}
+
+bool lottie_trace_replay_start(lottie_trace_t *trace, const char *path)
+{
+    bool expected = false;
+    if (!atomic_compare_exchange_strong(&g_replaying, &expected, true)) {
+        ESP_LOGW(TAG, "回放正在进行");
+        heap_caps_free(trace);
+        return false;
+    }
+
+    trace_replay_arg_t *job = heap_caps_calloc(1, sizeof(trace_replay_arg_t), MALLOC_CAP_DEFAULT);
+    if (!job) {
+        heap_caps_free(trace);
+        atomic_store(&g_replaying, false);
+        return false;
+    }
+    job->trace = trace;
+    if (path) {
+        snprintf(job->path, sizeof(job->path), "%s", path);
+    }
+
+    // 回放任务按现场调用方的方式提交命令，优先级低于加载任务
+    if (xTaskCreate(trace_replay_task, "lottie_replay", TRACE_REPLAY_STACK_SIZE, job,
+                    TRACE_REPLAY_PRIORITY, NULL) != pdPASS) {
+        ESP_LOGE(TAG, "创建回放任务失败");
+        heap_caps_free(job);
+        heap_caps_free(trace);
+        atomic_store(&g_replaying, false);
+        return false;
+    }
+    return true;
+}
+
+bool lottie_trace_replaying(void)
+{
+    return atomic_load(&g_replaying);
+}
+
+void lottie_trace_note_switch(uint32_t latency_us)
+{
+    if (!atomic_load_explicit(&g_measuring, memory_order_relaxed)) {
+        return;
+    }
+    g_replay.switches++;
+    g_replay.switch_sum_us += latency_us;
+    if (latency_us > g_replay.switch_max_us) {
+        g_replay.switch_max_us = latency_us;
+    }
+}
+
+void lottie_trace_note_frame(uint32_t dropped)
+{
+    if (!atomic_load_explicit(&g_measuring, memory_order_relaxed)) {
+        return;
+    }
+    g_replay.frames++;
+    g_replay.dropped += dropped;
+}
+
+void lottie_trace_note_memory(void)
+{
+    if (!atomic_load_explicit(&g_measuring, memory_order_relaxed)) {
+        return;
+    }
+    size_t psram = heap_caps_get_free_size(MALLOC_CAP_SPIRAM);
+    size_t internal = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+    if (psram < g_replay.min_free_psram) {
+        g_replay.min_free_psram = psram;
+    }
+    if (internal < g_replay.min_free_internal) {
+        g_replay.min_free_internal = internal;
+    }
+}
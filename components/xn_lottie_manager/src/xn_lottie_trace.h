@@ -0,0 +1,117 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Description: 管理器命令流录制与回放（复现现场的命令序列，测量切换延迟、丢帧和峰值内存）
+ */
+
+#pragma once
+
+#include "xn_lottie_cmd.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+// 录制环形缓冲区容量（条），满后覆盖最早的记录
+#define LOTTIE_TRACE_RECORDS        512
+
+// 字符串表容量（路径、插槽名），满后新字符串不再记录，回放时跳过该命令
+#define LOTTIE_TRACE_STRINGS        16
+#define LOTTIE_TRACE_NO_STR         0xFF
+
+// 文件格式（与 tools/lottie_assets.py trace 子命令一致）
+#define LOTTIE_TRACE_MAGIC          0x4352544C  // "LTRC"
+#define LOTTIE_TRACE_VERSION        1
+
+// 回放结束后等待多久再统计（让最后一次切换完成加载和发布）
+#define LOTTIE_TRACE_SETTLE_MS      2000
+
+// 一条命令记录（小端，20字节）
+typedef struct {
+    uint32_t time_ms;       // 提交时间（相对录制开始）
+    uint8_t type;           // lottie_cmd_type_t
+    uint8_t arg;            // play.center / drive.enable / override.kind / 批次命令条数
+    uint8_t str;            // 字符串表序号（路径、插槽名），LOTTIE_TRACE_NO_STR 表示无
+    uint8_t reserved;
+    int16_t a;              // play/stop.anim_type, pos.x, drive.start_frame
+    int16_t b;              // play.x, pos.y, drive.end_frame
+    int16_t c;              // play.y
+    int16_t d;
+    uint32_t value;         // 宽<<16|高, move.duration_ms, override.value
+} lottie_trace_rec_t;
+
+_Static_assert(sizeof(lottie_trace_rec_t) == 20, "记录格式与主机工具不一致");
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t count;         // 记录条数
+    uint8_t str_count;      // 字符串条数
+    uint8_t reserved[3];
+} lottie_trace_header_t;
+
+// 命令流：文件依次为头、str_count 个字符串（各 LOTTIE_CMD_PATH_MAX 字节）、count 条记录
+typedef struct {
+    lottie_trace_header_t header;
+    char strings[LOTTIE_TRACE_STRINGS][LOTTIE_CMD_PATH_MAX];
+    lottie_trace_rec_t recs[LOTTIE_TRACE_RECORDS];
+} lottie_trace_t;
+
+/**
+ * @brief 清空并开始录制（仅在LVGL上下文调用）
+ */
+void lottie_trace_start(void);
+
+/**
+ * @brief 停止录制，已录制的内容保留（仅在LVGL上下文调用）
+ */
+void lottie_trace_stop(void);
+
+/**
+ * @brief 录制一条执行的命令，内部命令不录制，批次按批次头+各条命令展开（仅在LVGL上下文调用）
+ * @param cmd 命令
+ */
+void lottie_trace_record(const lottie_cmd_t *cmd);
+
+/**
+ * @brief 把已录制的内容按时间顺序复制一份（仅在LVGL上下文调用）
+ * @return 命令流（PSRAM，使用后 heap_caps_free），没有记录或分配失败时返回NULL
+ */
+lottie_trace_t *lottie_trace_snapshot(void);
+
+/**
+ * @brief 以文本行输出命令流到日志（耗时，只在后台任务中调用），
+ *        用 tools/lottie_assets.py trace 从日志还原
+ * @param trace 命令流
+ */
+void lottie_trace_dump(const lottie_trace_t *trace);
+
+/**
+ * @brief 启动回放任务：按记录的时间间隔重新调用管理器接口，结束后输出回放报告
+ *
+ * 回放前先停止动画、清除覆盖、关闭外部驱动并隐藏图片，保证每次回放的初始状态相同。
+ *
+ * @param trace 命令流（回放任务接管并释放），为NULL时从 path 读取
+ * @param path 命令流文件路径
+ * @return true 回放任务已启动
+ */
+bool lottie_trace_replay_start(lottie_trace_t *trace, const char *path);
+
+/**
+ * @brief 是否正在回放（任意任务）
+ */
+bool lottie_trace_replaying(void);
+
+/**
+ * @brief 回放统计：一次动画切换完成（仅在LVGL上下文调用）
+ * @param latency_us 播放请求提交到新动画发布的延迟
+ */
+void lottie_trace_note_switch(uint32_t latency_us);
+
+/**
+ * @brief 回放统计：渲染了一帧（仅在LVGL上下文调用）
+ * @param dropped 与上一次渲染之间跳过的帧数
+ */
+void lottie_trace_note_frame(uint32_t dropped);
+
+/**
+ * @brief 回放统计：采样空闲内存（仅在LVGL上下文调用，未回放时直接返回）
+ */
+void lottie_trace_note_memory(void);
@@ -0,0 +1,143 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Description: 场景内存分区主机基准（由 lottie_assets.py arena 编译并运行）
+ *
+ * 回放一个动画加载时的分配序列（由 lottie_assets.py 按JSON结构生成），反复加载/卸载，
+ * 对比两种方式：
+ *   heap  - 场景分配直接进入通用堆（设备上 CONFIG_LV_USE_CLIB_MALLOC 的现状）
+ *   arena - 场景分配进入 src/xn_lottie_arena.c 的分区，卸载时丢弃分区整体释放
+ * 通用堆模型见 lottie_heap_model.h，加载期间穿插系统其他模块的分配，
+ * 统计若干周期后的碎片程度。
+ *
+ * 编译: cc -O2 -I../src lottie_arena_bench.c ../src/xn_lottie_arena.c
+ * 用法: lottie_arena_bench <trace> [cycles] [heap_kb] [seed]
+ * 输出: 每种方式一行 "<mode> load_us unload_us free_kb largest_kb free_blocks frag_pct arena_pages"
+ */
+
+#include "xn_lottie_arena.h"
+#include "lottie_heap_model.h"
+#include <time.h>
+
+static alloc_trace_t g_trace;
+
+// ---------------- 基准 ----------------
+
+static double now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static void run(const char *mode, int use_arena, uint32_t cycles, size_t heap_size, uint32_t seed)
+{
+    void **ptrs = calloc(g_trace.id_count, sizeof(void *));
+    uint8_t *in_arena = calloc(g_trace.id_count, 1);
+    double load_us = 0, unload_us = 0;
+    uint32_t max_pages = 0;
+    uint32_t oom = 0;
+
+    heap_init(heap_size);
+    memset(g_noise, 0, sizeof(g_noise));
+    g_rng = seed;
+
+    for (uint32_t cycle = 0; cycle < cycles; cycle++) {
+        noise_expire(cycle);
+
+        double t0 = now_us();
+        lottie_arena_t *arena = use_arena ? lottie_arena_create() : NULL;
+        uint32_t allocs = 0;
+        for (uint32_t i = 0; i < g_trace.op_count; i++) {
+            const trace_op_t *op = &g_trace.ops[i];
+            if (op->free) {
+                if (in_arena[op->id]) {
+                    lottie_arena_free(ptrs[op->id]);
+                } else if (ptrs[op->id]) {
+                    heap_free(ptrs[op->id]);
+                }
+                ptrs[op->id] = NULL;
+                continue;
+            }
+
+            void *p = arena ? lottie_arena_alloc(arena, op->size) : NULL;
+            in_arena[op->id] = p != NULL;
+            if (!p) {
+                p = heap_alloc(op->size);
+                oom += p == NULL;
+            }
+            ptrs[op->id] = p;
+            if (++allocs % NOISE_EVERY == 0) {
+                noise_alloc(cycle);
+            }
+        }
+        double t1 = now_us();
+
+        if (arena) {
+            lottie_arena_stats_t stats;
+            lottie_arena_get_stats(arena, &stats);
+            max_pages = stats.pages > max_pages ? stats.pages : max_pages;
+            lottie_arena_drop(arena);
+        }
+        // 按分配顺序释放（与场景树析构顺序相近）；分区已丢弃，释放只做地址判断
+        for (uint32_t id = 0; id < g_trace.id_count; id++) {
+            if (!ptrs[id]) {
+                continue;
+            }
+            if (in_arena[id]) {
+                lottie_arena_free(ptrs[id]);
+            } else {
+                heap_free(ptrs[id]);
+            }
+            ptrs[id] = NULL;
+        }
+        lottie_arena_destroy(arena);
+        double t2 = now_us();
+
+        load_us += t1 - t0;
+        unload_us += t2 - t1;
+    }
+
+    size_t free_bytes, largest;
+    uint32_t blocks;
+    heap_stats(&free_bytes, &largest, &blocks);
+    printf("%s %.2f %.2f %zu %zu %u %.2f %u%s\n", mode, load_us / cycles, unload_us / cycles,
+           free_bytes / 1024, largest / 1024, blocks,
+           free_bytes ? 100.0 * (1.0 - (double)largest / free_bytes) : 0.0, max_pages,
+           oom ? " oom" : "");
+
+    for (int i = 0; i < NOISE_SLOTS; i++) {
+        g_noise[i].ptr = NULL;
+    }
+    free(g_heap);
+    free(ptrs);
+    free(in_arena);
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2) {
+        fprintf(stderr, "用法: %s <trace> [cycles] [heap_kb] [seed]\n", argv[0]);
+        return 2;
+    }
+    uint32_t cycles = argc > 2 ? (uint32_t)strtoul(argv[2], NULL, 0) : 10000;
+    size_t heap_size = (argc > 3 ? strtoul(argv[3], NULL, 0) : 4096) * 1024;
+    uint32_t seed = argc > 4 ? (uint32_t)strtoul(argv[4], NULL, 0) : 0x12345678;
+    if (!seed) {
+        seed = 1;
+    }
+
+    if (alloc_trace_load(argv[1], &g_trace) != 0) {
+        return 1;
+    }
+
+    size_t pool_size = (size_t)LOTTIE_ARENA_PAGES * LOTTIE_ARENA_PAGE_SIZE;
+    if (!lottie_arena_pool_init(malloc(pool_size), pool_size)) {
+        fprintf(stderr, "页池初始化失败\n");
+        return 1;
+    }
+
+    run("heap", 0, cycles, heap_size, seed);
+    run("arena", 1, cycles, heap_size, seed);
+    free(g_trace.ops);
+    return 0;
+}
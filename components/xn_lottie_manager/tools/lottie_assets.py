@@ -0,0 +1,1780 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+#
+# @Author: xingnian jixingnian@gmail.com
+# @Description: Lottie 资源构建工具（构建期运行，生成 SPIFFS 分区内容）
+#
+# 用法:
+#   lottie_assets.py build --src lottie_spiffs --out build/lottie_spiffs
+#   lottie_assets.py bench --src lottie_spiffs
+#   lottie_assets.py lod --src lottie_spiffs
+#   lottie_assets.py slots --src lottie_spiffs
+#   lottie_assets.py split --src lottie_spiffs
+#   lottie_assets.py hold --src lottie_spiffs
+#   lottie_assets.py analyze --src lottie_spiffs --config src/xn_lottie_manager.c [--budgets lottie_budgets.json]
+#   lottie_assets.py calibrate --src lottie_spiffs --log monitor.log
+#   lottie_assets.py arena --src lottie_spiffs [--cycles 10000]
+#   lottie_assets.py soak --src lottie_spiffs --config src/xn_lottie_manager.c [--cycles 20000]
+#   lottie_assets.py trace --log monitor.log [--out lottie_spiffs/name.trace]
+#   lottie_assets.py modes --src lottie_spiffs --config src/xn_lottie_manager.c
+#   lottie_assets.py flush --config src/xn_lottie_manager.c [--chunk-kb 32]
+#   lottie_assets.py kernels
+#
+# build 子命令:
+#   - Lottie JSON 压缩为 name.json.z（raw deflate），运行时由 ROM miniz 分块解压；
+#     压缩无收益时原样复制
+#   - 为每个命名图层的填充色/描边色/不透明度注入插槽 ID（sid），
+#     运行时可按插槽覆盖颜色和可见性，无需重新解析
+#   - 合成底部连续的静态图层拆分为背景 name.bg.json，运行时只在加载时光栅化一次，
+#     name.json 只保留动画图层
+#   - 生成简化 LOD 变体 name.lodN.json（静态/动画路径按容差删点，低档去除虚线），
+#     运行时按目标尺寸或质量预设选择；简化无效果时不生成
+#   - 按关键帧时间线生成静止区间 name.hold，运行时区间内的帧跳过光栅化和刷新
+#   - PNG 图片转换为 LVGL 原生 .bin 格式（RGB565 / RGB565A8），
+#     运行时只需 fread 即可显示，无需 LodePNG 解码
+#
+# bench 子命令:
+#   - 在主机上对比原始/压缩资源的加载时间（读取 + 分块解压），
+#     Flash 读取时间按 --flash-kbps 估算
+#
+# slots 子命令:
+#   - 列出每个资源注入的插槽 ID（<图层名>_fill / _stroke / _opacity）
+#
+# split 子命令:
+#   - 输出每个资源可拆分的静态背景图层，以及按图层覆盖面积估算的每帧光栅化节省
+#
+# hold 子命令:
+#   - 列出每个资源画面不变的帧区间和可跳过的帧数
+#
+# lod 子命令:
+#   - 输出每个 LOD 变体的顶点削减和视觉误差（目标尺寸下的最大偏移像素）
+#
+# analyze 子命令（构建时运行）:
+#   - 按 anim_configs 中的尺寸、质量预设和渲染比例，统计设备实际加载的数据（LOD 变体、
+#     拆分背景后的动画部分）的路径段、填充/渐变/描边、蒙版和遮罩面积，
+#     用代价模型估算每帧光栅化耗时，超出预算时警告（--strict 时构建失败）
+#
+# calibrate 子命令:
+#   - 从设备日志（lottie_manager_profile_anim 的输出）读取实测光栅化耗时，
+#     拟合代价模型系数并写入 lottie_cost_model.json
+#
+# arena 子命令:
+#   - 按 JSON 结构生成 ThorVG 加载时的分配序列，编译 lottie_arena_bench.c 在主机上反复
+#     加载/卸载，对比场景分配进入通用堆和进入场景分区时的加载/卸载耗时和通用堆碎片
+#
+# soak 子命令:
+#   - 编译 lottie_soak_bench.c，在 PSRAM 堆模型上按管理器的分配方式反复播放 anim_configs
+#     中的全部动画、显示/隐藏图片并停止，输出每周期的最大空闲块、空闲总量和存活分配数
+#     曲线；存在单调增长（泄漏）或最大空闲块单调下降（碎片）、渲染缓冲区分配失败时返回错误
+#
+# trace 子命令:
+#   - 从设备日志（lottie_manager_trace_dump 的输出）还原命令流，列出命令和突发统计，
+#     --out 写出 .trace 文件；放入 lottie_spiffs 后由 lottie_manager_trace_replay 回放
+#   - 同时列出日志中的回放报告，便于对比不同版本的切换延迟、丢帧和峰值内存
+#
+# modes 子命令:
+#   - 按 anim_configs 中的动画尺寸估算各显示渲染模式（xn_lvgl.h 的 LVGL_RENDER_MODE：
+#     partial / direct / full）每帧的合成、字节交换、刷屏次数和 QSPI 传输耗时，
+#     加上光栅化估算得到帧率，并列出各模式的显示缓冲区内存
+#
+# flush 子命令:
+#   - 按 anim_configs 中的动画尺寸列出各渲染模式的刷屏区域，对比整块发送（先整块字节交换
+#     再传输）和分块发送（xn_lvgl.h 的 LVGL_FLUSH_CHUNK_BYTES，刷屏任务中交换与上一块的传输重叠）
+#     每个区域的刷屏耗时和 LVGL 任务耗时，并扫描分块大小
+#
+# kernels 子命令:
+#   - 编译 lvgl_kernels_test.c 和 xn_lvgl_driver 的 xn_lvgl_kernels.c，在主机上把像素核的标量
+#     参考实现（字节交换、填充、复制、ARGB8888 混合）与抄录的 LVGL 9.2 C 路径逐位比对，
+#     不一致时返回错误；设备上 PIE 实现的周期数见 xn_lvgl.h 的 LVGL_KERNELS_BENCH
+
+import argparse
+import copy
+import json
+import math
+import os
+import re
+import shutil
+import struct
+import subprocess
+import sys
+import tempfile
+import time
+import zlib
+
+TOOL_DIR = os.path.dirname(os.path.abspath(__file__))
+SDKCONFIG_DEFAULTS = os.path.join(TOOL_DIR, '..', '..', '..', 'sdkconfig.defaults')
+
+
+def sdkconfig_int(name, default):
+    # 读取工程 sdkconfig.defaults 中的整数配置，与固件保持一致；找不到时使用默认值
+    try:
+        with open(SDKCONFIG_DEFAULTS) as f:
+            for line in f:
+                key, sep, value = line.strip().partition('=')
+                if sep and key == name:
+                    return int(value)
+    except (OSError, ValueError):
+        pass
+    return default
+
+
+# LVGL 刷新周期 (LV_DEF_REFR_PERIOD)
+REFR_PERIOD_MS = sdkconfig_int('CONFIG_LV_DEF_REFR_PERIOD', 33)
+
+# ---------------- LVGL 9 原生图片格式 ----------------
+
+LV_IMAGE_HEADER_MAGIC = 0x19
+LV_COLOR_FORMAT_RGB565 = 0x12
+LV_COLOR_FORMAT_RGB565A8 = 0x14
+
+
+def lv_image_header(cf, w, h, stride):
+    # lv_image_header_t: magic(8) cf(8) flags(16) w(16) h(16) stride(16) reserved(16)
+    return struct.pack('<BBHHHHH', LV_IMAGE_HEADER_MAGIC, cf, 0, w, h, stride, 0)
+
+
+# ---------------- 纯 Python PNG 解码（无需 Pillow） ----------------
+
+def _paeth(a, b, c):
+    p = a + b - c
+    pa, pb, pc = abs(p - a), abs(p - b), abs(p - c)
+    if pa <= pb and pa <= pc:
+        return a
+    return b if pb <= pc else c
+
+
+def decode_png(data):
+    """解码 8 位非隔行 PNG，返回 (w, h, rgba bytes)"""
+    if data[:8] != b'\x89PNG\r\n\x1a\n':
+        raise ValueError('不是 PNG 文件')
+    pos = 8
+    idat = b''
+    palette = None
+    trns = None
+    w = h = depth = ctype = interlace = 0
+    while pos < len(data):
+        length, tag = struct.unpack('>I4s', data[pos:pos + 8])
+        chunk = data[pos + 8:pos + 8 + length]
+        pos += 12 + length
+        if tag == b'IHDR':
+            w, h, depth, ctype, _, _, interlace = struct.unpack('>IIBBBBB', chunk)
+        elif tag == b'PLTE':
+            palette = chunk
+        elif tag == b'tRNS':
+            trns = chunk
+        elif tag == b'IDAT':
+            idat += chunk
+        elif tag == b'IEND':
+            break
+    if depth != 8 or interlace:
+        raise ValueError('仅支持 8 位非隔行 PNG')
+    channels = {0: 1, 2: 3, 3: 1, 4: 2, 6: 4}[ctype]
+    raw = zlib.decompress(idat)
+    stride = w * channels
+    prev = bytearray(stride)
+    out = bytearray(w * h * 4)
+    o = 0
+    for y in range(h):
+        ftype = raw[y * (stride + 1)]
+        line = bytearray(raw[y * (stride + 1) + 1:(y + 1) * (stride + 1)])
+        for i in range(stride):
+            a = line[i - channels] if i >= channels else 0
+            c = prev[i - channels] if i >= channels else 0
+            b = prev[i]
+            if ftype == 1:
+                line[i] = (line[i] + a) & 0xFF
+            elif ftype == 2:
+                line[i] = (line[i] + b) & 0xFF
+            elif ftype == 3:
+                line[i] = (line[i] + ((a + b) >> 1)) & 0xFF
+            elif ftype == 4:
+                line[i] = (line[i] + _paeth(a, b, c)) & 0xFF
+        for x in range(w):
+            px = line[x * channels:(x + 1) * channels]
+            if ctype == 0:
+                r = g = bl = px[0]
+                al = 255
+            elif ctype == 2:
+                r, g, bl = px
+                al = 255
+            elif ctype == 3:
+                idx = px[0]
+                r, g, bl = palette[idx * 3:idx * 3 + 3]
+                al = trns[idx] if trns and idx < len(trns) else 255
+            elif ctype == 4:
+                r = g = bl = px[0]
+                al = px[1]
+            else:
+                r, g, bl, al = px
+            out[o:o + 4] = bytes((r, g, bl, al))
+            o += 4
+        prev = line
+    return w, h, bytes(out)
+
+
+def rgba_to_lv_bin(w, h, rgba):
+    """RGBA8888 转换为 LVGL 原生 .bin，全不透明时用 RGB565，否则 RGB565A8"""
+    color = bytearray(w * h * 2)
+    alpha = bytearray(w * h)
+    opaque = True
+    for i in range(w * h):
+        r, g, b, a = rgba[i * 4:i * 4 + 4]
+        c = ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3)
+        color[i * 2] = c & 0xFF
+        color[i * 2 + 1] = c >> 8
+        alpha[i] = a
+        if a != 255:
+            opaque = False
+    if opaque:
+        return lv_image_header(LV_COLOR_FORMAT_RGB565, w, h, w * 2) + bytes(color)
+    return lv_image_header(LV_COLOR_FORMAT_RGB565A8, w, h, w * 2) + bytes(color) + bytes(alpha)
+
+
+# ---------------- 压缩资源格式 ----------------
+# 与 xn_lottie_asset.c 保持一致：
+#   magic "LTZ1"(4) + 原始长度 u32 LE + raw deflate 数据流
+
+LOTTIE_Z_MAGIC = b'LTZ1'
+LOTTIE_Z_SUFFIX = '.z'
+LOTTIE_CHUNK_SIZE = 4096     # 与 LOTTIE_ASSET_CHUNK_SIZE 一致
+
+
+def compress_json(data):
+    c = zlib.compressobj(9, zlib.DEFLATED, -15, 9)
+    body = c.compress(data) + c.flush()
+    return LOTTIE_Z_MAGIC + struct.pack('<I', len(data)) + body
+
+
+def inflate_chunked(blob, chunk=LOTTIE_CHUNK_SIZE):
+    if blob[:4] != LOTTIE_Z_MAGIC:
+        raise ValueError('bad magic')
+    raw_size = struct.unpack('<I', blob[4:8])[0]
+    d = zlib.decompressobj(-15)
+    out = bytearray()
+    for off in range(8, len(blob), chunk):
+        out += d.decompress(blob[off:off + chunk])
+    out += d.flush()
+    if len(out) != raw_size:
+        raise ValueError('size mismatch')
+    return bytes(out)
+
+
+# ---------------- LOD 简化 ----------------
+# 与 xn_lottie_manager.c 中的 LOTTIE_LOD_* 保持一致：
+#   level: (参考目标尺寸 px, 容差 px, 是否去除虚线)
+
+LOD_LEVELS = {
+    1: (256, 0.5, False),
+    2: (128, 0.75, True),
+}
+LOD_SAMPLES = 8
+
+
+def _bezier(p0, c1, c2, p3, t):
+    u = 1.0 - t
+    return (u * u * u * p0[0] + 3 * u * u * t * c1[0] + 3 * u * t * t * c2[0] + t * t * t * p3[0],
+            u * u * u * p0[1] + 3 * u * u * t * c1[1] + 3 * u * t * t * c2[1] + t * t * t * p3[1])
+
+
+def _segment(shape, a, b):
+    # Lottie 切线为相对顶点的偏移
+    v, i, o = shape['v'], shape['i'], shape['o']
+    p0, p3 = v[a], v[b]
+    return (p0, (p0[0] + o[a][0], p0[1] + o[a][1]), (p3[0] + i[b][0], p3[1] + i[b][1]), p3)
+
+
+def _sample(seg, n):
+    return [_bezier(seg[0], seg[1], seg[2], seg[3], k / float(n)) for k in range(n + 1)]
+
+
+def _remove_error(shape, k):
+    # 删除顶点 k 后，原两段曲线到合并曲线的最大距离
+    n = len(shape['v'])
+    a, b = (k - 1) % n, (k + 1) % n
+    orig = _sample(_segment(shape, a, k), LOD_SAMPLES) + _sample(_segment(shape, k, b), LOD_SAMPLES)
+    merged = _sample(_segment(shape, a, b), LOD_SAMPLES * 4)
+    err = 0.0
+    for p in orig:
+        d = min(math.hypot(p[0] - q[0], p[1] - q[1]) for q in merged)
+        err = max(err, d)
+    return err
+
+
+def _shape_list(ks):
+    # 静态路径: 一个形状；动画路径: 每个关键帧的 s/e 形状（删点需在所有关键帧上一致）
+    if ks.get('a', 0) == 0:
+        k = ks.get('k')
+        return [k] if isinstance(k, dict) and 'v' in k else []
+    shapes = []
+    for kf in ks.get('k', []):
+        for key in ('s', 'e'):
+            for shape in kf.get(key, []) if isinstance(kf, dict) else []:
+                if isinstance(shape, dict) and 'v' in shape:
+                    shapes.append(shape)
+    return shapes
+
+
+def _simplify_path(ks, tol, stats):
+    shapes = _shape_list(ks)
+    if not shapes or len(set(len(s['v']) for s in shapes)) != 1:
+        return
+    stats['verts'] += len(shapes[0]['v'])
+    closed = shapes[0].get('c', False)
+    changed = True
+    while changed:
+        changed = False
+        n = len(shapes[0]['v'])
+        if n <= (3 if closed else 2):
+            break
+        best_k, best_err = None, tol
+        for k in (range(n) if closed else range(1, n - 1)):
+            err = max(_remove_error(s, k) for s in shapes)
+            if err <= best_err:
+                best_k, best_err = k, err
+        if best_k is not None:
+            for s in shapes:
+                for key in ('v', 'i', 'o'):
+                    del s[key][best_k]
+            stats['removed'] += 1
+            stats['max_err'] = max(stats['max_err'], best_err)
+            changed = True
+
+
+def _simplify_node(node, tol, drop_dash, stats):
+    if isinstance(node, dict):
+        ty = node.get('ty')
+        if ty == 'sh' and isinstance(node.get('ks'), dict):
+            _simplify_path(node['ks'], tol, stats)
+        elif ty == 'st' and drop_dash and 'd' in node:
+            del node['d']
+            stats['dashes'] += 1
+        for v in node.values():
+            _simplify_node(v, tol, drop_dash, stats)
+    elif isinstance(node, list):
+        for v in node:
+            _simplify_node(v, tol, drop_dash, stats)
+
+
+def simplify_lottie(doc, level):
+    # 返回 (简化后的文档, 统计)；容差换算到合成坐标系
+    target, tol_px, drop_dash = LOD_LEVELS[level]
+    scale = target / float(max(doc.get('w', target), doc.get('h', target)))
+    stats = {'verts': 0, 'removed': 0, 'dashes': 0, 'max_err': 0.0}
+    out = copy.deepcopy(doc)
+    _simplify_node(out.get('layers', []), tol_px / scale, drop_dash, stats)
+    _simplify_node(out.get('assets', []), tol_px / scale, drop_dash, stats)
+    stats['max_err_px'] = stats['max_err'] * scale
+    return out, stats
+
+
+def lod_name(name, level):
+    base, ext = os.path.splitext(name)
+    return '%s.lod%d%s' % (base, level, ext)
+
+
+# ---------------- 插槽注入 ----------------
+# 插槽 ID 由图层名生成（小写，非字母数字替换为 _），与 xn_lottie_manager 的
+# lottie_manager_set_color / lottie_manager_set_visible 配合使用
+
+SLOT_NAME_MAX = 31          # 与 LOTTIE_SLOT_NAME_MAX 一致（不含结尾 \0）
+
+
+def slot_id(layer_name, kind):
+    base = re.sub(r'[^0-9a-z]+', '_', layer_name.lower()).strip('_') or 'layer'
+    return (base[:SLOT_NAME_MAX - len(kind) - 1] + '_' + kind)
+
+
+def _inject_shapes(items, layer_name, slots):
+    for item in items:
+        if not isinstance(item, dict):
+            continue
+        ty = item.get('ty')
+        if ty in ('fl', 'st') and isinstance(item.get('c'), dict) and 'sid' not in item['c']:
+            sid = slot_id(layer_name, 'fill' if ty == 'fl' else 'stroke')
+            item['c']['sid'] = sid
+            slots.add(sid)
+        if ty == 'gr':
+            _inject_shapes(item.get('it', []), layer_name, slots)
+
+
+def _inject_layers(layers, slots):
+    for layer in layers:
+        name = layer.get('nm')
+        if not isinstance(name, str):
+            continue
+        ks = layer.get('ks', {})
+        if isinstance(ks.get('o'), dict) and 'sid' not in ks['o']:
+            sid = slot_id(name, 'opacity')
+            ks['o']['sid'] = sid
+            slots.add(sid)
+        _inject_shapes(layer.get('shapes', []), name, slots)
+
+
+def inject_slots(doc):
+    # 原地注入，返回插槽 ID 集合
+    slots = set()
+    _inject_layers(doc.get('layers', []), slots)
+    for asset in doc.get('assets', []):
+        _inject_layers(asset.get('layers', []), slots)
+    return slots
+
+
+# ---------------- 静态图层拆分 ----------------
+# 静态图层：纯色/形状层，无关键帧和表达式，全程可见，普通混合，不参与蒙版，
+# 父级也是静态背景图层。只拆分合成底部连续的静态图层，保证背景在下、动画在上的
+# 叠加顺序与原合成一致
+
+BG_LAYER_TYPES = (1, 4)     # 纯色层、形状层
+
+
+def bg_name(name):
+    base, ext = os.path.splitext(name)
+    return '%s.bg%s' % (base, ext)
+
+
+def _is_animated(node):
+    if isinstance(node, dict):
+        if node.get('a') == 1 or isinstance(node.get('x'), str):
+            return True
+        return any(_is_animated(v) for v in node.values())
+    if isinstance(node, list):
+        return any(_is_animated(v) for v in node)
+    return False
+
+
+def _layer_static(layer, doc):
+    return (layer.get('ty') in BG_LAYER_TYPES and
+            layer.get('ip', 0) <= doc.get('ip', 0) and
+            layer.get('op', 0) >= doc.get('op', 0) and
+            layer.get('bm', 0) == 0 and
+            'tt' not in layer and 'td' not in layer and 'tm' not in layer and
+            not _is_animated(layer))
+
+
+def split_static(doc):
+    # 返回背景图层数，0 表示不拆分。Lottie 图层数组自上而下排列，底部为数组末尾
+    layers = doc.get('layers', [])
+    k = len(layers)
+    while k > 0 and _layer_static(layers[k - 1], doc):
+        k -= 1
+    # 背景图层的父级必须也在背景中；被动画图层用作父级的图层（及其上方图层）留在动画中
+    while k < len(layers):
+        bg_inds = set(l.get('ind') for l in layers[k:])
+        fg_parents = set(l.get('parent') for l in layers[:k])
+        bad = [j for j in range(k, len(layers))
+               if layers[j].get('ind') in fg_parents or
+               layers[j].get('parent', None) not in bg_inds | {None}]
+        if not bad:
+            break
+        k = max(bad) + 1
+    # 全部静态时整个动画不变，拆分无意义
+    return 0 if k == 0 else len(layers) - k
+
+
+# ---------------- 静止区间 ----------------
+# 按关键帧时间线找出画面不变的帧区间（相邻关键帧值相同、关键帧之间和图层出入点之外），
+# 写入 name.hold，设备上同一区间内的帧直接复用上次渲染结果，不光栅化也不刷新。
+# 含表达式或时间重映射时无法静态分析，不生成。
+# 文件格式（与 xn_lottie_player.c 一致）：magic "LHLD" u32 + version u16 + count u16，
+# 之后 count 组 (start u16, end u16)，帧号从 0 开始（对应合成的 ip）
+
+HOLD_MAGIC = 0x444C484C
+HOLD_VERSION = 1
+HOLD_SUFFIX = '.hold'
+
+
+def hold_name(name):
+    return os.path.splitext(name)[0] + HOLD_SUFFIX
+
+
+def _hold_props(node, t0, stretch, changes):
+    # 收集属性关键帧中值发生变化的时间段 (a, b]（定格关键帧为跳变点 a == b）
+    if isinstance(node, list):
+        for v in node:
+            if not _hold_props(v, t0, stretch, changes):
+                return False
+        return True
+    if not isinstance(node, dict):
+        return True
+    if isinstance(node.get('x'), str):
+        return False
+    if node.get('a') == 1 and isinstance(node.get('k'), list):
+        kfs = [k for k in node['k'] if isinstance(k, dict) and 't' in k]
+        for k0, k1 in zip(kfs, kfs[1:]):
+            end = k0.get('e', k1.get('s'))
+            if k0.get('s') == end:
+                continue
+            a, b = t0 + k0['t'] * stretch, t0 + k1['t'] * stretch
+            changes.append((b, b) if k0.get('h') == 1 else (a, b))
+        return True
+    return all(_hold_props(v, t0, stretch, changes) for v in node.values())
+
+
+def _hold_layers(layers, assets, t0, stretch, changes, depth=0):
+    for layer in layers:
+        if 'tm' in layer or depth > 8:
+            return False
+        # 出入点处图层出现/消失
+        for key in ('ip', 'op'):
+            if key in layer:
+                t = t0 + layer[key] * stretch
+                changes.append((t, t))
+        props = dict((k, v) for k, v in layer.items() if k not in ('layers', 'refId'))
+        if not _hold_props(props, t0, stretch, changes):
+            return False
+        if layer.get('ty') == 0 and layer.get('refId') in assets:
+            sr = layer.get('sr', 1) or 1
+            if not _hold_layers(assets[layer['refId']], assets, t0 + layer.get('st', 0) * stretch,
+                                stretch * sr, changes, depth + 1):
+                return False
+    return True
+
+
+def hold_ranges(doc):
+    """返回 [(start, end)]：start..end 各帧画面与 start 帧相同；无法分析时返回 None"""
+    ip, op = doc.get('ip', 0), doc.get('op', 0)
+    total = int(op - ip)
+    if total < 2:
+        return []
+    assets = dict((a['id'], a['layers']) for a in doc.get('assets', []) if 'layers' in a and 'id' in a)
+    changes = []
+    if not _hold_layers(doc.get('layers', []), assets, 0.0, 1.0, changes):
+        return None
+    # dirty[v]：帧 v 与帧 v-1 之间（时间 (ip+v-1, ip+v]）有属性变化
+    dirty = [False] * total
+    for a, b in changes:
+        for v in range(max(1, int(math.floor(a - ip))), min(total, int(math.ceil(b - ip)) + 1)):
+            t = ip + v
+            if (a == b and t - 1 < a <= t) or (a < b and a < t and b > t - 1):
+                dirty[v] = True
+    ranges = []
+    v = 0
+    while v < total:
+        e = v
+        while e + 1 < total and not dirty[e + 1]:
+            e += 1
+        if e > v:
+            ranges.append((v, e))
+        v = e + 1
+    return ranges
+
+
+def hold_file(ranges):
+    data = struct.pack('<IHH', HOLD_MAGIC, HOLD_VERSION, len(ranges))
+    return data + b''.join(struct.pack('<HH', a, b) for a, b in ranges)
+
+
+def split_docs(doc, count):
+    # 返回 (背景文档, 动画文档)
+    bg = dict(doc)
+    fg = dict(doc)
+    bg['layers'] = doc['layers'][-count:]
+    fg['layers'] = doc['layers'][:-count]
+    return bg, fg
+
+
+def _first_value(prop, default):
+    if not isinstance(prop, dict):
+        return default
+    k = prop.get('k', default)
+    if prop.get('a') == 1 and isinstance(k, list) and k and isinstance(k[0], dict):
+        k = k[0].get('s', default)
+    return k
+
+
+def _transform_box(box, tr):
+    # 按锚点/缩放/位置变换包围盒（忽略旋转和倾斜，只用于估算）
+    if box is None:
+        return None
+    a = _first_value(tr.get('a'), [0, 0])
+    sc = _first_value(tr.get('s'), [100, 100])
+    pos = tr.get('p', {})
+    if isinstance(pos, dict) and pos.get('s'):
+        p = [_first_value(pos.get('x'), 0), _first_value(pos.get('y'), 0)]   # 分离的 X/Y 位置
+    else:
+        p = _first_value(pos, [0, 0])
+    xs = [(x - a[0]) * sc[0] / 100.0 + p[0] for x in (box[0], box[2])]
+    ys = [(y - a[1]) * sc[1] / 100.0 + p[1] for y in (box[1], box[3])]
+    return (min(xs), min(ys), max(xs), max(ys))
+
+
+def _union(a, b):
+    if a is None:
+        return b
+    if b is None:
+        return a
+    return (min(a[0], b[0]), min(a[1], b[1]), max(a[2], b[2]), max(a[3], b[3]))
+
+
+def _shapes_box(items, stats):
+    box, tr = None, None
+    for item in items:
+        if not isinstance(item, dict):
+            continue
+        ty = item.get('ty')
+        if ty == 'gr':
+            box = _union(box, _shapes_box(item.get('it', []), stats))
+        elif ty == 'tr':
+            tr = item
+        elif ty == 'sh':
+            shapes = _shape_list(item.get('ks', {}))
+            for shape in shapes[:1]:
+                pts = [(v[0] + d[0], v[1] + d[1]) for key in ('i', 'o')
+                       for v, d in zip(shape['v'], shape[key])] + [tuple(v[:2]) for v in shape['v']]
+                if pts:
+                    stats['segments'] += len(shape['v'])
+                    box = _union(box, (min(x for x, _ in pts), min(y for _, y in pts),
+                                       max(x for x, _ in pts), max(y for _, y in pts)))
+        elif ty in ('el', 'rc', 'sr'):
+            p = _first_value(item.get('p'), [0, 0])
+            if ty == 'sr':
+                r = _first_value(item.get('or'), 0)
+                half = (r, r)
+            else:
+                sz = _first_value(item.get('s'), [0, 0])
+                half = (sz[0] / 2.0, sz[1] / 2.0)
+            stats['segments'] += 4
+            box = _union(box, (p[0] - half[0], p[1] - half[1], p[0] + half[0], p[1] + half[1]))
+    return _transform_box(box, tr) if tr else box
+
+
+def layer_cost(layer, doc):
+    # 估算图层每帧光栅化面积（首帧包围盒在合成内的像素数，不含父级变换），返回 (面积, 路径段数)
+    stats = {'segments': 0}
+    if layer.get('ty') == 1:
+        box = (0, 0, layer.get('sw', 0), layer.get('sh', 0))
+    else:
+        box = _shapes_box(layer.get('shapes', []), stats)
+    box = _transform_box(box, layer.get('ks', {}))
+    if box is None:
+        return 0.0, stats['segments']
+    w = min(box[2], doc.get('w', 0)) - max(box[0], 0)
+    h = min(box[3], doc.get('h', 0)) - max(box[1], 0)
+    return max(w, 0) * max(h, 0), stats['segments']
+
+
+# ---------------- 光栅化代价模型 ----------------
+# 每帧耗时 = Σ 系数 × 特征。特征在目标渲染尺寸下统计，面积单位为像素；
+# 默认系数为 ESP32-S3 240MHz + PSRAM 缓冲区的粗略值，可用 calibrate 子命令按实测拟合
+
+COST_FEATURES = ('frame', 'clear_px', 'segments', 'fill_px', 'grad_px', 'stroke_seg', 'mask_px', 'matte_px')
+COST_DEFAULTS = {
+    'frame': 400.0,         # 每帧固定开销（场景更新、同步）
+    'clear_px': 0.016,      # 清空 ARGB8888 缓冲区
+    'segments': 1.5,        # 路径段（曲线细分、边表构建）
+    'fill_px': 0.03,        # 纯色填充面积
+    'grad_px': 0.08,        # 渐变填充/描边面积
+    'stroke_seg': 8.0,      # 描边路径段（描边需生成轮廓）
+    'mask_px': 0.06,        # 蒙版面积
+    'matte_px': 0.10,       # 遮罩面积（离屏合成）
+}
+COST_MODEL_FILE = os.path.join(TOOL_DIR, 'lottie_cost_model.json')
+PROFILE_SAMPLES = 4         # 与 lottie_player_profile_scales 的采样帧数一致
+
+
+def load_cost_model(path=COST_MODEL_FILE):
+    model = dict(COST_DEFAULTS)
+    if os.path.isfile(path):
+        with open(path) as f:
+            model.update(json.load(f).get('coefficients', {}))
+    return model
+
+
+def _count_items(items, counts):
+    for item in items:
+        if not isinstance(item, dict) or item.get('hd'):
+            continue
+        ty = item.get('ty')
+        if ty in counts:
+            counts[ty] += 1
+        if ty == 'rp':
+            counts['copies'] *= max(1.0, float(_first_value(item.get('c'), 1)))
+        if ty == 'gr':
+            _count_items(item.get('it', []), counts)
+
+
+def _layer_features(layer, doc, assets, sx, sy, out):
+    if layer.get('hd') or layer.get('ty') == 3:
+        return
+    if layer.get('ty') == 0:
+        # 预合成：展开引用的图层（忽略预合成自身的变换）
+        for sub in assets.get(layer.get('refId'), []):
+            _layer_features(sub, doc, assets, sx, sy, out)
+        return
+    area, segments = layer_cost(layer, doc)
+    area *= sx * sy
+    counts = {'fl': 0, 'gf': 0, 'st': 0, 'gs': 0, 'copies': 1.0}
+    _count_items(layer.get('shapes', []), counts)
+    if layer.get('ty') == 1:
+        counts['fl'] = 1
+    c = counts['copies']
+    out['segments'] += segments * c
+    out['fill_px'] += area * counts['fl'] * c
+    out['grad_px'] += area * (counts['gf'] + counts['gs']) * c
+    out['stroke_seg'] += segments * (counts['st'] + counts['gs']) * c
+    out['mask_px'] += area * len(layer.get('masksProperties', []) or [])
+    if layer.get('tt'):
+        out['matte_px'] += area
+
+
+def frame_features(doc, width, height, scale_q8, t):
+    # 第 t 帧（合成时间）可见图层的特征，尺寸为实际光栅化尺寸
+    k = scale_q8 / 256.0
+    sx = width * k / float(doc.get('w', width) or width)
+    sy = height * k / float(doc.get('h', height) or height)
+    assets = dict((a.get('id'), a.get('layers', [])) for a in doc.get('assets', []) if 'layers' in a)
+    out = dict((name, 0.0) for name in COST_FEATURES)
+    out['frame'] = 1.0
+    out['clear_px'] = width * height * k * k
+    for layer in doc.get('layers', []):
+        if layer.get('ip', 0) <= t < layer.get('op', 0):
+            _layer_features(layer, doc, assets, sx, sy, out)
+    return out
+
+
+def estimate_us(model, features):
+    return sum(model[name] * features[name] for name in COST_FEATURES)
+
+
+def _profile_times(doc):
+    ip, op = doc.get('ip', 0), doc.get('op', 0)
+    return [ip + (op - ip) * i / float(PROFILE_SAMPLES) for i in range(PROFILE_SAMPLES)]
+
+
+def _peak_times(doc):
+    ip, op = doc.get('ip', 0), doc.get('op', 0)
+    times = set([ip])
+    for layer in doc.get('layers', []):
+        if ip <= layer.get('ip', 0) < op:
+            times.add(layer.get('ip', 0))
+    return sorted(times)
+
+
+def device_doc(src_dir, name, lod):
+    # 设备实际加载的数据：拆分背景后的动画部分，再按 LOD 简化
+    with open(os.path.join(src_dir, name), 'rb') as f:
+        doc = json.load(f)
+    bg_count = split_static(doc)
+    if bg_count:
+        doc = split_docs(doc, bg_count)[1]
+    if lod:
+        lod_doc, stats = simplify_lottie(doc, lod)
+        if stats['removed'] or stats['dashes']:
+            doc = lod_doc
+    return doc
+
+
+# ---------------- anim_configs 解析 ----------------
+
+_CONFIG_RE = re.compile(r'\[(LOTTIE_ANIM_\w+)\]\s*=\s*\{\s*"([^"]+)"\s*,\s*(\d+)\s*,\s*(\d+)\s*,'
+                        r'\s*(LOTTIE_QUALITY_\w+)\s*,\s*(LOTTIE_SCALE_\w+)\s*,\s*([^}]*)\}')
+QUALITY_PRESETS = {
+    'LOTTIE_QUALITY_AUTO': (-1, 1),
+    'LOTTIE_QUALITY_HIGH': (0, 1),
+    'LOTTIE_QUALITY_MEDIUM': (1, 1),
+    'LOTTIE_QUALITY_LOW': (2, 2),
+}
+SCALE_MODES = {
+    'LOTTIE_SCALE_FULL': 256,
+    'LOTTIE_SCALE_3_4': 192,
+    'LOTTIE_SCALE_1_2': 128,
+    'LOTTIE_SCALE_DYNAMIC': 256,
+}
+
+
+def parse_anim_configs(path):
+    with open(path, encoding='utf-8') as f:
+        text = f.read()
+    macros = dict(re.findall(r'#define\s+(LOTTIE_LOD[12]_MAX_SIZE)\s+(\d+)', text))
+    lod1_max = int(macros.get('LOTTIE_LOD1_MAX_SIZE', LOD_LEVELS[1][0]))
+    lod2_max = int(macros.get('LOTTIE_LOD2_MAX_SIZE', LOD_LEVELS[2][0]))
+    configs = []
+    for anim, file_path, w, h, quality, scale, flags in _CONFIG_RE.findall(text):
+        w, h = int(w), int(h)
+        lod, step = QUALITY_PRESETS[quality]
+        if lod < 0:
+            size = max(w, h)
+            lod = 2 if size <= lod2_max else (1 if size <= lod1_max else 0)
+        configs.append({'anim': anim, 'name': os.path.basename(file_path), 'width': w, 'height': h,
+                        'lod': lod, 'frame_step': step, 'scale_q8': SCALE_MODES[scale],
+                        'scale': scale})
+    return configs
+
+
+def frame_budget_us(doc, frame_step, refr_period_ms):
+    # 与 lottie_player_load 一致：帧间隔与刷新周期中较长者的 3/4，帧步长为 2 时预算加倍
+    fr = doc.get('fr', 30) or 30
+    period = max(1e6 / fr, refr_period_ms * 1000.0)
+    return period * 3 / 4 * frame_step
+
+
+# ---------------- build 子命令 ----------------
+
+def write_json(data, out_dir, name, compress):
+    if compress:
+        blob = compress_json(data)
+        if len(blob) < len(data):
+            with open(os.path.join(out_dir, name + LOTTIE_Z_SUFFIX), 'wb') as f:
+                f.write(blob)
+            return
+    with open(os.path.join(out_dir, name), 'wb') as f:
+        f.write(data)
+
+
+def build_json(src_path, out_dir, name, compress):
+    with open(src_path, 'rb') as f:
+        data = f.read()
+
+    try:
+        doc = json.loads(data)
+    except ValueError as e:
+        print('lottie_assets: %s 无法解析 (%s)，原样保留' % (name, e))
+        write_json(data, out_dir, name, compress)
+        return
+    changed = bool(inject_slots(doc))
+    bg_count = split_static(doc)
+    if bg_count:
+        bg_doc, doc = split_docs(doc, bg_count)
+        bg_data = json.dumps(bg_doc, separators=(',', ':')).encode('utf-8')
+        write_json(bg_data, out_dir, bg_name(name), compress)
+        changed = True
+    if changed:
+        data = json.dumps(doc, separators=(',', ':')).encode('utf-8')
+    write_json(data, out_dir, name, compress)
+
+    # 静止区间与 LOD 无关（简化只删点，不改关键帧时间），所有变体共用
+    ranges = hold_ranges(doc)
+    if ranges and max(b for _, b in ranges) <= 0xFFFF:
+        with open(os.path.join(out_dir, hold_name(name)), 'wb') as f:
+            f.write(hold_file(ranges))
+
+    for level in sorted(LOD_LEVELS):
+        lod_doc, stats = simplify_lottie(doc, level)
+        if stats['removed'] == 0 and stats['dashes'] == 0:
+            continue
+        lod_data = json.dumps(lod_doc, separators=(',', ':')).encode('utf-8')
+        write_json(lod_data, out_dir, lod_name(name, level), compress)
+
+
+def build_png(src_path, out_dir, name):
+    with open(src_path, 'rb') as f:
+        data = f.read()
+    try:
+        w, h, rgba = decode_png(data)
+    except (ValueError, KeyError, zlib.error) as e:
+        # 无法预转换的 PNG 原样保留，运行时由 LodePNG 在后台解码
+        print('lottie_assets: %s 无法转换 (%s)，保留原 PNG' % (name, e))
+        shutil.copyfile(src_path, os.path.join(out_dir, name))
+        return
+    bin_name = os.path.splitext(name)[0] + '.bin'
+    with open(os.path.join(out_dir, bin_name), 'wb') as f:
+        f.write(rgba_to_lv_bin(w, h, rgba))
+
+
+def cmd_build(args):
+    if os.path.isdir(args.out):
+        shutil.rmtree(args.out)
+    os.makedirs(args.out)
+    for name in sorted(os.listdir(args.src)):
+        src_path = os.path.join(args.src, name)
+        if not os.path.isfile(src_path):
+            continue
+        if name.lower().endswith('.png'):
+            build_png(src_path, args.out, name)
+        elif name.lower().endswith('.json'):
+            build_json(src_path, args.out, name, not args.no_compress)
+        else:
+            shutil.copyfile(src_path, os.path.join(args.out, name))
+    return 0
+
+
+# ---------------- bench 子命令 ----------------
+
+def _time_best(fn, iterations):
+    best = None
+    for _ in range(iterations):
+        t = time.perf_counter()
+        fn()
+        dt = time.perf_counter() - t
+        best = dt if best is None or dt < best else best
+    return best
+
+
+def cmd_bench(args):
+    flash_bps = args.flash_kbps * 1024.0
+    print('%-20s %8s %8s %6s %10s %10s %10s %10s' % (
+        'asset', 'raw', 'z', 'ratio', 'inflate', 'raw_load', 'z_load', 'speedup'))
+    tot_raw = tot_z = 0
+    for name in sorted(os.listdir(args.src)):
+        if not name.lower().endswith('.json'):
+            continue
+        with open(os.path.join(args.src, name), 'rb') as f:
+            data = f.read()
+        blob = compress_json(data)
+        assert inflate_chunked(blob) == data
+        inflate_s = _time_best(lambda: inflate_chunked(blob), args.iterations)
+        raw_s = len(data) / flash_bps
+        z_s = len(blob) / flash_bps + inflate_s
+        tot_raw += len(data)
+        tot_z += len(blob)
+        print('%-20s %8d %8d %5.1fx %8.2fms %8.2fms %8.2fms %9.2fx' % (
+            name, len(data), len(blob), len(data) / float(len(blob)),
+            inflate_s * 1e3, raw_s * 1e3, z_s * 1e3, raw_s / z_s))
+    if tot_z:
+        print('%-20s %8d %8d %5.1fx' % ('total', tot_raw, tot_z, tot_raw / float(tot_z)))
+    print('flash 读取按 %d KB/s 估算，inflate 为主机实测（%d 字节分块）' % (
+        args.flash_kbps, LOTTIE_CHUNK_SIZE))
+    return 0
+
+
+# ---------------- slots 子命令 ----------------
+
+def cmd_slots(args):
+    for name in sorted(os.listdir(args.src)):
+        if not name.lower().endswith('.json'):
+            continue
+        with open(os.path.join(args.src, name), 'rb') as f:
+            doc = json.load(f)
+        slots = sorted(inject_slots(doc))
+        print('%s (%d):' % (name, len(slots)))
+        for sid in slots:
+            print('    %s' % sid)
+    return 0
+
+
+# ---------------- split 子命令 ----------------
+
+def cmd_split(args):
+    print('%-20s %6s %9s %10s %10s %9s' % ('asset', 'layers', 'bg_layers', 'area', 'bg_area', 'saving'))
+    for name in sorted(os.listdir(args.src)):
+        if not name.lower().endswith('.json'):
+            continue
+        with open(os.path.join(args.src, name), 'rb') as f:
+            doc = json.load(f)
+        layers = doc.get('layers', [])
+        count = split_static(doc)
+        costs = [layer_cost(l, doc)[0] for l in layers]
+        total = sum(costs)
+        bg = sum(costs[len(layers) - count:]) if count else 0.0
+        print('%-20s %6d %9d %10d %10d %8.1f%%' % (
+            name, len(layers), count, total, bg, 100.0 * bg / total if total else 0.0))
+        for layer in layers[len(layers) - count:] if count else []:
+            print('    bg: %s' % layer.get('nm'))
+    print('面积为各图层首帧包围盒在合成内的像素数之和（忽略旋转），作为每帧光栅化开销的估算')
+    return 0
+
+
+# ---------------- hold 子命令 ----------------
+
+def cmd_hold(args):
+    print('%-20s %6s %6s %8s %7s' % ('asset', 'frames', 'ranges', 'skipped', 'saving'))
+    for name in sorted(os.listdir(args.src)):
+        if not name.lower().endswith('.json'):
+            continue
+        with open(os.path.join(args.src, name), 'rb') as f:
+            doc = json.load(f)
+        bg_count = split_static(doc)
+        if bg_count:
+            doc = split_docs(doc, bg_count)[1]
+        total = int(doc.get('op', 0) - doc.get('ip', 0))
+        ranges = hold_ranges(doc)
+        if ranges is None:
+            print('%-20s %6d %6s %8s %7s  (含表达式或时间重映射，不分析)' % (name, total, '-', '-', '-'))
+            continue
+        # 每个区间只渲染首帧，其余帧跳过
+        skipped = sum(b - a for a, b in ranges)
+        print('%-20s %6d %6d %8d %6.1f%%' % (name, total, len(ranges), skipped,
+                                            100.0 * skipped / total if total else 0.0))
+        if args.verbose:
+            for a, b in ranges:
+                print('    %d-%d' % (a, b))
+    print('skipped 为每次循环可跳过光栅化和刷新的帧数（帧步长为 1 时）')
+    return 0
+
+
+# ---------------- analyze 子命令 ----------------
+
+def cmd_analyze(args):
+    model = load_cost_model(args.model)
+    budgets = {}
+    if args.budgets and os.path.isfile(args.budgets):
+        with open(args.budgets) as f:
+            budgets = json.load(f)
+    over = 0
+    print('%-22s %-18s %9s %4s %5s %7s %9s %9s %9s %9s %9s' % (
+        'anim', 'asset', 'size', 'lod', 'scale', 'segs', 'fill_kpx', 'mask_kpx', 'est_us', 'budget', 'status'))
+    for cfg in parse_anim_configs(args.config):
+        if not os.path.isfile(os.path.join(args.src, cfg['name'])):
+            print('lottie_assets: warning: %s 引用的 %s 不存在' % (cfg['anim'], cfg['name']))
+            continue
+        doc = device_doc(args.src, cfg['name'], cfg['lod'])
+        peak = max((frame_features(doc, cfg['width'], cfg['height'], cfg['scale_q8'], t)
+                    for t in _peak_times(doc)), key=lambda f: estimate_us(model, f))
+        est = estimate_us(model, peak)
+        budget = budgets.get(cfg['anim'], frame_budget_us(doc, cfg['frame_step'], args.refr_period_ms))
+        ok = est <= budget
+        over += 0 if ok else 1
+        print('%-22s %-18s %4dx%-4d %4d %5d %7d %9.1f %9.1f %9d %9d %9s' % (
+            cfg['anim'], cfg['name'], cfg['width'], cfg['height'], cfg['lod'], cfg['scale_q8'],
+            peak['segments'], (peak['fill_px'] + peak['grad_px']) / 1000.0,
+            (peak['mask_px'] + peak['matte_px']) / 1000.0, est, budget, 'ok' if ok else 'OVER'))
+    if over:
+        print('lottie_assets: %s: %d 个动画超出每帧光栅化预算' % ('error' if args.strict else 'warning', over))
+        print('  可降低质量预设/渲染比例，或在 %s 中调整预算' % (args.budgets or 'lottie_budgets.json'))
+    print('估算为峰值帧（可见图层最多时）的光栅化耗时，模型: %s' % (
+        args.model if os.path.isfile(args.model) else '默认系数'))
+    return 1 if over and args.strict else 0
+
+
+# ---------------- calibrate 子命令 ----------------
+
+_LOG_FILE_RE = re.compile(r'Lottie JSON 文件: (\S+),')
+_LOG_PROFILE_RE = re.compile(r'渲染比例\s+(\d+)/256 \((\d+)x(\d+)\): 光栅化 (\d+) us')
+
+
+def _solve(a, b):
+    # 高斯消元（带主元），a 为 n×n
+    n = len(b)
+    m = [row[:] + [b[i]] for i, row in enumerate(a)]
+    for c in range(n):
+        piv = max(range(c, n), key=lambda r: abs(m[r][c]))
+        m[c], m[piv] = m[piv], m[c]
+        if abs(m[c][c]) < 1e-12:
+            continue
+        for r in range(n):
+            if r != c:
+                f = m[r][c] / m[c][c]
+                m[r] = [x - f * y for x, y in zip(m[r], m[c])]
+    return [m[i][n] / m[i][i] if abs(m[i][i]) > 1e-12 else 0.0 for i in range(n)]
+
+
+def fit_cost_model(samples, base):
+    # 拟合各特征相对 base 的倍率，向 1 正则化（样本少时保持默认），倍率不小于 0
+    rows = [[base[name] * feat[name] for name in COST_FEATURES] for feat, _ in samples]
+    y = [us for _, us in samples]
+    n = len(COST_FEATURES)
+    ata = [[sum(r[i] * r[j] for r in rows) for j in range(n)] for i in range(n)]
+    aty = [sum(r[i] * v for r, v in zip(rows, y)) for i in range(n)]
+    lam = 0.05 * sum(ata[i][i] for i in range(n)) / n
+    fixed = set()
+    while True:
+        a = [[ata[i][j] + (lam if i == j else 0.0) for j in range(n)] for i in range(n)]
+        b = [aty[i] + lam for i in range(n)]
+        for i in fixed:
+            a[i] = [1.0 if j == i else 0.0 for j in range(n)]
+            b[i] = 0.0
+        mult = _solve(a, b)
+        neg = [i for i in range(n) if mult[i] < 0 and i not in fixed]
+        if not neg:
+            break
+        fixed.update(neg)
+    return dict((name, base[name] * max(mult[i], 0.0)) for i, name in enumerate(COST_FEATURES))
+
+
+def cmd_calibrate(args):
+    samples = []
+    path = None
+    with open(args.log, encoding='utf-8', errors='replace') as f:
+        for line in f:
+            m = _LOG_FILE_RE.search(line)
+            if m:
+                path = os.path.basename(m.group(1))
+                continue
+            m = _LOG_PROFILE_RE.search(line)
+            if not m or not path:
+                continue
+            scale_q8, w, h, us = (int(x) for x in m.groups())
+            lod_m = re.match(r'(.*)\.lod(\d)(\.json)$', path)
+            name, lod = (lod_m.group(1) + lod_m.group(3), int(lod_m.group(2))) if lod_m else (path, 0)
+            if not os.path.isfile(os.path.join(args.src, name)):
+                continue
+            doc = device_doc(args.src, name, lod)
+            feats = [frame_features(doc, w, h, scale_q8, t) for t in _profile_times(doc)]
+            avg = dict((k, sum(f[k] for f in feats) / len(feats)) for k in COST_FEATURES)
+            samples.append((avg, float(us), '%s@%dx%d/%d' % (path, w, h, scale_q8)))
+    if not samples:
+        print('lottie_assets: 日志中没有找到 lottie_manager_profile_anim 的测量结果')
+        return 1
+
+    base = load_cost_model(args.model)
+    model = fit_cost_model([(f, us) for f, us, _ in samples], base)
+    print('%-40s %9s %9s %9s' % ('sample', 'measured', 'before', 'after'))
+    for feat, us, label in samples:
+        print('%-40s %9d %9d %9d' % (label, us, estimate_us(base, feat), estimate_us(model, feat)))
+    with open(args.model, 'w') as f:
+        json.dump({'samples': len(samples),
+                   'coefficients': dict((k, round(v, 6)) for k, v in model.items())}, f, indent=2)
+        f.write('\n')
+    print('已写入 %s（%d 个样本）' % (args.model, len(samples)))
+    return 0
+
+
+# ---------------- lod 子命令 ----------------
+
+def cmd_lod(args):
+    print('%-20s %4s %6s %8s %7s %12s' % ('asset', 'lod', 'verts', 'removed', 'dashes', 'max_err_px'))
+    for name in sorted(os.listdir(args.src)):
+        if not name.lower().endswith('.json'):
+            continue
+        with open(os.path.join(args.src, name), 'rb') as f:
+            doc = json.load(f)
+        for level in sorted(LOD_LEVELS):
+            _, stats = simplify_lottie(doc, level)
+            print('%-20s %4d %6d %8d %7d %12.2f' % (
+                name, level, stats['verts'], stats['removed'], stats['dashes'], stats['max_err_px']))
+    print('误差为 LOD 参考尺寸下删点造成的最大轮廓偏移（像素）')
+    return 0
+
+
+# ---------------- arena 子命令 ----------------
+
+ARENA_BENCH_SRC = os.path.join(TOOL_DIR, 'lottie_arena_bench.c')
+ARENA_SRC_DIR = os.path.join(TOOL_DIR, '..', 'src')
+ARENA_PTR_SIZE = 4          # 设备为32位
+ARENA_OBJ_BASE = 48         # Lottie 对象的基本大小（虚表、变换、名称等）
+
+
+class _AllocTrace(object):
+    def __init__(self):
+        self.ops = []
+        self.next_id = 0
+
+    def alloc(self, size):
+        i = self.next_id
+        self.next_id += 1
+        self.ops.append('a %d %d' % (i, max(1, size)))
+        return i
+
+    def free(self, i):
+        self.ops.append('f %d' % i)
+
+    def array(self, count, elem):
+        # tvg::Array 按 1.5 倍扩容，realloc 搬移时旧块释放
+        block = None
+        reserved = 0
+        for n in range(count):
+            if n + 1 > reserved:
+                reserved = n + (n + 2) // 2
+                new = self.alloc(reserved * elem)
+                if block is not None:
+                    self.free(block)
+                block = new
+
+
+def _trace_node(node, trace):
+    # 近似 ThorVG Lottie 解析：每个对象一次分配，对象/数组列表按 Array 扩容，
+    # 数值数组（关键帧值、路径顶点）一次分配，名称字符串复制一份
+    if isinstance(node, dict):
+        trace.alloc(ARENA_OBJ_BASE + 8 * len(node))
+        for key, value in node.items():
+            if key == 'nm' and isinstance(value, str):
+                trace.alloc(len(value.encode('utf-8')) + 1)
+            else:
+                _trace_node(value, trace)
+    elif isinstance(node, list):
+        if node and all(isinstance(v, (int, float)) for v in node):
+            trace.alloc(4 * len(node))
+            return
+        trace.array(len(node), ARENA_PTR_SIZE)
+        for value in node:
+            _trace_node(value, trace)
+
+
+def arena_trace(doc):
+    trace = _AllocTrace()
+    _trace_node(doc, trace)
+    return trace
+
+
+def _build_arena_bench(out_dir, cc):
+    exe = os.path.join(out_dir, 'lottie_arena_bench')
+    cmd = [cc, '-O2', '-std=gnu11', '-I', ARENA_SRC_DIR, ARENA_BENCH_SRC,
+           os.path.join(ARENA_SRC_DIR, 'xn_lottie_arena.c'), '-o', exe]
+    subprocess.check_call(cmd)
+    return exe
+
+
+def cmd_arena(args):
+    work = tempfile.mkdtemp(prefix='lottie_arena_')
+    try:
+        try:
+            exe = _build_arena_bench(work, args.cc)
+        except (OSError, subprocess.CalledProcessError) as e:
+            print('lottie_assets: error: 编译 lottie_arena_bench.c 失败: %s' % e)
+            return 1
+        print('%-20s %6s %-6s %9s %9s %9s %11s %9s %6s' % (
+            'asset', 'allocs', 'mode', 'load_us', 'unload_us', 'free_kb', 'largest_kb', 'free_blks', 'frag'))
+        for name in sorted(os.listdir(args.src)):
+            if not name.lower().endswith('.json'):
+                continue
+            trace = arena_trace(device_doc(args.src, name, 0))
+            trace_path = os.path.join(work, name + '.trace')
+            with open(trace_path, 'w') as f:
+                f.write('\n'.join(trace.ops) + '\n')
+            out = subprocess.check_output([exe, trace_path, str(args.cycles), str(args.heap_kb)])
+            allocs = sum(1 for op in trace.ops if op[0] == 'a')
+            for line in out.decode().splitlines():
+                mode, load_us, unload_us, free_kb, largest_kb, blocks, frag, pages = line.split()[:8]
+                print('%-20s %6d %-6s %9s %9s %9s %11s %9s %5s%%%s' % (
+                    name, allocs, mode, load_us, unload_us, free_kb, largest_kb, blocks, frag,
+                    '  (%s 页)' % pages if mode == 'arena' else ''))
+    finally:
+        shutil.rmtree(work, ignore_errors=True)
+    print('%d 次加载/卸载后的通用堆状态（%d KB，穿插其他模块分配）；耗时只含分配器，不含解析' % (
+        args.cycles, args.heap_kb))
+    print('frag = 1 - 最大空闲块 / 空闲总量')
+    return 0
+
+
+# ---------------- soak 子命令 ----------------
+
+SOAK_BENCH_SRC = os.path.join(TOOL_DIR, 'lottie_soak_bench.c')
+IMAGE_CACHE_HEADER = os.path.join(ARENA_SRC_DIR, 'xn_lottie_image_cache.h')
+SOAK_DEFAULT_IMAGES = ['412x412', '200x200a']   # 全屏背景图 + 带透明度的图标
+SOAK_WINDOWS = 8                                # 预热后分为若干窗口判断单调趋势
+SOAK_CHART_WIDTH = 64
+SOAK_SPARK = ' ▁▂▃▄▅▆▇█'
+
+
+def _soak_docs(src_dir, name, lod):
+    # 与 device_doc 相同，另外返回拆分出的背景（没有时为 None）
+    with open(os.path.join(src_dir, name), 'rb') as f:
+        doc = json.load(f)
+    bg_doc = None
+    bg_count = split_static(doc)
+    if bg_count:
+        bg_doc, doc = split_docs(doc, bg_count)
+    if lod:
+        lod_doc, stats = simplify_lottie(doc, lod)
+        if stats['removed'] or stats['dashes']:
+            doc = lod_doc
+    return doc, bg_doc
+
+
+def _json_size(doc):
+    return len(json.dumps(doc, separators=(',', ':')).encode('utf-8'))
+
+
+def _soak_images(args):
+    # lottie_spiffs 中的 PNG 按构建后的 .bin 大小计；没有图片时用 --image 或默认尺寸
+    images = []
+    for name in sorted(os.listdir(args.src)):
+        if not name.lower().endswith('.png'):
+            continue
+        with open(os.path.join(args.src, name), 'rb') as f:
+            head = f.read(26)
+        if len(head) < 26 or head[:8] != b'\x89PNG\r\n\x1a\n':
+            continue
+        w, h = struct.unpack('>II', head[16:24])
+        images.append((name, 12 + w * h * (3 if head[25] in (4, 6) else 2)))
+    for spec in (args.image or ([] if images else SOAK_DEFAULT_IMAGES)):
+        m = re.match(r'^(\d+)x(\d+)(a?)$', spec)
+        if not m:
+            raise ValueError('图片尺寸格式应为 WxH 或 WxHa（带透明度）: %s' % spec)
+        w, h = int(m.group(1)), int(m.group(2))
+        images.append(('image_' + spec, 12 + w * h * (3 if m.group(3) else 2)))
+    return images
+
+
+def _soak_defines():
+    with open(IMAGE_CACHE_HEADER, encoding='utf-8') as f:
+        text = f.read()
+    defines = []
+    for name in ('LOTTIE_IMG_CACHE_SLOTS', 'LOTTIE_IMG_CACHE_BUDGET'):
+        m = re.search(r'#define\s+%s\s+(.+?)\s*(//.*)?$' % name, text, re.M)
+        if m:
+            defines.append('-D%s=%s' % (name, m.group(1)))
+    return defines
+
+
+def _sparkline(values):
+    lo, hi = min(values), max(values)
+    step = max(1, len(values) // SOAK_CHART_WIDTH)
+    cols = [sum(values[i:i + step]) / len(values[i:i + step]) for i in range(0, len(values), step)]
+    span = (hi - lo) or 1
+    return ''.join(SOAK_SPARK[int((v - lo) * (len(SOAK_SPARK) - 1) / span)] for v in cols), lo, hi
+
+
+def _monotonic(windows, rising):
+    pairs = list(zip(windows, windows[1:]))
+    return all((b > a) if rising else (b < a) for a, b in pairs)
+
+
+def cmd_soak(args):
+    try:
+        images = _soak_images(args)
+    except ValueError as e:
+        print('lottie_assets: error: %s' % e)
+        return 1
+    configs = parse_anim_configs(args.config)
+    if not configs:
+        print('lottie_assets: error: %s 中没有找到 anim_configs' % args.config)
+        return 1
+
+    work = tempfile.mkdtemp(prefix='lottie_soak_')
+    try:
+        exe = os.path.join(work, 'lottie_soak_bench')
+        try:
+            subprocess.check_call([args.cc, '-O2', '-std=gnu11', '-I', ARENA_SRC_DIR] + _soak_defines() +
+                                  [SOAK_BENCH_SRC, os.path.join(ARENA_SRC_DIR, 'xn_lottie_arena.c'), '-o', exe])
+        except (OSError, subprocess.CalledProcessError) as e:
+            print('lottie_assets: error: 编译 lottie_soak_bench.c 失败: %s' % e)
+            return 1
+
+        plan = []
+        for i, cfg in enumerate(configs):
+            if not os.path.isfile(os.path.join(args.src, cfg['name'])):
+                print('lottie_assets: %s 不存在，跳过 %s' % (cfg['name'], cfg['anim']))
+                continue
+            doc, bg_doc = _soak_docs(args.src, cfg['name'], cfg['lod'])
+            scene_path = os.path.join(work, '%d.ops' % i)
+            with open(scene_path, 'w') as f:
+                f.write('\n'.join(arena_trace(doc).ops) + '\n')
+            bg_path, bg_json, bg_out = '-', 0, 0
+            if bg_doc is not None:
+                bg_path = os.path.join(work, '%d.bg.ops' % i)
+                with open(bg_path, 'w') as f:
+                    f.write('\n'.join(arena_trace(bg_doc).ops) + '\n')
+                # 是否全不透明要渲染后才知道，按 RGB565A8 计
+                bg_json, bg_out = _json_size(bg_doc), cfg['width'] * cfg['height'] * 3
+            plan.append('anim %s %d %d %d %s %d %d %s' % (
+                cfg['anim'], cfg['width'], cfg['height'], _json_size(doc), scene_path, bg_json, bg_out, bg_path))
+        plan += ['image %s %d' % img for img in images]
+        plan_path = os.path.join(work, 'plan.txt')
+        with open(plan_path, 'w') as f:
+            f.write('\n'.join(plan) + '\n')
+
+        start = time.time()
+        out = subprocess.check_output([exe, plan_path, str(args.cycles), str(args.heap_kb)])
+        elapsed = time.time() - start
+    finally:
+        shutil.rmtree(work, ignore_errors=True)
+
+    rows = [tuple(int(x) for x in line.split()) for line in out.decode().splitlines()]
+    if not rows:
+        print('lottie_assets: error: lottie_soak_bench 没有输出')
+        return 1
+    if args.csv:
+        with open(args.csv, 'w') as f:
+            f.write('cycle,free_kb,largest_kb,live_allocs,buf_fail,img_fail,buf_largest_kb\n')
+            for row in rows:
+                f.write(','.join(str(x) for x in row) + '\n')
+
+    print('%d 个动画、%d 张图片，%d 周期（堆 %d KB），用时 %.1f s' % (
+        len(plan) - len(images), len(images), len(rows), args.heap_kb, elapsed))
+    # buf_largest_kb：申请渲染缓冲区前的最大空闲块；其余为停止动画后的堆状态
+    for col, label in ((6, 'buf_largest'), (2, 'largest_kb'), (1, 'free_kb'), (3, 'live_allocs')):
+        line, lo, hi = _sparkline([row[col] for row in rows])
+        print('%-12s %8d %s %d' % (label, lo, line, hi))
+
+    # 预热（图片缓存填满、页池和其他模块分配达到稳态）后按窗口比较
+    body = rows[len(rows) // 10:]
+    failures = []
+    if len(body) >= SOAK_WINDOWS * 2:
+        size = len(body) // SOAK_WINDOWS
+        windows = [body[i * size:(i + 1) * size] for i in range(SOAK_WINDOWS)]
+        live = [sum(r[3] for r in w) / float(len(w)) for w in windows]
+        used = [sum(args.heap_kb - r[1] for r in w) / float(len(w)) for w in windows]
+        largest = [min(r[6] for r in w) for w in windows]
+        print('%-12s %s' % ('window', ' '.join('%9d' % (i + 1) for i in range(SOAK_WINDOWS))))
+        print('%-12s %s' % ('live_allocs', ' '.join('%9.1f' % v for v in live)))
+        print('%-12s %s' % ('used_kb', ' '.join('%9.1f' % v for v in used)))
+        print('%-12s %s' % ('buf_largest', ' '.join('%9d' % v for v in largest)))
+        if _monotonic(live, True):
+            failures.append('存活分配数逐窗口增长（%.1f -> %.1f），疑似泄漏' % (live[0], live[-1]))
+        if _monotonic(used, True):
+            failures.append('已用内存逐窗口增长（%.1f -> %.1f KB），疑似泄漏' % (used[0], used[-1]))
+        if _monotonic(largest, False):
+            failures.append('最大空闲块逐窗口下降（%d -> %d KB），碎片持续增加' % (largest[0], largest[-1]))
+    else:
+        print('周期数过少，不做趋势判断')
+    last = rows[-1]
+    if last[4]:
+        failures.append('渲染缓冲区分配失败 %d 次' % last[4])
+    if last[5]:
+        failures.append('图片分配失败 %d 次' % last[5])
+
+    for msg in failures:
+        print('FAIL: %s' % msg)
+    if not failures:
+        print('PASS: 未发现单调增长')
+    return 1 if failures else 0
+
+
+# ---------------- trace 子命令 ----------------
+
+# 与 xn_lottie_trace.h 一致
+TRACE_MAGIC = 0x4352544C
+TRACE_VERSION = 1
+TRACE_HEADER = '<IHHB3x'
+TRACE_REC = '<IBBBBhhhhI'
+TRACE_STR_LEN = 64
+TRACE_NO_STR = 0xFF
+TRACE_BURST_MS = 100
+
+TRACE_CMD_NAMES = ['play', 'stop', 'hide', 'show', 'set_pos', 'move', 'center', 'show_image',
+                   'hide_image', 'image_ready', 'publish', 'preloaded', 'drive', 'override', 'batch']
+TRACE_OVERRIDE_NAMES = ['color', 'opacity', 'clear']
+
+_ANSI_RE = re.compile(r'\x1b\[[0-9;]*m')
+_TRACE_BEGIN_RE = re.compile(r'TRACE BEGIN (\d+) (\d+)')
+_TRACE_STR_RE = re.compile(r'TRACE S (\d+) (.*)$')
+_TRACE_REC_RE = re.compile(r'TRACE R ([0-9a-fA-F]{40})')
+_TRACE_REPORT_RE = re.compile(r'回放报告: .*$')
+
+
+def parse_trace_log(path):
+    """返回日志中最后一次导出的 (strings, recs) 以及全部回放报告行"""
+    traces, reports, cur = [], [], None
+    with open(path, encoding='utf-8', errors='replace') as f:
+        for line in f:
+            line = _ANSI_RE.sub('', line).rstrip()
+            m = _TRACE_REPORT_RE.search(line)
+            if m:
+                reports.append(m.group(0))
+                continue
+            m = _TRACE_BEGIN_RE.search(line)
+            if m:
+                cur = {'count': int(m.group(1)), 'strings': [''] * int(m.group(2)), 'recs': []}
+                continue
+            if cur is None:
+                continue
+            m = _TRACE_STR_RE.search(line)
+            if m and int(m.group(1)) < len(cur['strings']):
+                cur['strings'][int(m.group(1))] = m.group(2)
+                continue
+            m = _TRACE_REC_RE.search(line)
+            if m:
+                cur['recs'].append(struct.unpack(TRACE_REC, bytes.fromhex(m.group(1))))
+                continue
+            if 'TRACE END' in line:
+                if len(cur['recs']) != cur['count']:
+                    print('lottie_assets: 命令流不完整（%d/%d 条），跳过' % (len(cur['recs']), cur['count']))
+                else:
+                    traces.append(cur)
+                cur = None
+    if not traces:
+        return None, None, reports
+    return traces[-1]['strings'], traces[-1]['recs'], reports
+
+
+def _trace_desc(rec, strings):
+    t, typ, arg, si, _, a, b, c, _, value = rec
+    s = strings[si] if si != TRACE_NO_STR and si < len(strings) else ''
+    name = TRACE_CMD_NAMES[typ] if typ < len(TRACE_CMD_NAMES) else 'cmd%d' % typ
+    if name == 'play':
+        what = s if a < 0 else 'anim %d' % a
+        return '%s %s %dx%d @(%d,%d)%s' % (name, what, value >> 16, value & 0xFFFF, b, c,
+                                         ' center' if arg else '')
+    if name == 'stop':
+        return '%s anim %d' % (name, a)
+    if name in ('set_pos', 'move'):
+        return '%s (%d,%d)%s' % (name, a, b, ' %d ms' % value if name == 'move' else '')
+    if name == 'show_image':
+        return '%s %s %dx%d' % (name, s, value >> 16, value & 0xFFFF)
+    if name == 'drive':
+        return '%s %s [%d, %d]' % (name, 'on' if arg else 'off', a, b)
+    if name == 'override':
+        kind = TRACE_OVERRIDE_NAMES[arg] if arg < len(TRACE_OVERRIDE_NAMES) else str(arg)
+        return '%s %s %s 0x%06x' % (name, kind, s, value)
+    if name == 'batch':
+        return '%s %d' % (name, arg)
+    return name
+
+
+def cmd_trace(args):
+    strings, recs, reports = parse_trace_log(args.log)
+    if recs is None:
+        print('lottie_assets: 日志中没有找到完整的命令流（lottie_manager_trace_dump 的输出）')
+        return 1 if not reports else 0
+
+    if recs:
+        counts = {}
+        burst, lo = 0, 0
+        for hi, rec in enumerate(recs):
+            name = TRACE_CMD_NAMES[rec[1]] if rec[1] < len(TRACE_CMD_NAMES) else 'cmd%d' % rec[1]
+            counts[name] = counts.get(name, 0) + 1
+            while rec[0] - recs[lo][0] >= TRACE_BURST_MS:
+                lo += 1
+            burst = max(burst, hi - lo + 1)
+            if args.verbose:
+                print('%8d ms  %s' % (rec[0], _trace_desc(rec, strings)))
+        duration = recs[-1][0] - recs[0][0]
+        print('%d 条命令，时长 %d ms，%d 个字符串' % (len(recs), duration, len(strings)))
+        print('最大突发：%d ms 内 %d 条命令' % (TRACE_BURST_MS, burst))
+        for name in sorted(counts, key=lambda k: -counts[k]):
+            print('  %-12s %5d' % (name, counts[name]))
+
+    if args.out:
+        with open(args.out, 'wb') as f:
+            f.write(struct.pack(TRACE_HEADER, TRACE_MAGIC, TRACE_VERSION, len(recs), len(strings)))
+            for s in strings:
+                f.write(s.encode('utf-8')[:TRACE_STR_LEN - 1].ljust(TRACE_STR_LEN, b'\0'))
+            for rec in recs:
+                f.write(struct.pack(TRACE_REC, *rec))
+        print('已写入 %s（设备上回放：lottie_manager_trace_replay("/lottie/%s")）' % (
+            args.out, os.path.basename(args.out)))
+
+    for line in reports:
+        print(line)
+    return 0
+
+
+# ---------------- modes 子命令 ----------------
+# 显示侧每帧耗时模型（微秒），默认值为 ESP32-S3 240MHz + PSRAM 帧缓冲的粗略值。
+# 动画以 ARGB8888 缓冲区居中显示，每帧动画区域失效；设备上用 lvgl_driver_get_stats 实测对比
+
+DISPLAY_COSTS = {
+    'blend_px': 0.012,      # ARGB8888 动画缓冲区混合到 RGB565
+    'fill_px': 0.002,       # 屏幕背景填充
+    'swap_px': 0.004,       # RGB565 字节交换
+    'copy_px': 0.003,       # 直接模式刷屏后同步脏区域到另一块缓冲区
+}
+
+
+def _display_cost(mode, screen, rect, args):
+    # 返回 (刷屏次数, 传输字节, 每帧显示耗时 us, 可与下一帧光栅化重叠的 us)
+    sw, sh = screen
+    w, h = rect
+    bw = args.spi_mhz * 4 / 8.0      # QSPI 四线，字节/微秒
+    if mode == 'partial':
+        # 条带高度 = 缓冲区像素数 / 区域宽度（宽度按4像素对齐）
+        aw = min(sw, (w + 3) // 4 * 4)
+        rows = max(1, sw * sh // args.partial_div // aw)
+        strips = (h + rows - 1) // rows
+        cpu = rows * aw * (DISPLAY_COSTS['blend_px'] + DISPLAY_COSTS['swap_px']) + args.flush_us
+        dma = rows * aw * 2 / bw
+        # 双缓冲：渲染下一条带与传输上一条带重叠
+        total = strips * max(cpu, dma) + min(cpu, dma)
+        return strips, h * aw * 2, total, 0.0
+    if mode == 'direct':
+        # 脏区域扩展为整行，一次刷屏；发送完成后换回字节序，下一帧开始前同步到另一块缓冲区
+        px = sw * h
+        cpu = (w * h * DISPLAY_COSTS['blend_px'] + (px - w * h) * DISPLAY_COSTS['fill_px'] +
+               px * DISPLAY_COSTS['swap_px'] + args.flush_us)
+        dma = px * 2 / bw
+        post = px * (DISPLAY_COSTS['swap_px'] + DISPLAY_COSTS['copy_px'])
+        return 1, px * 2, cpu + dma + post, 0.0
+    # full：整屏渲染和刷屏，传输与下一帧的光栅化、渲染重叠
+    px = sw * sh
+    cpu = (w * h * DISPLAY_COSTS['blend_px'] + (px - w * h) * DISPLAY_COSTS['fill_px'] +
+           px * DISPLAY_COSTS['swap_px'] + args.flush_us)
+    dma = px * 2 / bw
+    return 1, px * 2, cpu + dma, dma
+
+
+def cmd_modes(args):
+    model = load_cost_model(args.model)
+    sw, sh = [int(v) for v in args.screen.lower().split('x')]
+    period = args.refr_period_ms * 1000.0
+    memory = {
+        'partial': 2 * sw * sh // args.partial_div * 2,
+        'direct': 2 * sw * sh * 2,
+        'full': 2 * sw * sh * 2,
+    }
+    fps_sum = dict((mode, []) for mode in memory)
+
+    print('%-22s %-9s %9s %7s %8s %9s %9s %9s %7s %7s' % (
+        'anim', 'mode', 'size', 'flushes', 'xfer_kb', 'raster_us', 'disp_us', 'frame_us', 'fps', 'max_fps'))
+    for cfg in parse_anim_configs(args.config):
+        if not os.path.isfile(os.path.join(args.src, cfg['name'])):
+            print('lottie_assets: warning: %s 引用的 %s 不存在' % (cfg['anim'], cfg['name']))
+            continue
+        doc = device_doc(args.src, cfg['name'], cfg['lod'])
+        raster = max(estimate_us(model, frame_features(doc, cfg['width'], cfg['height'], cfg['scale_q8'], t))
+                     for t in _profile_times(doc))
+        raster /= cfg['frame_step']
+        rect = (min(cfg['width'], sw), min(cfg['height'], sh))
+        for mode in ('partial', 'direct', 'full'):
+            flushes, xfer, disp, overlap = _display_cost(mode, (sw, sh), rect, args)
+            frame = max(raster + disp - overlap, disp)
+            fps = 1e6 / max(frame, period)
+            fps_sum[mode].append(1e6 / frame)
+            print('%-22s %-9s %4dx%-4d %7d %8.1f %9d %9d %9d %7.1f %7.1f' % (
+                cfg['anim'], mode, rect[0], rect[1], flushes, xfer / 1024.0, raster, disp, frame,
+                fps, 1e6 / frame))
+
+    print('显示缓冲区内存（PSRAM）:')
+    for mode in ('partial', 'direct', 'full'):
+        avg = sum(fps_sum[mode]) / len(fps_sum[mode]) if fps_sum[mode] else 0.0
+        print('  %-8s %6d KB  平均最高 %.1f fps' % (mode, memory[mode] // 1024, avg))
+    print('fps 受刷新周期 %d ms 限制，max_fps 为不受限时的估算；QSPI %d MHz，每次刷屏固定开销 %d us' % (
+        args.refr_period_ms, args.spi_mhz, args.flush_us))
+    return 0
+
+
+# ---------------- flush 子命令 ----------------
+FLUSH_CHUNK_SWEEP_KB = (2, 4, 8, 16, 32, 64)
+
+
+def _flush_time(w, h, chunk_bytes, args):
+    # 返回 (区域从开始字节交换到最后一块传输完成的耗时, LVGL任务在 flush_cb 中的耗时, 分块数)，微秒。
+    # 整块发送（chunk_bytes 为0）时 LVGL 任务自己交换整块再提交；分块时交给刷屏任务，
+    # esp_lcd 发送窗口设置命令前会等待前一块传输完成，所以第N+1块只有字节交换能与第N块重叠
+    bw = args.spi_mhz * 4 / 8.0
+    if not chunk_bytes:
+        cpu = w * h * args.swap_px + args.flush_us
+        return cpu + w * h * 2 / bw, cpu, 1
+    rows = max(1, chunk_bytes // (w * 2))
+    sizes = [min(rows, h - y) * w for y in range(0, h, rows)]
+    t = args.handoff_us + sizes[0] * args.swap_px + args.flush_us
+    for prev, px in zip(sizes, sizes[1:]):
+        t += max(px * args.swap_px, prev * 2 / bw) + args.chunk_us
+    return t + sizes[-1] * 2 / bw, args.handoff_us, len(sizes)
+
+
+def cmd_flush(args):
+    sw, sh = [int(v) for v in args.screen.lower().split('x')]
+    chunk = args.chunk_kb * 1024
+    areas = []
+    for cfg in parse_anim_configs(args.config):
+        w, h = min(cfg['width'], sw), min(cfg['height'], sh)
+        aw = min(sw, (w + 3) // 4 * 4)
+        rows = min(h, max(1, sw * sh // args.partial_div // aw))
+        areas.append((cfg['anim'], 'partial', aw, rows, (h + rows - 1) // rows))
+        areas.append((cfg['anim'], 'direct', sw, h, 1))
+    areas.append(('-', 'full', sw, sh, 1))
+
+    period = args.refr_period_ms * 1000.0
+    print('%-22s %-8s %9s %7s %10s %9s %10s %9s %6s %10s %7s' % (
+        'anim', 'mode', 'area', 'kb', 'before_us', 'after_us', 'lvgl_b_us', 'lvgl_a_us', 'chunks', 'best_kb',
+        'period%'))
+    for anim, mode, w, h, strips in areas:
+        before, lvgl_before, _ = _flush_time(w, h, 0, args)
+        after, lvgl_after, chunks = _flush_time(w, h, chunk, args)
+        best = min(FLUSH_CHUNK_SWEEP_KB, key=lambda kb: _flush_time(w, h, kb * 1024, args)[0])
+        print('%-22s %-8s %4dx%-4d %7.1f %10d %9d %10d %9d %6d %10d %6.0f%%' % (
+            anim, mode, w, h, w * h * 2 / 1024.0, before, after, lvgl_before, lvgl_after, chunks, best,
+            after * strips * 100.0 / period))
+    print('before/after: 区域刷屏完成耗时（整块 / 分块）；lvgl_b/lvgl_a: LVGL任务在 flush_cb 中的耗时，'
+          '分块发送时交换移到刷屏任务，与下一块渲染并行；period%%: 一帧（partial 为全部条带）分块刷屏占刷新周期 %d ms 的比例' %
+          args.refr_period_ms)
+    print('分块 %d KB（LVGL_FLUSH_CHUNK_BYTES）；QSPI %d MHz，字节交换 %.4f us/px，'
+          '首块固定开销 %d us，之后每块 %d us，交给刷屏任务 %d us' % (
+              args.chunk_kb, args.spi_mhz, args.swap_px, args.flush_us, args.chunk_us, args.handoff_us))
+    return 0
+
+
+# ---------------- kernels 子命令 ----------------
+
+KERNELS_TEST_SRC = os.path.join(TOOL_DIR, 'lvgl_kernels_test.c')
+LVGL_DRIVER_DIR = os.path.join(TOOL_DIR, '..', '..', 'xn_lvgl_driver')
+
+
+def cmd_kernels(args):
+    work = tempfile.mkdtemp(prefix='lvgl_kernels_')
+    try:
+        exe = os.path.join(work, 'lvgl_kernels_test')
+        try:
+            subprocess.check_call([args.cc, '-O2', '-std=gnu11', '-Wall',
+                                   '-I', os.path.join(LVGL_DRIVER_DIR, 'include'), KERNELS_TEST_SRC,
+                                   os.path.join(LVGL_DRIVER_DIR, 'src', 'xn_lvgl_kernels.c'), '-o', exe])
+        except (OSError, subprocess.CalledProcessError) as e:
+            print('lottie_assets: error: 编译 lvgl_kernels_test.c 失败: %s' % e)
+            return 1
+        ret = subprocess.call([exe])
+    finally:
+        shutil.rmtree(work, ignore_errors=True)
+    if ret:
+        print('lottie_assets: error: 像素核参考实现与 LVGL 9.2 不一致')
+        return 1
+    print('像素核参考实现与 LVGL 9.2 C 实现逐位一致（设备上 PIE 实现由启动自检与参考实现比对）')
+    return 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Lottie 资源构建工具')
+    sub = parser.add_subparsers(dest='cmd')
+    p = sub.add_parser('build', help='生成 SPIFFS 分区内容')
+    p.add_argument('--src', required=True, help='源资源目录')
+    p.add_argument('--out', required=True, help='输出目录')
+    p.add_argument('--no-compress', action='store_true', help='JSON 不压缩，原样复制')
+    p.set_defaults(func=cmd_build)
+    p = sub.add_parser('bench', help='主机上对比原始/压缩资源加载时间')
+    p.add_argument('--src', required=True, help='源资源目录')
+    p.add_argument('--flash-kbps', type=int, default=4096, help='SPIFFS 读取带宽估算 (KB/s)')
+    p.add_argument('--iterations', type=int, default=50, help='每个资源的计时次数')
+    p.set_defaults(func=cmd_bench)
+    p = sub.add_parser('slots', help='列出注入的插槽 ID')
+    p.add_argument('--src', required=True, help='源资源目录')
+    p.set_defaults(func=cmd_slots)
+    p = sub.add_parser('split', help='输出静态背景图层拆分和光栅化节省估算')
+    p.add_argument('--src', required=True, help='源资源目录')
+    p.set_defaults(func=cmd_split)
+    p = sub.add_parser('hold', help='列出关键帧时间线中画面不变的帧区间')
+    p.add_argument('--src', required=True, help='源资源目录')
+    p.add_argument('-v', '--verbose', action='store_true', help='列出每个区间')
+    p.set_defaults(func=cmd_hold)
+    p = sub.add_parser('analyze', help='按 anim_configs 估算每帧光栅化耗时并检查预算')
+    p.add_argument('--src', required=True, help='源资源目录')
+    p.add_argument('--config', required=True, help='包含 anim_configs 的 xn_lottie_manager.c')
+    p.add_argument('--budgets', help='每个动画的预算 JSON（{"LOTTIE_ANIM_XXX": 微秒}）')
+    p.add_argument('--model', default=COST_MODEL_FILE, help='代价模型系数')
+    p.add_argument('--refr-period-ms', type=int, default=REFR_PERIOD_MS,
+                   help='LVGL 刷新周期 (LV_DEF_REFR_PERIOD，默认取自 sdkconfig.defaults)')
+    p.add_argument('--strict', action='store_true', help='超出预算时返回错误')
+    p.set_defaults(func=cmd_analyze)
+    p = sub.add_parser('calibrate', help='按设备实测耗时拟合代价模型')
+    p.add_argument('--src', required=True, help='源资源目录')
+    p.add_argument('--log', required=True, help='设备日志（含 lottie_manager_profile_anim 输出）')
+    p.add_argument('--model', default=COST_MODEL_FILE, help='代价模型系数（读取并覆盖写入）')
+    p.set_defaults(func=cmd_calibrate)
+    p = sub.add_parser('lod', help='输出 LOD 变体的简化统计和视觉误差')
+    p.add_argument('--src', required=True, help='源资源目录')
+    p.set_defaults(func=cmd_lod)
+    p = sub.add_parser('arena', help='主机上对比通用堆/场景分区的加载卸载耗时和碎片')
+    p.add_argument('--src', required=True, help='源资源目录')
+    p.add_argument('--cycles', type=int, default=10000, help='加载/卸载次数')
+    p.add_argument('--heap-kb', type=int, default=4096, help='通用堆模型大小 (KB)')
+    p.add_argument('--cc', default=os.environ.get('CC', 'cc'), help='主机 C 编译器')
+    p.set_defaults(func=cmd_arena)
+    p = sub.add_parser('soak', help='主机上长时间循环播放/图片/停止，检查泄漏和碎片趋势')
+    p.add_argument('--src', required=True, help='源资源目录')
+    p.add_argument('--config', required=True, help='包含 anim_configs 的 xn_lottie_manager.c')
+    p.add_argument('--cycles', type=int, default=20000, help='循环次数（每次播放全部动画后停止）')
+    p.add_argument('--heap-kb', type=int, default=6144, help='PSRAM 堆模型大小 (KB)')
+    p.add_argument('--image', action='append', help='额外图片尺寸 WxH 或 WxHa（带透明度），可重复')
+    p.add_argument('--csv', help='写出每周期数据（用于绘图）')
+    p.add_argument('--cc', default=os.environ.get('CC', 'cc'), help='主机 C 编译器')
+    p.set_defaults(func=cmd_soak)
+    p = sub.add_parser('trace', help='从设备日志还原命令流并写出 .trace 文件')
+    p.add_argument('--log', required=True, help='设备日志（含 lottie_manager_trace_dump 输出）')
+    p.add_argument('--out', help='输出 .trace 文件')
+    p.add_argument('-v', '--verbose', action='store_true', help='列出每条命令')
+    p.set_defaults(func=cmd_trace)
+    p = sub.add_parser('modes', help='估算各显示渲染模式的帧率和显示缓冲区内存')
+    p.add_argument('--src', required=True, help='源资源目录')
+    p.add_argument('--config', required=True, help='包含 anim_configs 的 xn_lottie_manager.c')
+    p.add_argument('--model', default=COST_MODEL_FILE, help='代价模型系数')
+    p.add_argument('--screen', default='412x412', help='屏幕分辨率 WxH')
+    p.add_argument('--partial-div', type=int, default=20, help='部分缓冲模式缓冲区为屏幕的 1/N')
+    p.add_argument('--spi-mhz', type=int, default=60, help='QSPI 时钟 (ESP_PANEL_LCD_SPI_CLK_HZ)')
+    p.add_argument('--flush-us', type=int, default=40, help='每次刷屏的固定开销（窗口设置、排队、中断）')
+    p.add_argument('--refr-period-ms', type=int, default=REFR_PERIOD_MS,
+                   help='LVGL 刷新周期 (LV_DEF_REFR_PERIOD，默认取自 sdkconfig.defaults)')
+    p.set_defaults(func=cmd_modes)
+    p = sub.add_parser('flush', help='对比整块/分块刷屏的每区域耗时')
+    p.add_argument('--config', required=True, help='包含 anim_configs 的 xn_lottie_manager.c')
+    p.add_argument('--screen', default='412x412', help='屏幕分辨率 WxH')
+    p.add_argument('--partial-div', type=int, default=20, help='部分缓冲模式缓冲区为屏幕的 1/N')
+    p.add_argument('--chunk-kb', type=int, default=32, help='分块大小 (LVGL_FLUSH_CHUNK_BYTES / 1024)')
+    p.add_argument('--spi-mhz', type=int, default=60, help='QSPI 时钟 (ESP_PANEL_LCD_SPI_CLK_HZ)')
+    p.add_argument('--swap-px', type=float, default=DISPLAY_COSTS['swap_px'], help='字节交换耗时 (us/像素)')
+    p.add_argument('--flush-us', type=int, default=40, help='每次刷屏的固定开销（窗口设置、排队、中断）')
+    p.add_argument('--chunk-us', type=int, default=20, help='每多一块的窗口设置和中断开销')
+    p.add_argument('--handoff-us', type=int, default=10, help='区域交给刷屏任务的开销（任务通知、切换）')
+    p.add_argument('--refr-period-ms', type=int, default=REFR_PERIOD_MS,
+                   help='LVGL 刷新周期 (LV_DEF_REFR_PERIOD，默认取自 sdkconfig.defaults)')
+    p.set_defaults(func=cmd_flush)
+    p = sub.add_parser('kernels', help='主机上比对像素核参考实现与 LVGL 9.2 C 实现')
+    p.add_argument('--cc', default=os.environ.get('CC', 'cc'), help='主机 C 编译器')
+    p.set_defaults(func=cmd_kernels)
+    args = parser.parse_args()
+    if not hasattr(args, 'func'):
+        parser.print_help()
+        return 1
+    return args.func(args)
+
+
+if __name__ == '__main__':
+    sys.exit(main())
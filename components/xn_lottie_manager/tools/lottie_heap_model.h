@@ -0,0 +1,255 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Description: 主机基准共用的通用堆模型（lottie_arena_bench.c / lottie_soak_bench.c）
+ *
+ * 通用堆用简化的分级空闲链表+边界标记模型（与设备TLSF堆行为接近）；
+ * 另外模拟系统其他模块的分配（随机大小、存活若干周期），以及读取
+ * lottie_assets.py 按JSON结构生成的动画加载分配序列。
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// ---------------- 通用堆模型 ----------------
+
+#define HEAP_BINS       32
+#define HEAP_HDR        8
+#define HEAP_MIN_BLOCK  32
+#define HEAP_USED       1u
+
+typedef struct heap_block {
+    uint32_t size;              // 含块头，bit0为已用标志
+    uint32_t prev_size;         // 物理上前一块的大小
+    struct heap_block *next;    // 仅空闲块
+    struct heap_block *prev;
+} heap_block_t;
+
+static uint8_t *g_heap;
+static size_t g_heap_size;
+static heap_block_t *g_bins[HEAP_BINS];
+static uint32_t g_bin_bits;
+static uint32_t g_heap_live;    // 当前存活的分配数
+
+#define BLK_SIZE(b)     ((b)->size & ~HEAP_USED)
+#define BLK_NEXT(b)     ((heap_block_t *)((uint8_t *)(b) + BLK_SIZE(b)))
+
+static int heap_bin(uint32_t size)
+{
+    return 31 - __builtin_clz(size);
+}
+
+static void heap_bin_insert(heap_block_t *b)
+{
+    int i = heap_bin(BLK_SIZE(b));
+    b->prev = NULL;
+    b->next = g_bins[i];
+    if (b->next) {
+        b->next->prev = b;
+    }
+    g_bins[i] = b;
+    g_bin_bits |= 1u << i;
+}
+
+static void heap_bin_remove(heap_block_t *b)
+{
+    int i = heap_bin(BLK_SIZE(b));
+    if (b->prev) {
+        b->prev->next = b->next;
+    } else {
+        g_bins[i] = b->next;
+    }
+    if (b->next) {
+        b->next->prev = b->prev;
+    }
+    if (!g_bins[i]) {
+        g_bin_bits &= ~(1u << i);
+    }
+}
+
+static void heap_init(size_t size)
+{
+    g_heap_size = size & ~(size_t)7;
+    g_heap = malloc(g_heap_size);
+    memset(g_bins, 0, sizeof(g_bins));
+    g_bin_bits = 0;
+    g_heap_live = 0;
+
+    heap_block_t *b = (heap_block_t *)g_heap;
+    b->size = (uint32_t)(g_heap_size - HEAP_HDR);
+    b->prev_size = 0;
+    heap_block_t *end = BLK_NEXT(b);    // 结尾哨兵，始终为已用
+    end->size = HEAP_USED;
+    end->prev_size = BLK_SIZE(b);
+    heap_bin_insert(b);
+}
+
+static void *heap_alloc(size_t size)
+{
+    uint32_t need = (uint32_t)((size + HEAP_HDR + 7) & ~(size_t)7);
+    if (need < HEAP_MIN_BLOCK) {
+        need = HEAP_MIN_BLOCK;
+    }
+
+    // 先在同级中找前几个放得下的块，再从更高一级取第一个
+    heap_block_t *b = NULL;
+    int i = heap_bin(need);
+    int scan = 0;
+    for (heap_block_t *c = g_bins[i]; c && scan < 8; c = c->next, scan++) {
+        if (BLK_SIZE(c) >= need) {
+            b = c;
+            break;
+        }
+    }
+    if (!b) {
+        uint32_t bits = (i + 1 < HEAP_BINS) ? g_bin_bits & ~((2u << i) - 1) : 0;
+        if (!bits) {
+            return NULL;
+        }
+        b = g_bins[__builtin_ctz(bits)];
+    }
+    heap_bin_remove(b);
+
+    uint32_t size_b = BLK_SIZE(b);
+    if (size_b - need >= HEAP_MIN_BLOCK) {
+        heap_block_t *rest = (heap_block_t *)((uint8_t *)b + need);
+        rest->size = size_b - need;
+        rest->prev_size = need;
+        BLK_NEXT(rest)->prev_size = rest->size;
+        heap_bin_insert(rest);
+        size_b = need;
+    }
+    b->size = size_b | HEAP_USED;
+    g_heap_live++;
+    return (uint8_t *)b + HEAP_HDR;
+}
+
+static void heap_free(void *ptr)
+{
+    heap_block_t *b = (heap_block_t *)((uint8_t *)ptr - HEAP_HDR);
+    uint32_t size = BLK_SIZE(b);
+    g_heap_live--;
+
+    heap_block_t *next = (heap_block_t *)((uint8_t *)b + size);
+    if (!(next->size & HEAP_USED)) {
+        heap_bin_remove(next);
+        size += BLK_SIZE(next);
+    }
+    if (b->prev_size) {
+        heap_block_t *prev = (heap_block_t *)((uint8_t *)b - b->prev_size);
+        if (!(prev->size & HEAP_USED)) {
+            heap_bin_remove(prev);
+            size += BLK_SIZE(prev);
+            b = prev;
+        }
+    }
+    b->size = size;
+    BLK_NEXT(b)->prev_size = size;
+    heap_bin_insert(b);
+}
+
+static void heap_stats(size_t *free_bytes, size_t *largest, uint32_t *blocks)
+{
+    *free_bytes = 0;
+    *largest = 0;
+    *blocks = 0;
+    for (heap_block_t *b = (heap_block_t *)g_heap; b->size != HEAP_USED; b = BLK_NEXT(b)) {
+        if (!(b->size & HEAP_USED)) {
+            *free_bytes += BLK_SIZE(b);
+            *largest = BLK_SIZE(b) > *largest ? BLK_SIZE(b) : *largest;
+            (*blocks)++;
+        }
+    }
+}
+
+// ---------------- 分配序列 ----------------
+
+typedef struct {
+    uint8_t free;       // 0分配，1释放
+    uint32_t id;
+    uint32_t size;
+} trace_op_t;
+
+typedef struct {
+    trace_op_t *ops;
+    uint32_t op_count;
+    uint32_t id_count;          // 分配序号上限（id < id_count）
+} alloc_trace_t;
+
+// 读取分配序列：每行 "a <id> <size>" 或 "f <id>"
+static int alloc_trace_load(const char *path, alloc_trace_t *trace)
+{
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        perror(path);
+        return -1;
+    }
+
+    uint32_t cap = 1024;
+    memset(trace, 0, sizeof(*trace));
+    trace->ops = malloc(cap * sizeof(trace_op_t));
+    char kind;
+    unsigned id, size;
+    while (fscanf(f, " %c %u", &kind, &id) == 2) {
+        size = 0;
+        if (kind == 'a' && fscanf(f, " %u", &size) != 1) {
+            break;
+        }
+        if (trace->op_count == cap) {
+            cap *= 2;
+            trace->ops = realloc(trace->ops, cap * sizeof(trace_op_t));
+        }
+        trace->ops[trace->op_count++] = (trace_op_t){ .free = kind == 'f', .id = id, .size = size };
+        if (id + 1 > trace->id_count) {
+            trace->id_count = id + 1;
+        }
+    }
+    fclose(f);
+    return 0;
+}
+
+// ---------------- 系统其他模块的分配 ----------------
+
+#define NOISE_SLOTS     4096
+#define NOISE_EVERY     128     // 每多少次场景分配穿插一次
+#define NOISE_LIFE      64      // 最长存活周期
+
+typedef struct {
+    void *ptr;
+    uint32_t expire;
+} noise_t;
+
+static noise_t g_noise[NOISE_SLOTS];
+static uint32_t g_rng;
+
+static uint32_t rng_next(void)
+{
+    g_rng ^= g_rng << 13;
+    g_rng ^= g_rng >> 17;
+    g_rng ^= g_rng << 5;
+    return g_rng;
+}
+
+static void noise_alloc(uint32_t cycle)
+{
+    for (int i = 0; i < NOISE_SLOTS; i++) {
+        if (!g_noise[i].ptr) {
+            g_noise[i].ptr = heap_alloc(16 + rng_next() % 496);
+            g_noise[i].expire = cycle + 1 + rng_next() % NOISE_LIFE;
+            return;
+        }
+    }
+}
+
+static void noise_expire(uint32_t cycle)
+{
+    for (int i = 0; i < NOISE_SLOTS; i++) {
+        if (g_noise[i].ptr && g_noise[i].expire <= cycle) {
+            heap_free(g_noise[i].ptr);
+            g_noise[i].ptr = NULL;
+        }
+    }
+}
@@ -0,0 +1,380 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Description: 长时间运行碎片/泄漏主机基准（由 lottie_assets.py soak 编译并运行）
+ *
+ * 按管理器的PSRAM分配方式在通用堆模型（lottie_heap_model.h）上反复执行：
+ *   - 依次播放 anim_configs 中的每个动画：读入JSON、播放器、渲染缓冲区（宽×高×4）、
+ *     场景分配（src/xn_lottie_arena.c 的分区，超大分配或无分区时进入通用堆）、
+ *     拆分背景（临时加载后转换为RGB565A8，临时播放器销毁）；新动画发布后才销毁旧动画
+ *   - 显示/隐藏图片：与 xn_lottie_image_cache.c 相同的槽数、预算和LRU淘汰
+ *   - 停止动画
+ * 期间穿插系统其他模块的分配。每个周期结束后输出一行堆状态。
+ *
+ * 编译: cc -O2 -I../src lottie_soak_bench.c ../src/xn_lottie_arena.c
+ * 用法: lottie_soak_bench <plan> [cycles] [heap_kb] [seed]
+ * plan: 每行 "anim <名称> <宽> <高> <JSON字节> <分配序列> <背景JSON字节> <背景输出字节> <背景分配序列|->"
+ *       或 "image <名称> <字节>"
+ * 输出: 每周期一行 "<cycle> <free_kb> <largest_kb> <live_allocs> <buf_fail> <img_fail> <buf_largest_kb>"
+ *       前三项为停止动画后的堆状态，buf_largest_kb 为本周期申请渲染缓冲区前最大空闲块的最小值
+ */
+
+#include "xn_lottie_arena.h"
+#include "lottie_heap_model.h"
+
+// 图片缓存槽数和预算，lottie_assets.py 编译时从 xn_lottie_image_cache.h 读取后传入
+#ifndef LOTTIE_IMG_CACHE_SLOTS
+#define LOTTIE_IMG_CACHE_SLOTS      6
+#endif
+#ifndef LOTTIE_IMG_CACHE_BUDGET
+#define LOTTIE_IMG_CACHE_BUDGET     (1024 * 1024)
+#endif
+
+#define SOAK_MAX_ANIMS      32
+#define SOAK_MAX_IMAGES     16
+#define SOAK_NAME_MAX       64
+#define SOAK_PLAYER_SIZE    256     // lottie_player_t 及ThorVG画布/动画对象（约）
+
+typedef struct {
+    char name[SOAK_NAME_MAX];
+    uint32_t width;
+    uint32_t height;
+    uint32_t json_bytes;
+    alloc_trace_t scene;
+    uint32_t bg_json_bytes;         // 0表示没有拆分背景
+    uint32_t bg_out_bytes;
+    alloc_trace_t bg_scene;
+} soak_anim_t;
+
+typedef struct {
+    char name[SOAK_NAME_MAX];
+    uint32_t bytes;
+} soak_image_t;
+
+// 一次加载的场景（分配序号 -> 指针）
+typedef struct {
+    const alloc_trace_t *trace;
+    lottie_arena_t *arena;
+    void **ptrs;
+    uint8_t *in_arena;
+} soak_scene_t;
+
+typedef struct {
+    void *json;
+    void *player;
+    void *buf;
+    void *bg_out;
+    soak_scene_t scene;
+} soak_player_t;
+
+typedef struct {
+    int image;                      // -1 表示空槽
+    void *data;
+    uint32_t refcnt;
+    uint32_t last_used;
+} soak_img_slot_t;
+
+static soak_anim_t g_anims[SOAK_MAX_ANIMS];
+static int g_anim_count;
+static soak_image_t g_images[SOAK_MAX_IMAGES];
+static int g_image_count;
+
+static soak_img_slot_t g_slots[LOTTIE_IMG_CACHE_SLOTS];
+static size_t g_img_total;
+static uint32_t g_use_clock;
+
+static uint32_t g_tick;             // 操作计数，作为其他模块分配的存活时间单位
+static uint32_t g_scene_allocs;
+static uint32_t g_buf_fail;         // 渲染缓冲区分配失败（现场的症状）
+static size_t g_buf_largest;        // 本周期申请渲染缓冲区前的最大空闲块（最小值）
+static uint32_t g_img_fail;
+
+// ---------------- 动画 ----------------
+
+// 与 lottie_arena_bench.c 相同：每 NOISE_EVERY 次分配（含分区内）穿插一次其他模块的分配
+static void soak_count_alloc(void)
+{
+    if (++g_scene_allocs % NOISE_EVERY == 0) {
+        noise_alloc(g_tick);
+    }
+}
+
+static void *soak_alloc(size_t size)
+{
+    void *p = heap_alloc(size);
+    soak_count_alloc();
+    return p;
+}
+
+static void scene_load(soak_scene_t *scene, const alloc_trace_t *trace)
+{
+    scene->trace = trace;
+    scene->arena = lottie_arena_create();
+    scene->ptrs = calloc(trace->id_count, sizeof(void *));
+    scene->in_arena = calloc(trace->id_count, 1);
+
+    for (uint32_t i = 0; i < trace->op_count; i++) {
+        const trace_op_t *op = &trace->ops[i];
+        if (op->free) {
+            if (scene->in_arena[op->id]) {
+                lottie_arena_free(scene->ptrs[op->id]);
+            } else if (scene->ptrs[op->id]) {
+                heap_free(scene->ptrs[op->id]);
+            }
+            scene->ptrs[op->id] = NULL;
+            continue;
+        }
+        void *p = scene->arena ? lottie_arena_alloc(scene->arena, op->size) : NULL;
+        scene->in_arena[op->id] = p != NULL;
+        if (p) {
+            soak_count_alloc();
+        } else {
+            p = soak_alloc(op->size);
+        }
+        scene->ptrs[op->id] = p;
+    }
+}
+
+static void scene_unload(soak_scene_t *scene)
+{
+    if (!scene->trace) {
+        return;
+    }
+    if (scene->arena) {
+        lottie_arena_drop(scene->arena);
+    }
+    for (uint32_t id = 0; id < scene->trace->id_count; id++) {
+        if (!scene->ptrs[id]) {
+            continue;
+        }
+        if (scene->in_arena[id]) {
+            lottie_arena_free(scene->ptrs[id]);
+        } else {
+            heap_free(scene->ptrs[id]);
+        }
+    }
+    lottie_arena_destroy(scene->arena);
+    free(scene->ptrs);
+    free(scene->in_arena);
+    memset(scene, 0, sizeof(*scene));
+}
+
+static void player_destroy(soak_player_t *p)
+{
+    scene_unload(&p->scene);
+    void *blocks[] = { p->bg_out, p->buf, p->json, p->player };
+    for (size_t i = 0; i < sizeof(blocks) / sizeof(blocks[0]); i++) {
+        if (blocks[i]) {
+            heap_free(blocks[i]);
+        }
+    }
+    memset(p, 0, sizeof(*p));
+}
+
+// 与 lottie_player_load 相同的分配顺序，失败时释放已分配的部分
+static bool player_load(soak_player_t *p, uint32_t json_bytes, uint32_t w, uint32_t h,
+                        const alloc_trace_t *scene)
+{
+    memset(p, 0, sizeof(*p));
+    p->json = soak_alloc(json_bytes + 1);
+    p->player = soak_alloc(SOAK_PLAYER_SIZE);
+
+    size_t free_bytes, largest;
+    uint32_t blocks;
+    heap_stats(&free_bytes, &largest, &blocks);
+    g_buf_largest = largest < g_buf_largest ? largest : g_buf_largest;
+    p->buf = soak_alloc((size_t)w * h * 4);
+    if (!p->json || !p->player || !p->buf) {
+        g_buf_fail += p->json && p->player && !p->buf;
+        player_destroy(p);
+        return false;
+    }
+    scene_load(&p->scene, scene);
+    return true;
+}
+
+// 与 _lottie_load_job 相同：先加载动画部分，再临时加载背景并转换
+static bool anim_load(soak_player_t *p, const soak_anim_t *anim)
+{
+    if (!player_load(p, anim->json_bytes, anim->width, anim->height, &anim->scene)) {
+        return false;
+    }
+    if (anim->bg_json_bytes) {
+        soak_player_t bg;
+        if (player_load(&bg, anim->bg_json_bytes, anim->width, anim->height, &anim->bg_scene)) {
+            p->bg_out = soak_alloc(anim->bg_out_bytes);
+            player_destroy(&bg);
+        }
+        if (!p->bg_out) {
+            player_destroy(p);
+            return false;
+        }
+    }
+    return true;
+}
+
+// ---------------- 图片缓存 ----------------
+
+static soak_img_slot_t *img_find(int image)
+{
+    for (int i = 0; i < LOTTIE_IMG_CACHE_SLOTS; i++) {
+        if (g_slots[i].image == image) {
+            return &g_slots[i];
+        }
+    }
+    return NULL;
+}
+
+static void img_evict(soak_img_slot_t *slot)
+{
+    g_img_total -= g_images[slot->image].bytes;
+    heap_free(slot->data);
+    slot->image = -1;
+    slot->data = NULL;
+}
+
+// 与 img_slot_alloc 相同：超预算或无空槽时淘汰最久未用且未显示的槽
+static soak_img_slot_t *img_slot_alloc(size_t need)
+{
+    while (1) {
+        soak_img_slot_t *empty = NULL;
+        soak_img_slot_t *victim = NULL;
+        for (int i = 0; i < LOTTIE_IMG_CACHE_SLOTS; i++) {
+            soak_img_slot_t *s = &g_slots[i];
+            if (s->image < 0 && !empty) {
+                empty = s;
+            } else if (s->image >= 0 && s->refcnt == 0 && (!victim || s->last_used < victim->last_used)) {
+                victim = s;
+            }
+        }
+        if ((empty && g_img_total + need <= LOTTIE_IMG_CACHE_BUDGET) || !victim) {
+            return empty;
+        }
+        img_evict(victim);
+    }
+}
+
+static soak_img_slot_t *img_show(int image)
+{
+    soak_img_slot_t *slot = img_find(image);
+    if (!slot) {
+        slot = img_slot_alloc(g_images[image].bytes);
+        void *data = slot ? soak_alloc(g_images[image].bytes) : NULL;
+        if (!data) {
+            g_img_fail++;
+            return NULL;
+        }
+        slot->image = image;
+        slot->data = data;
+        slot->refcnt = 0;
+        g_img_total += g_images[image].bytes;
+    }
+    slot->refcnt++;
+    slot->last_used = ++g_use_clock;
+    return slot;
+}
+
+// ---------------- 基准 ----------------
+
+static int plan_load(const char *path)
+{
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        perror(path);
+        return -1;
+    }
+
+    char kind[16], scene_path[512], bg_path[512];
+    while (fscanf(f, "%15s", kind) == 1) {
+        if (strcmp(kind, "anim") == 0 && g_anim_count < SOAK_MAX_ANIMS) {
+            soak_anim_t *a = &g_anims[g_anim_count];
+            if (fscanf(f, "%63s %u %u %u %511s %u %u %511s", a->name, &a->width, &a->height,
+                       &a->json_bytes, scene_path, &a->bg_json_bytes, &a->bg_out_bytes, bg_path) != 8 ||
+                alloc_trace_load(scene_path, &a->scene) != 0 ||
+                (a->bg_json_bytes && alloc_trace_load(bg_path, &a->bg_scene) != 0)) {
+                break;
+            }
+            g_anim_count++;
+        } else if (strcmp(kind, "image") == 0 && g_image_count < SOAK_MAX_IMAGES) {
+            soak_image_t *img = &g_images[g_image_count];
+            if (fscanf(f, "%63s %u", img->name, &img->bytes) != 2) {
+                break;
+            }
+            g_image_count++;
+        } else {
+            fprintf(stderr, "%s: 无法识别的行 %s\n", path, kind);
+            break;
+        }
+    }
+    fclose(f);
+    return g_anim_count ? 0 : -1;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2) {
+        fprintf(stderr, "用法: %s <plan> [cycles] [heap_kb] [seed]\n", argv[0]);
+        return 2;
+    }
+    uint32_t cycles = argc > 2 ? (uint32_t)strtoul(argv[2], NULL, 0) : 20000;
+    size_t heap_size = (argc > 3 ? strtoul(argv[3], NULL, 0) : 6144) * 1024;
+    g_rng = argc > 4 ? (uint32_t)strtoul(argv[4], NULL, 0) : 0x12345678;
+    if (!g_rng) {
+        g_rng = 1;
+    }
+
+    if (plan_load(argv[1]) != 0) {
+        fprintf(stderr, "%s: 读取计划失败\n", argv[1]);
+        return 1;
+    }
+
+    size_t pool_size = (size_t)LOTTIE_ARENA_PAGES * LOTTIE_ARENA_PAGE_SIZE;
+    if (!lottie_arena_pool_init(malloc(pool_size), pool_size)) {
+        fprintf(stderr, "页池初始化失败\n");
+        return 1;
+    }
+    heap_init(heap_size);
+    for (int i = 0; i < LOTTIE_IMG_CACHE_SLOTS; i++) {
+        g_slots[i].image = -1;
+    }
+
+    soak_player_t current = { 0 };
+    soak_img_slot_t *shown = NULL;
+    for (uint32_t cycle = 0; cycle < cycles; cycle++) {
+        g_buf_largest = heap_size;
+        for (int i = 0; i < g_anim_count; i++) {
+            noise_expire(++g_tick);
+
+            // 新动画加载完成并发布后，旧动画才交给后台销毁
+            soak_player_t next;
+            if (anim_load(&next, &g_anims[i])) {
+                player_destroy(&current);
+                current = next;
+            }
+
+            if (g_image_count) {
+                // 切换图片时先显示新图片再释放旧图片的引用
+                soak_img_slot_t *slot = img_show((int)((cycle * g_anim_count + i) % g_image_count));
+                if (shown) {
+                    shown->refcnt--;
+                }
+                shown = slot;
+                if (i % 2) {
+                    if (shown) {
+                        shown->refcnt--;
+                    }
+                    shown = NULL;
+                }
+            }
+        }
+        player_destroy(&current);
+
+        size_t free_bytes, largest;
+        uint32_t blocks;
+        heap_stats(&free_bytes, &largest, &blocks);
+        printf("%u %zu %zu %u %u %u %zu\n", cycle, free_bytes / 1024, largest / 1024, g_heap_live,
+               g_buf_fail, g_img_fail, g_buf_largest / 1024);
+    }
+
+    free(g_heap);
+    return 0;
+}
@@ -0,0 +1,310 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Description: 像素核标量参考实现的主机测试（由 lottie_assets.py kernels 编译并运行）
+ *
+ * xn_lvgl_driver 的标量参考实现是设备上 PIE 自检的基准，必须与LVGL 9.2软件渲染的结果
+ * 逐位一致。这里把LVGL 9.2对应的C路径原样抄录（函数名加 lv92_ 前缀），逐像素比对：
+ *   swap  - lv_draw_sw_rgb565_swap（src/draw/sw/lv_draw_sw.c）
+ *   fill  - rgb565 纯色填充，不透明、无蒙版（src/draw/sw/blend/lv_draw_sw_blend_to_rgb565.c）
+ *   copy  - rgb565_image_blend，不透明、无蒙版、正常混合（同上）
+ *   blend - argb8888_image_blend，不透明、无蒙版、正常混合，lv_color_24_16_mix（同上）
+ * 混合对全部 256 级透明度 × 全部 65536 种目标颜色穷举，含透明度 0/255 的特殊路径。
+ * 同时检查行跨度之外的填充字节不被改写。
+ *
+ * 编译: cc -O2 -I../../xn_lvgl_driver/include lvgl_kernels_test.c ../../xn_lvgl_driver/src/xn_lvgl_kernels.c
+ * 输出: 每个核一行 "<kernel> ok <像素数>"，不一致时输出首个差异并返回 1
+ */
+
+#include "xn_lvgl_kernels.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TEST_MAX_W      72      // 覆盖设备自检和SIMD分派的对齐头、整块和尾部
+#define TEST_MAX_H      4
+#define TEST_PAD_PX     5       // 行尾填充（行跨度大于宽度）
+#define TEST_GUARD      0xA5
+
+// ---------------- LVGL 9.2 C 路径（抄录） ----------------
+
+static void lv92_rgb565_swap(void *buf, uint32_t buf_size_px)
+{
+    uint32_t u32_cnt = buf_size_px / 2;
+    uint16_t *buf16 = buf;
+    uint32_t *buf32 = buf;
+
+    while (u32_cnt >= 8) {
+        buf32[0] = ((buf32[0] & 0xff00ff00) >> 8) | ((buf32[0] & 0x00ff00ff) << 8);
+        buf32[1] = ((buf32[1] & 0xff00ff00) >> 8) | ((buf32[1] & 0x00ff00ff) << 8);
+        buf32[2] = ((buf32[2] & 0xff00ff00) >> 8) | ((buf32[2] & 0x00ff00ff) << 8);
+        buf32[3] = ((buf32[3] & 0xff00ff00) >> 8) | ((buf32[3] & 0x00ff00ff) << 8);
+        buf32[4] = ((buf32[4] & 0xff00ff00) >> 8) | ((buf32[4] & 0x00ff00ff) << 8);
+        buf32[5] = ((buf32[5] & 0xff00ff00) >> 8) | ((buf32[5] & 0x00ff00ff) << 8);
+        buf32[6] = ((buf32[6] & 0xff00ff00) >> 8) | ((buf32[6] & 0x00ff00ff) << 8);
+        buf32[7] = ((buf32[7] & 0xff00ff00) >> 8) | ((buf32[7] & 0x00ff00ff) << 8);
+        buf32 += 8;
+        u32_cnt -= 8;
+    }
+
+    while (u32_cnt) {
+        *buf32 = ((*buf32 & 0xff00ff00) >> 8) | ((*buf32 & 0x00ff00ff) << 8);
+        buf32++;
+        u32_cnt--;
+    }
+
+    if (buf_size_px & 0x1) {
+        uint32_t e = buf_size_px - 1;
+        buf16[e] = ((buf16[e] & 0xff00) >> 8) | ((buf16[e] & 0x00ff) << 8);
+    }
+}
+
+static void lv92_rgb565_fill(uint16_t *dest_buf_16, int32_t w, int32_t h, int32_t dest_stride,
+                             uint16_t color16)
+{
+    for (int32_t y = 0; y < h; y++) {
+        int32_t x = 0;
+        for (; x < (w & ~15); x += 16) {
+            dest_buf_16[x + 0] = color16;
+            dest_buf_16[x + 1] = color16;
+            dest_buf_16[x + 2] = color16;
+            dest_buf_16[x + 3] = color16;
+            dest_buf_16[x + 4] = color16;
+            dest_buf_16[x + 5] = color16;
+            dest_buf_16[x + 6] = color16;
+            dest_buf_16[x + 7] = color16;
+            dest_buf_16[x + 8] = color16;
+            dest_buf_16[x + 9] = color16;
+            dest_buf_16[x + 10] = color16;
+            dest_buf_16[x + 11] = color16;
+            dest_buf_16[x + 12] = color16;
+            dest_buf_16[x + 13] = color16;
+            dest_buf_16[x + 14] = color16;
+            dest_buf_16[x + 15] = color16;
+        }
+        for (; x < w; x++) {
+            dest_buf_16[x] = color16;
+        }
+        dest_buf_16 = (uint16_t *)((uint8_t *)dest_buf_16 + dest_stride);
+    }
+}
+
+static void lv92_rgb565_copy(uint16_t *dest_buf_u16, int32_t w, int32_t h, int32_t dest_stride,
+                             const uint16_t *src_buf_u16, int32_t src_stride)
+{
+    uint32_t line_in_bytes = w * 2;
+    for (int32_t y = 0; y < h; y++) {
+        memcpy(dest_buf_u16, src_buf_u16, line_in_bytes);
+        dest_buf_u16 = (uint16_t *)((uint8_t *)dest_buf_u16 + dest_stride);
+        src_buf_u16 = (const uint16_t *)((const uint8_t *)src_buf_u16 + src_stride);
+    }
+}
+
+static inline uint16_t lv92_color_24_16_mix(const uint8_t *c1, uint16_t c2, uint8_t mix)
+{
+    if (mix == 0) {
+        return c2;
+    } else if (mix == 255) {
+        return ((c1[2] & 0xF8) << 8) + ((c1[1] & 0xFC) << 3) + ((c1[0] & 0xF8) >> 3);
+    } else {
+        uint8_t mix_inv = 255 - mix;
+
+        return ((((c1[2] >> 3) * mix + ((c2 >> 11) & 0x1F) * mix_inv) << 3) & 0xF800) +
+               ((((c1[1] >> 2) * mix + ((c2 >> 5) & 0x3F) * mix_inv) >> 3) & 0x07E0) +
+               (((c1[0] >> 3) * mix + (c2 & 0x1F) * mix_inv) >> 8);
+    }
+}
+
+static void lv92_argb8888_blend(uint16_t *dest_buf_u16, int32_t w, int32_t h, int32_t dest_stride,
+                                const uint8_t *src_buf_c32, int32_t src_stride)
+{
+    for (int32_t y = 0; y < h; y++) {
+        for (int32_t x = 0; x < w; x++) {
+            const uint8_t *c = &src_buf_c32[x * 4];
+            dest_buf_u16[x] = lv92_color_24_16_mix(c, dest_buf_u16[x], c[3]);
+        }
+        dest_buf_u16 = (uint16_t *)((uint8_t *)dest_buf_u16 + dest_stride);
+        src_buf_c32 += src_stride;
+    }
+}
+
+// ---------------- 测试 ----------------
+
+static uint32_t g_rng = 0x2545F491;
+
+static uint32_t test_rand(void)
+{
+    g_rng ^= g_rng << 13;
+    g_rng ^= g_rng >> 17;
+    g_rng ^= g_rng << 5;
+    return g_rng;
+}
+
+static void fill_random(void *buf, size_t size)
+{
+    uint8_t *p = buf;
+    for (size_t i = 0; i < size; i++) {
+        p[i] = (uint8_t)test_rand();
+    }
+}
+
+static int report(const char *kernel, const void *a, const void *b, size_t size, int32_t w, int32_t h)
+{
+    const uint8_t *pa = a;
+    const uint8_t *pb = b;
+    for (size_t i = 0; i < size; i++) {
+        if (pa[i] != pb[i]) {
+            printf("%s FAIL w=%ld h=%ld 字节偏移 %zu: 参考 0x%02X, LVGL 0x%02X\n",
+                   kernel, (long)w, (long)h, i, pa[i], pb[i]);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static int test_swap(void)
+{
+    static uint16_t a[412 * 412], b[412 * 412];
+    uint64_t px_total = 0;
+
+    // 各种长度（奇偶、不足一个展开块），最后一次为整屏
+    for (uint32_t i = 0; i <= 70; i++) {
+        uint32_t px = i < 70 ? i : 412 * 412;
+        fill_random(a, sizeof(a));
+        memcpy(b, a, sizeof(a));
+        lvgl_kernel_swap_ref(a, px);
+        lv92_rgb565_swap(b, px);
+        if (report("swap", a, b, sizeof(a), (int32_t)px, 1)) {
+            return 1;
+        }
+        // 公共接口（主机上未启用SIMD，走参考实现）
+        memcpy(a, b, sizeof(a));
+        lvgl_kernel_rgb565_swap(a, px);
+        lv92_rgb565_swap(b, px);
+        if (report("swap", a, b, sizeof(a), (int32_t)px, 1)) {
+            return 1;
+        }
+        px_total += px * 2;
+    }
+    printf("swap ok %llu\n", (unsigned long long)px_total);
+    return 0;
+}
+
+static int test_fill_copy(void)
+{
+    const int32_t stride16 = (TEST_MAX_W + TEST_PAD_PX) * 2;
+    static uint16_t a[(TEST_MAX_W + TEST_PAD_PX) * TEST_MAX_H];
+    static uint16_t b[(TEST_MAX_W + TEST_PAD_PX) * TEST_MAX_H];
+    static uint16_t src[(TEST_MAX_W + TEST_PAD_PX + 3) * TEST_MAX_H];
+    uint64_t fill_px = 0, copy_px = 0;
+
+    for (int32_t h = 1; h <= TEST_MAX_H; h++) {
+        for (int32_t w = 1; w <= TEST_MAX_W; w++) {
+            for (int i = 0; i < 4; i++) {
+                uint16_t color = i == 0 ? 0x0000 : (i == 1 ? 0xFFFF : (uint16_t)test_rand());
+                memset(a, TEST_GUARD, sizeof(a));
+                memset(b, TEST_GUARD, sizeof(b));
+                lvgl_kernel_fill_ref(a, w, h, stride16, color);
+                lv92_rgb565_fill(b, w, h, stride16, color);
+                if (report("fill", a, b, sizeof(a), w, h)) {
+                    return 1;
+                }
+                fill_px += (uint64_t)w * h;
+            }
+
+            // 源行跨度与目标不同（多3像素）
+            const int32_t src_stride = stride16 + 6;
+            fill_random(src, sizeof(src));
+            memset(a, TEST_GUARD, sizeof(a));
+            memset(b, TEST_GUARD, sizeof(b));
+            lvgl_kernel_copy_ref(a, w, h, stride16, src, src_stride);
+            lv92_rgb565_copy(b, w, h, stride16, src, src_stride);
+            if (report("copy", a, b, sizeof(a), w, h)) {
+                return 1;
+            }
+            copy_px += (uint64_t)w * h;
+        }
+    }
+    printf("fill ok %llu\n", (unsigned long long)fill_px);
+    printf("copy ok %llu\n", (unsigned long long)copy_px);
+    return 0;
+}
+
+static int test_blend(void)
+{
+    // 穷举：每行为一级透明度，目标为全部 65536 种颜色，源颜色随机
+    const int32_t w = 65536;
+    uint16_t *a = malloc((size_t)w * 2);
+    uint16_t *b = malloc((size_t)w * 2);
+    uint8_t *src = malloc((size_t)w * 4);
+    uint64_t px_total = 0;
+    int ret = 0;
+
+    if (!a || !b || !src) {
+        printf("blend FAIL 内存不足\n");
+        ret = 1;
+        goto out;
+    }
+    for (uint32_t alpha = 0; alpha < 256 && !ret; alpha++) {
+        fill_random(src, (size_t)w * 4);
+        for (int32_t x = 0; x < w; x++) {
+            a[x] = (uint16_t)x;
+            src[x * 4 + 3] = (uint8_t)alpha;
+        }
+        memcpy(b, a, (size_t)w * 2);
+        lvgl_kernel_blend_ref(a, w, 1, w * 2, src, w * 4);
+        lv92_argb8888_blend(b, w, 1, w * 2, src, w * 4);
+        ret = report("blend", a, b, (size_t)w * 2, w, 1);
+        if (ret) {
+            printf("blend FAIL 透明度 %lu\n", (unsigned long)alpha);
+        }
+        px_total += w;
+    }
+
+    // 二维：不同宽度和行跨度，透明度随机（约一半为 0/255）
+    const int32_t stride16 = (TEST_MAX_W + TEST_PAD_PX) * 2;
+    const int32_t stride32 = (TEST_MAX_W + TEST_PAD_PX) * 4;
+    for (int32_t h = 1; h <= TEST_MAX_H && !ret; h++) {
+        for (int32_t bw = 1; bw <= TEST_MAX_W && !ret; bw++) {
+            fill_random(a, (size_t)stride16 * h);
+            memcpy(b, a, (size_t)stride16 * h);
+            fill_random(src, (size_t)stride32 * h);
+            for (size_t i = 3; i < (size_t)stride32 * h; i += 4) {
+                uint32_t r = test_rand() & 3;
+                src[i] = r == 0 ? 0 : (r == 1 ? 255 : src[i]);
+            }
+            lvgl_kernel_blend_ref(a, bw, h, stride16, src, stride32);
+            lv92_argb8888_blend(b, bw, h, stride16, src, stride32);
+            ret = report("blend", a, b, (size_t)stride16 * h, bw, h);
+            px_total += (uint64_t)bw * h;
+        }
+    }
+    if (!ret) {
+        printf("blend ok %llu\n", (unsigned long long)px_total);
+    }
+
+out:
+    free(a);
+    free(b);
+    free(src);
+    return ret;
+}
+
+int main(void)
+{
+    int fail = 0;
+    fail |= test_swap();
+    fail |= test_fill_copy();
+    fail |= test_blend();
+
+    // 主机上没有 SIMD 实现，分派接口应返回 false 交给 LVGL 自带实现
+    uint16_t px[16] = {0};
+    uint32_t argb[16] = {0};
+    if (lvgl_kernels_simd_enabled() ||
+        lvgl_kernel_fill_rgb565(px, 16, 1, 32, 0) ||
+        lvgl_kernel_copy_rgb565(px, 16, 1, 32, px, 32) ||
+        lvgl_kernel_blend_argb8888_rgb565(px, 16, 1, 32, argb, 64)) {
+        printf("dispatch FAIL 主机上不应启用 SIMD\n");
+        fail = 1;
+    }
+    return fail;
+}
@@ -28,14 +28,87 @@
  * 配置宏定义
  *********************/
 
-// LVGL Tick 定时器周期 (毫秒)
-// 【性能优化】调整为100ms（10 FPS）以降低CPU负载
-#define LVGL_TICK_PERIOD_MS     100
+// LVGL任务最长休眠时间 (毫秒)
+// LVGL时基直接读取 esp_timer_get_time()，任务按 lv_timer_handler 返回的时间休眠，
+// 期间可被 lvgl_driver_wakeup 提前唤醒；没有定时器就绪时最多休眠这么久
+#define LVGL_TASK_MAX_SLEEP_MS  500
+
+// 刷屏任务等待分块传输完成（背压）的超时 (毫秒)，超时视为完成中断丢失
+#define LVGL_FLUSH_THROTTLE_MS  100
+
+// 等待刷屏完成的超时 (毫秒)，超时视为完成中断丢失，避免LVGL任务死等；
+// 须大于背压超时加全部重试退避，否则刷屏任务仍在正常提交时就被当作超时
+#define LVGL_FLUSH_TIMEOUT_MS   250
+
+// 帧间隔统计：超过此间隔视为画面空闲，不计入帧间隔和抖动
+#define LVGL_FRAME_GAP_MS       500
+
+// 分块刷屏：每块的字节数（按整行向下取整，至少1行）
+// 区域交给刷屏任务按行分块发送，第N块DMA传输期间交换第N+1块的字节序；
+// 每块多一次窗口设置命令，过小反而变慢（对比: python tools/lottie_assets.py flush）
+#define LVGL_FLUSH_CHUNK_BYTES  (32 * 1024)
+
+// 刷屏背压：同时在传输中的分块上限，达到上限时刷屏任务等待完成中断再提交
+#define LVGL_FLUSH_MAX_INFLIGHT 2
+
+// 提交失败（SPI队列满、DMA缓冲区分配失败）时的重试次数，退避1、2、4…毫秒；
+// 仍失败时放弃剩余分块，在LVGL任务中重新失效该区域，下一帧重绘
+#define LVGL_FLUSH_RETRY_MAX    4
+
+// 脏区域合并（FULL 模式不使用）：新失效的区域与本帧已失效的区域合并后代价更低时合并，
+// 代价 = 刷屏次数 × 固定开销 + 像素数 × (每像素刷屏耗时 + 每像素渲染耗时)；
+// 固定开销和每像素刷屏耗时为初始值，运行时按实测的区域刷屏耗时拟合更新
+#define LVGL_COALESCE_SETUP_US      40      // 每次刷屏固定开销（窗口设置、DMA启动、中断）
+#define LVGL_COALESCE_FLUSH_PX_NS   70      // 每像素刷屏耗时（字节交换 + QSPI 60MHz 传输）
+#define LVGL_COALESCE_RENDER_PX_NS  14      // 每像素渲染耗时（填充、混合，不实测）
+#define LVGL_COALESCE_AREAS_MAX     16      // 每帧跟踪的脏区域数
+#define LVGL_COALESCE_FIT_SAMPLES   32      // 每次拟合使用的区域刷屏样本数
+
+// 同时登记的唤醒定时器数
+#define LVGL_WAKE_TIMERS_MAX    4
+
+// 调试：置1时 lvgl_driver_init 在像素核自检后输出参考/PIE 每像素周期数（lvgl_kernels_bench）
+#define LVGL_KERNELS_BENCH      0
+
+// 渲染模式（对比各模式的帧率和内存: python tools/lottie_assets.py modes）
+// PARTIAL: 两块1/20屏缓冲区，脏区域按条带渲染，每个条带单独刷屏（内存最少，条带多时刷屏次数多）
+// DIRECT:  两块整屏帧缓冲，只渲染脏区域（扩展为整行），一次刷屏；刷屏后脏区域由LVGL同步到另一块
+// FULL:    两块整屏帧缓冲，每帧整屏渲染并刷屏
+#define LVGL_RENDER_PARTIAL     0
+#define LVGL_RENDER_DIRECT      1
+#define LVGL_RENDER_FULL        2
+
+#define LVGL_RENDER_MODE        LVGL_RENDER_PARTIAL
 
 // LVGL 显示缓冲区大小 (像素数)
-// 【性能优化】设置为屏幕的1/10，减少刷新次数，降低CPU负载
-// 每次可刷新更多像素，减少刷新回调次数（内存增加约8.5KB PSRAM）
+// 【性能优化】部分缓冲设置为屏幕的1/20，减少刷新次数，降低CPU负载；直接/全屏模式为整屏
+#if LVGL_RENDER_MODE == LVGL_RENDER_PARTIAL
 #define LVGL_BUFFER_SIZE        (EXAMPLE_LCD_WIDTH * EXAMPLE_LCD_HEIGHT / 20)
+#else
+#define LVGL_BUFFER_SIZE        (EXAMPLE_LCD_WIDTH * EXAMPLE_LCD_HEIGHT)
+#endif
+
+// LVGL任务统计
+typedef struct {
+    uint32_t frames;            // 完整刷屏的帧数（不含空闲后的第一帧）
+    uint32_t frame_avg_us;      // 平均帧间隔（微秒）
+    uint32_t frame_max_us;      // 最大帧间隔（微秒）
+    uint32_t frame_jitter_us;   // 帧间隔抖动：相邻两个帧间隔之差的平均绝对值（微秒）
+    uint32_t wakeups;           // 任务唤醒次数
+    uint32_t early_wakeups;     // 其中被 lvgl_driver_wakeup 提前唤醒的次数
+    uint32_t busy_pct;          // LVGL任务占用率（%）：执行 lv_timer_handler 的时间（不含等待刷屏完成）
+    uint32_t flush_chunks;      // 提交的刷屏分块数
+    uint32_t flush_retries;     // 提交失败后重试的次数
+    uint32_t flush_drops;       // 重试后仍失败而放弃的分块数
+    uint32_t flush_reinvalidated; // 因放弃分块而重新失效的区域数
+    uint32_t flush_throttled;   // 传输中分块达到上限，刷屏任务等待的次数
+    uint32_t flush_timeouts;    // 背压等待超时（完成中断丢失），按一个分块已完成处理的次数
+    uint32_t render_throttled;  // 刷屏正在退避重试，LVGL任务推迟渲染的次数
+    uint32_t inflight_max;      // 同时在传输中的最大分块数
+    uint32_t areas_merged;      // 按代价模型合并的脏区域数
+    uint32_t cost_setup_us;     // 当前代价模型：每次刷屏固定开销（微秒）
+    uint32_t cost_px_ns;        // 当前代价模型：每像素刷屏耗时（纳秒）
+} lvgl_driver_stats_t;
 
 /*********************
  * 全局变量声明
@@ -63,10 +136,36 @@ esp_err_t lvgl_driver_init(void);
 void lvgl_driver_deinit(void);
 
 /**
- * @brief LVGL tick增加回调函数
- * @param arg 未使用的参数
+ * @brief 唤醒LVGL任务，立即处理登记的唤醒定时器并重新计算休眠时间（任意任务）
+ *
+ * 在其他任务中提交命令、修改LVGL对象后调用，无需等待当前休眠结束。
+ * 在LVGL任务自身中调用时直接返回。
  */
-void lvgl_tick_inc_cb(void *arg);
+void lvgl_driver_wakeup(void);
+
+/**
+ * @brief 唤醒LVGL任务（中断上下文）
+ * @param woken 输出是否唤醒了更高优先级的任务，中断退出时据此切换任务
+ */
+void lvgl_driver_wakeup_from_isr(BaseType_t *woken);
+
+/**
+ * @brief 登记唤醒定时器：LVGL任务被 lvgl_driver_wakeup 唤醒时立即运行该定时器
+ *
+ * 用于事件驱动的处理（如命令队列），定时器周期只作为兜底轮询。
+ * 需在LVGL上下文或持有 lv_lock 时调用。
+ *
+ * @param timer LVGL定时器
+ * @return ESP_OK 成功，ESP_ERR_NO_MEM 登记已满
+ */
+esp_err_t lvgl_driver_add_wake_timer(lv_timer_t *timer);
+
+/**
+ * @brief 获取LVGL任务统计（帧间隔、抖动、唤醒次数和占用率，调试用）
+ * @param stats 输出统计
+ * @param reset 读取后是否清零，便于分段对比
+ */
+void lvgl_driver_get_stats(lvgl_driver_stats_t *stats, bool reset);
 
 /**
  * @brief LVGL显示刷新回调函数
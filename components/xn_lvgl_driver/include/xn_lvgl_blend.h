@@ -0,0 +1,23 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Description: LVGL 软件渲染自定义混合钩子（CONFIG_LV_DRAW_SW_ASM_CUSTOM_INCLUDE="xn_lvgl_blend.h"）
+ *
+ * 由LVGL的 lv_draw_sw_blend_to_rgb565.c 包含，只在不透明、无蒙版、正常混合模式时调用；
+ * 返回 LV_RESULT_INVALID 时LVGL使用自带的C实现。
+ */
+
+#pragma once
+
+#include "xn_lvgl_kernels.h"
+
+#define LV_DRAW_SW_COLOR_BLEND_TO_RGB565(dsc) \
+    (lvgl_kernel_fill_rgb565((dsc)->dest_buf, (dsc)->dest_w, (dsc)->dest_h, (dsc)->dest_stride, \
+                             lv_color_to_u16((dsc)->color)) ? LV_RESULT_OK : LV_RESULT_INVALID)
+
+#define LV_DRAW_SW_RGB565_BLEND_NORMAL_TO_RGB565(dsc) \
+    (lvgl_kernel_copy_rgb565((dsc)->dest_buf, (dsc)->dest_w, (dsc)->dest_h, (dsc)->dest_stride, \
+                             (dsc)->src_buf, (dsc)->src_stride) ? LV_RESULT_OK : LV_RESULT_INVALID)
+
+#define LV_DRAW_SW_ARGB8888_BLEND_NORMAL_TO_RGB565(dsc) \
+    (lvgl_kernel_blend_argb8888_rgb565((dsc)->dest_buf, (dsc)->dest_w, (dsc)->dest_h, (dsc)->dest_stride, \
+                                       (dsc)->src_buf, (dsc)->src_stride) ? LV_RESULT_OK : LV_RESULT_INVALID)
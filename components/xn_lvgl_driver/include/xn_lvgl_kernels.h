@@ -0,0 +1,90 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Description: RGB565 像素核（字节交换、填充、不透明复制、ARGB8888 混合）
+ *
+ * 每个核有可移植的标量参考实现；ESP32-S3 上由 PIE 128位 SIMD 实现（xn_lvgl_kernels_s3.S），
+ * 初始化时与参考实现逐像素比对，结果不一致时不启用，改用LVGL自带的C实现。
+ * 填充、复制和混合通过 LV_DRAW_SW_ASM_CUSTOM 接入LVGL软件渲染（见 xn_lvgl_blend.h）。
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 每行宽度小于此值时直接用标量实现（对齐头尾的开销大于SIMD收益）
+#define LVGL_KERNEL_MIN_SIMD_PX     16
+
+#ifdef ESP_PLATFORM
+
+#include "esp_err.h"
+
+/**
+ * @brief 初始化像素核：在 PIE 可用时运行自检，通过后启用 SIMD 实现
+ * @return ESP_OK 已启用SIMD，ESP_ERR_NOT_SUPPORTED 目标不支持，ESP_FAIL 自检失败（使用标量实现）
+ */
+esp_err_t lvgl_kernels_init(void);
+
+/**
+ * @brief 对比参考实现和SIMD实现的每像素周期数，结果输出到日志（调试用，在PSRAM缓冲区上测量）
+ *
+ * xn_lvgl.h 中 LVGL_KERNELS_BENCH 置1时由 lvgl_driver_init 在自检后调用。
+ */
+void lvgl_kernels_bench(void);
+
+#endif
+
+/**
+ * @brief SIMD 实现是否已启用
+ */
+bool lvgl_kernels_simd_enabled(void);
+
+/**
+ * @brief RGB565 字节交换（原地）
+ * @param buf 像素缓冲区（2字节对齐）
+ * @param px 像素数
+ */
+void lvgl_kernel_rgb565_swap(void *buf, uint32_t px);
+
+/**
+ * @brief 纯色填充 RGB565 区域（不透明、无蒙版）
+ * @param dest 目标缓冲区
+ * @param w 宽度（像素）
+ * @param h 高度（行）
+ * @param stride 目标行跨度（字节）
+ * @param color RGB565 颜色
+ * @return true 已处理，false 未启用SIMD（由调用方使用C实现）
+ */
+bool lvgl_kernel_fill_rgb565(void *dest, int32_t w, int32_t h, int32_t stride, uint16_t color);
+
+/**
+ * @brief 不透明复制 RGB565 图像
+ * @return true 已处理，false 未启用SIMD
+ */
+bool lvgl_kernel_copy_rgb565(void *dest, int32_t w, int32_t h, int32_t dest_stride,
+                             const void *src, int32_t src_stride);
+
+/**
+ * @brief ARGB8888 图像按像素透明度混合到 RGB565（不含整体透明度和蒙版）
+ * @return true 已处理，false 未启用SIMD
+ */
+bool lvgl_kernel_blend_argb8888_rgb565(void *dest, int32_t w, int32_t h, int32_t dest_stride,
+                                       const void *src, int32_t src_stride);
+
+/*
+ * 标量参考实现（与LVGL 9.2 软件渲染的结果逐位一致）
+ */
+void lvgl_kernel_swap_ref(uint16_t *buf, uint32_t px);
+void lvgl_kernel_fill_ref(uint16_t *dest, int32_t w, int32_t h, int32_t stride, uint16_t color);
+void lvgl_kernel_copy_ref(uint16_t *dest, int32_t w, int32_t h, int32_t dest_stride,
+                          const uint16_t *src, int32_t src_stride);
+void lvgl_kernel_blend_ref(uint16_t *dest, int32_t w, int32_t h, int32_t dest_stride,
+                           const uint8_t *src, int32_t src_stride);
+
+#ifdef __cplusplus
+}
+#endif
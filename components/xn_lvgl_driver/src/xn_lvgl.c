@@ -7,8 +7,11 @@
  * @Description: LVGL 9.2.2 驱动实现 - 为ESP32S3 + SPD2010显示屏设计
  */
 
+#include <string.h>
 #include "xn_lvgl.h"
+#include "xn_lvgl_kernels.h"
 #include "bsp_panel_spd2010.h"
+#include "freertos/semphr.h"
 
 /*********************
  * 静态变量定义
@@ -20,9 +23,6 @@ static const char *TAG = "LVGL_DRIVER";
 lv_display_t *g_lvgl_display = NULL;
 lv_indev_t *g_lvgl_indev = NULL;
 
-// ESP定时器句柄
-static esp_timer_handle_t lvgl_tick_timer = NULL;
-
 // 显示缓冲区
 static uint8_t *lvgl_draw_buf1 = NULL;
 static uint8_t *lvgl_draw_buf2 = NULL;
@@ -35,32 +35,123 @@ static TaskHandle_t lvgl_task_handle = NULL;
 static EXT_RAM_BSS_ATTR StackType_t lvgl_task_stack[LVGL_TASK_STACK_SIZE];
 static StaticTask_t lvgl_task_buffer;
 
+// 刷屏完成信号（SPI中断给出，LVGL任务在 flush_wait_cb 中等待）
+static SemaphoreHandle_t lvgl_flush_sem = NULL;
+static StaticSemaphore_t lvgl_flush_sem_buffer;
+static volatile bool lvgl_flushing = false;
+static portMUX_TYPE lvgl_flush_lock = portMUX_INITIALIZER_UNLOCKED;
+static uint32_t lvgl_chunks_pending = 0;   // 当前区域已提交、尚未完成的分块数
+static uint32_t lvgl_inflight = 0;         // 已提交、尚未完成传输的分块数
+static SemaphoreHandle_t lvgl_slot_sem = NULL;  // 分块传输完成信号（背压等待）
+static StaticSemaphore_t lvgl_slot_sem_buffer;
+static volatile bool lvgl_flush_backoff = false;   // 刷屏任务正在退避重试
+// 刷屏请求/完成序号：不等时刷屏任务正在发送区域（交换字节序、提交分块）或即将开始；
+// 用序号而不是标志，区域在任务返回前就完成、LVGL已提交下一个请求时也不会误判为空闲
+static volatile uint32_t lvgl_flush_req_seq = 0;
+static volatile uint32_t lvgl_flush_done_seq = 0;
+static lv_area_t lvgl_reinv_area;          // 放弃发送、需重新失效的区域（多个时取并集）
+static bool lvgl_reinv_pending = false;
+
+#if LVGL_RENDER_MODE != LVGL_RENDER_FULL
+// 本帧已失效的区域（对齐、合并后），REFR_READY 时清空，在LVGL上下文中访问
+static lv_area_t lvgl_dirty_areas[LVGL_COALESCE_AREAS_MAX];
+static uint8_t lvgl_dirty_count = 0;
+#endif
+
+// 合并代价模型，由区域刷屏实测耗时拟合：耗时 = setup + px × px_ns
+static uint32_t lvgl_cost_setup_us = LVGL_COALESCE_SETUP_US;
+static uint32_t lvgl_cost_px_ns = LVGL_COALESCE_FLUSH_PX_NS;
+static int64_t lvgl_area_start_us = 0;     // 当前区域开始发送的时间
+static uint32_t lvgl_area_px = 0;
+static bool lvgl_area_sample = false;      // 当前区域未重试，可作为拟合样本
+static struct {
+    uint32_t n;
+    uint64_t sum_px;
+    uint64_t sum_us;
+    uint64_t sum_px2;
+    uint64_t sum_px_us;
+} lvgl_cost_fit;                           // 完成中断累加，lvgl_flush_lock 保护
+
+// 刷屏任务（核心0）：分块字节交换并提交传输，LVGL任务交出区域后继续渲染
+#define LVGL_FLUSH_TASK_STACK_SIZE (1024*4/sizeof(StackType_t))
+_Static_assert(LVGL_FLUSH_TIMEOUT_MS > LVGL_FLUSH_THROTTLE_MS + (1 << LVGL_FLUSH_RETRY_MAX),
+               "刷屏超时须大于背压超时加全部重试退避");
+static TaskHandle_t lvgl_flush_task_handle = NULL;
+static StackType_t lvgl_flush_task_stack[LVGL_FLUSH_TASK_STACK_SIZE];
+static StaticTask_t lvgl_flush_task_buffer;
+static struct {
+    lv_display_t *disp;
+    lv_area_t area;
+    uint8_t *px_map;
+} lvgl_flush_req;
+static int64_t lvgl_flush_wait_us = 0;     // 本轮 lv_timer_handler 中等待刷屏的时间
+
+#if LVGL_RENDER_MODE == LVGL_RENDER_DIRECT
+// 直接模式：帧缓冲中已字节交换、正在/刚刚发送的行，发送完成后需换回
+static uint8_t *lvgl_swapped_data = NULL;
+static uint32_t lvgl_swapped_px = 0;
+#endif
+
+// 被唤醒时立即运行的定时器
+static lv_timer_t *lvgl_wake_timers[LVGL_WAKE_TIMERS_MAX];
+static uint8_t lvgl_wake_timer_count = 0;
+
+// LVGL任务统计（LVGL任务写入，lvgl_driver_get_stats 读取）
+static portMUX_TYPE lvgl_stats_lock = portMUX_INITIALIZER_UNLOCKED;
+static struct {
+    uint32_t frames;
+    uint64_t frame_sum_us;
+    uint32_t frame_max_us;
+    uint64_t jitter_sum_us;
+    uint32_t jitter_count;
+    uint32_t wakeups;
+    uint32_t early_wakeups;
+    uint64_t busy_us;
+    uint32_t flush_chunks;
+    uint32_t flush_retries;
+    uint32_t flush_drops;
+    uint32_t flush_reinvalidated;
+    uint32_t flush_throttled;
+    uint32_t flush_timeouts;
+    uint32_t render_throttled;
+    uint32_t inflight_max;
+    uint32_t areas_merged;
+    int64_t window_start_us;
+} lvgl_stats;
+
+static int64_t lvgl_last_frame_us = 0;
+static uint32_t lvgl_last_interval_us = 0;
+
 /*********************
  * 静态函数声明
  *********************/
 
 static esp_err_t lvgl_display_init(void);
 static esp_err_t lvgl_indev_init(void);
-static esp_err_t lvgl_tick_timer_init(void);
 static esp_err_t lvgl_task_init(void);
 static void lvgl_cleanup_resources(void);
 static void lvgl_timer_task(void *pvParameters);
+static void lvgl_flush_task(void *pvParameters);
 
 /*********************
  * 回调函数实现
  *********************/
 
-void lvgl_tick_inc_cb(void *arg)
+/* LVGL时基：直接读取 esp_timer（微秒精度），不再依赖周期性的 tick 中断 */
+static uint32_t lvgl_tick_get_cb(void)
 {
-    lv_tick_inc(LVGL_TICK_PERIOD_MS);
+    return (uint32_t)(esp_timer_get_time() / 1000);
 }
 
-/* SPD2010区域对齐回调函数 - 处理4字节对齐要求 */
-static void lvgl_rounder_cb(lv_event_t *e)
+/* 按刷屏方式对齐区域 */
+static void lvgl_area_align(lv_area_t *area)
 {
-    (void)lv_event_get_target(e);  // 避免未使用变量警告
-    lv_area_t *area = lv_event_get_param(e);
-
+#if LVGL_RENDER_MODE == LVGL_RENDER_DIRECT
+    // 直接模式扩展为整行：脏区域在帧缓冲中连续，可直接发送；
+    // 不同脏区域不共用行，渲染下一个区域时不会改动正在发送的行
+    area->x1 = 0;
+    area->x2 = EXAMPLE_LCD_WIDTH - 1;
+#else
     // SPD2010需要4字节对齐
     uint16_t x1 = area->x1;
     uint16_t x2 = area->x2;
@@ -69,9 +160,304 @@ static void lvgl_rounder_cb(lv_event_t *e)
     area->x1 = (x1 >> 2) << 2;
     // 将结束坐标向上对齐到4N+3
     area->x2 = ((x2 >> 2) << 2) + 3;
+#endif
 }
 
-void lvgl_flush_cb(lv_display_t *disp, const lv_area_t *area, uint8_t *px_map)
+#if LVGL_RENDER_MODE != LVGL_RENDER_FULL
+/* 按代价模型估算刷新一个区域的耗时（纳秒） */
+static uint64_t lvgl_area_cost(const lv_area_t *area)
+{
+    uint32_t w = area->x2 - area->x1 + 1;
+    uint32_t h = area->y2 - area->y1 + 1;
+    uint32_t flushes = 1;
+#if LVGL_RENDER_MODE == LVGL_RENDER_PARTIAL
+    // 部分缓冲按条带渲染，每个条带刷屏一次
+    uint32_t rows = LVGL_BUFFER_SIZE / w;
+    if (rows == 0) {
+        rows = 1;
+    }
+    flushes = (h + rows - 1) / rows;
+#endif
+    return (uint64_t)flushes * lvgl_cost_setup_us * 1000 +
+           (uint64_t)w * h * (lvgl_cost_px_ns + LVGL_COALESCE_RENDER_PX_NS);
+}
+
+/* 与本帧已失效的区域合并：合并后的代价低于分别刷新时扩展为并集。
+ * 被并入的区域包含在新区域中，由LVGL刷新前的 lv_refr_join_area 去掉 */
+static void lvgl_area_coalesce(lv_area_t *area)
+{
+    while (1) {
+        int best = -1;
+        int64_t best_gain = 0;
+        uint64_t cost = lvgl_area_cost(area);
+        for (int i = 0; i < lvgl_dirty_count; i++) {
+            lv_area_t joined;
+            lv_area_join(&joined, area, &lvgl_dirty_areas[i]);
+            int64_t gain = (int64_t)(cost + lvgl_area_cost(&lvgl_dirty_areas[i])) -
+                           (int64_t)lvgl_area_cost(&joined);
+            if (gain > best_gain) {
+                best_gain = gain;
+                best = i;
+            }
+        }
+        if (best < 0) {
+            break;
+        }
+        // 并集可能与其他区域也值得合并，继续查找
+        lv_area_join(area, area, &lvgl_dirty_areas[best]);
+        lvgl_dirty_areas[best] = lvgl_dirty_areas[--lvgl_dirty_count];
+        portENTER_CRITICAL(&lvgl_stats_lock);
+        lvgl_stats.areas_merged++;
+        portEXIT_CRITICAL(&lvgl_stats_lock);
+    }
+
+    // 跟踪已满时不再合并之后的区域，由LVGL自行合并
+    if (lvgl_dirty_count < LVGL_COALESCE_AREAS_MAX) {
+        lvgl_dirty_areas[lvgl_dirty_count++] = *area;
+    }
+}
+#endif
+
+/* 区域失效回调：按SPD2010要求对齐，并按代价模型与本帧其他脏区域合并 */
+static void lvgl_rounder_cb(lv_event_t *e)
+{
+    (void)lv_event_get_target(e);  // 避免未使用变量警告
+    lv_area_t *area = lv_event_get_param(e);
+
+    // 其他任务中的修改（持有 lv_lock）需要唤醒LVGL任务尽快刷新
+    lvgl_driver_wakeup();
+
+    lvgl_area_align(area);
+#if LVGL_RENDER_MODE != LVGL_RENDER_FULL
+    lvgl_area_coalesce(area);
+#endif
+}
+
+/* 按实测的区域刷屏耗时拟合代价模型（最小二乘），样本尺寸差异太小时保留原值 */
+static void lvgl_cost_model_update(void)
+{
+    portENTER_CRITICAL(&lvgl_flush_lock);
+    if (lvgl_cost_fit.n < LVGL_COALESCE_FIT_SAMPLES) {
+        portEXIT_CRITICAL(&lvgl_flush_lock);
+        return;
+    }
+    double n = lvgl_cost_fit.n;
+    double sx = lvgl_cost_fit.sum_px;
+    double sy = lvgl_cost_fit.sum_us;
+    double sxx = lvgl_cost_fit.sum_px2;
+    double sxy = lvgl_cost_fit.sum_px_us;
+    memset(&lvgl_cost_fit, 0, sizeof(lvgl_cost_fit));
+    portEXIT_CRITICAL(&lvgl_flush_lock);
+
+    // 像素数标准差小于1000时斜率不可靠
+    double den = n * sxx - sx * sx;
+    if (den < n * n * 1000.0 * 1000.0) {
+        return;
+    }
+    double px_us = (n * sxy - sx * sy) / den;
+    double setup_us = (sy - px_us * sx) / n;
+    if (px_us <= 0 || setup_us < 0) {
+        return;
+    }
+    lvgl_cost_px_ns = (uint32_t)(px_us * 1000 + 0.5);
+    lvgl_cost_setup_us = (uint32_t)(setup_us + 0.5);
+    ESP_LOGD(TAG, "刷屏代价模型: %lu us + %lu ns/px", lvgl_cost_setup_us, lvgl_cost_px_ns);
+}
+
+/* 一帧刷新结束：清空本帧的脏区域，更新代价模型 */
+static void lvgl_refr_ready_cb(lv_event_t *e)
+{
+    (void)e;
+#if LVGL_RENDER_MODE != LVGL_RENDER_FULL
+    lvgl_dirty_count = 0;
+#endif
+    lvgl_cost_model_update();
+}
+
+/* 记录一帧刷屏结束的时间，统计帧间隔和抖动（LVGL任务） */
+static void lvgl_frame_done(void)
+{
+    int64_t now = esp_timer_get_time();
+    int64_t interval = lvgl_last_frame_us ? now - lvgl_last_frame_us : 0;
+    lvgl_last_frame_us = now;
+
+    // 画面空闲后的第一帧不计入：间隔取决于何时有新内容，而不是刷新节奏
+    if (interval <= 0 || interval > LVGL_FRAME_GAP_MS * 1000) {
+        lvgl_last_interval_us = 0;
+        return;
+    }
+
+    uint32_t interval_us = (uint32_t)interval;
+    portENTER_CRITICAL(&lvgl_stats_lock);
+    lvgl_stats.frames++;
+    lvgl_stats.frame_sum_us += interval_us;
+    if (interval_us > lvgl_stats.frame_max_us) {
+        lvgl_stats.frame_max_us = interval_us;
+    }
+    if (lvgl_last_interval_us) {
+        lvgl_stats.jitter_sum_us += interval_us > lvgl_last_interval_us ?
+                                    interval_us - lvgl_last_interval_us :
+                                    lvgl_last_interval_us - interval_us;
+        lvgl_stats.jitter_count++;
+    }
+    portEXIT_CRITICAL(&lvgl_stats_lock);
+    lvgl_last_interval_us = interval_us;
+}
+
+/* 分块传输完成回调（SPI中断上下文）：只有区域的最后一块完成时才通知LVGL */
+static bool lvgl_flush_done_isr(lv_display_t *disp)
+{
+    BaseType_t woken = pdFALSE;
+    bool last;
+
+    portENTER_CRITICAL_ISR(&lvgl_flush_lock);
+    if (lvgl_inflight > 0) {
+        lvgl_inflight--;
+    }
+    last = lvgl_chunks_pending > 0 && --lvgl_chunks_pending == 0;
+    if (last && lvgl_area_sample && lvgl_cost_fit.n < LVGL_COALESCE_FIT_SAMPLES) {
+        // 区域刷屏耗时样本（从开始字节交换到最后一块完成）
+        uint64_t us = esp_timer_get_time() - lvgl_area_start_us;
+        lvgl_cost_fit.n++;
+        lvgl_cost_fit.sum_px += lvgl_area_px;
+        lvgl_cost_fit.sum_us += us;
+        lvgl_cost_fit.sum_px2 += (uint64_t)lvgl_area_px * lvgl_area_px;
+        lvgl_cost_fit.sum_px_us += lvgl_area_px * us;
+    }
+    portEXIT_CRITICAL_ISR(&lvgl_flush_lock);
+    xSemaphoreGiveFromISR(lvgl_slot_sem, &woken);
+
+    // 最后一块完成：通知LVGL并唤醒在 flush_wait_cb 中等待的LVGL任务
+    if (last) {
+        lv_display_flush_ready(disp);
+        lvgl_flushing = false;
+        xSemaphoreGiveFromISR(lvgl_flush_sem, &woken);
+    }
+    return woken == pdTRUE;
+}
+
+/* 等待刷屏完成：阻塞在信号量上，不再忙等 flushing 标志 */
+static void lvgl_flush_wait_cb(lv_display_t *disp)
+{
+    (void)disp;
+    int64_t t0 = esp_timer_get_time();
+    while (lvgl_flushing) {
+        if (xSemaphoreTake(lvgl_flush_sem, pdMS_TO_TICKS(LVGL_FLUSH_TIMEOUT_MS)) != pdTRUE && lvgl_flushing) {
+            // 刷屏任务仍在交换或提交时缓冲区还在使用，不能交还LVGL：等它离开再判断
+            while (lvgl_flush_done_seq != lvgl_flush_req_seq) {
+                vTaskDelay(1);
+            }
+            if (!lvgl_flushing) {
+                continue;
+            }
+            ESP_LOGW(TAG, "等待刷屏完成超时(%dms)，视为已完成", LVGL_FLUSH_TIMEOUT_MS);
+            portENTER_CRITICAL(&lvgl_flush_lock);
+            lvgl_chunks_pending = 0;
+            lvgl_inflight = 0;
+            portEXIT_CRITICAL(&lvgl_flush_lock);
+            lvgl_flushing = false;
+        }
+    }
+    lvgl_flush_wait_us += esp_timer_get_time() - t0;
+}
+
+#if LVGL_RENDER_MODE == LVGL_RENDER_DIRECT
+/* 直接模式：等上一次发送完成后把帧缓冲中交换过的行换回，
+ * 帧缓冲需保持LVGL格式（未刷新区域保留、刷屏后同步到另一块缓冲区） */
+static void lvgl_direct_restore(void)
+{
+    if (!lvgl_swapped_data) {
+        return;
+    }
+    lvgl_flush_wait_cb(g_lvgl_display);
+    lvgl_kernel_rgb565_swap(lvgl_swapped_data, lvgl_swapped_px);
+    lvgl_swapped_data = NULL;
+}
+
+/* 刷新开始（同步脏区域、渲染之前）换回上一帧最后发送的行 */
+static void lvgl_refr_start_cb(lv_event_t *e)
+{
+    (void)e;
+    lvgl_direct_restore();
+}
+#endif
+
+/* 背压：传输中的分块达到上限时等待完成中断（刷屏任务） */
+static void lvgl_flush_throttle(void)
+{
+    bool throttled = false;
+    while (1) {
+        portENTER_CRITICAL(&lvgl_flush_lock);
+        bool full = lvgl_inflight >= LVGL_FLUSH_MAX_INFLIGHT;
+        portEXIT_CRITICAL(&lvgl_flush_lock);
+        if (!full) {
+            break;
+        }
+        throttled = true;
+        if (xSemaphoreTake(lvgl_slot_sem, pdMS_TO_TICKS(LVGL_FLUSH_THROTTLE_MS)) != pdTRUE) {
+            // 一次超时只视为丢失一个完成中断：只让出一个名额，其余分块可能仍在SPI队列中
+            portENTER_CRITICAL(&lvgl_flush_lock);
+            if (lvgl_inflight > 0) {
+                lvgl_inflight--;
+            }
+            portEXIT_CRITICAL(&lvgl_flush_lock);
+            portENTER_CRITICAL(&lvgl_stats_lock);
+            lvgl_stats.flush_timeouts++;
+            portEXIT_CRITICAL(&lvgl_stats_lock);
+        }
+    }
+    if (throttled) {
+        portENTER_CRITICAL(&lvgl_stats_lock);
+        lvgl_stats.flush_throttled++;
+        portEXIT_CRITICAL(&lvgl_stats_lock);
+    }
+}
+
+/* 提交一个分块，失败时退避重试（刷屏任务） */
+static esp_err_t lvgl_flush_submit(esp_lcd_panel_handle_t panel_handle, int x1, int y1, int x2, int y2, const void *data)
+{
+    esp_err_t ret = ESP_FAIL;
+    for (int attempt = 0; attempt <= LVGL_FLUSH_RETRY_MAX; attempt++) {
+        if (attempt > 0) {
+            // 退避期间队列中的传输继续完成；LVGL任务推迟渲染，避免渲染出发不出去的帧
+            lvgl_flush_backoff = true;
+            lvgl_area_sample = false;
+            portENTER_CRITICAL(&lvgl_stats_lock);
+            lvgl_stats.flush_retries++;
+            portEXIT_CRITICAL(&lvgl_stats_lock);
+            TickType_t backoff = pdMS_TO_TICKS(1 << (attempt - 1));
+            vTaskDelay(backoff ? backoff : 1);
+        }
+        lvgl_flush_throttle();
+
+        portENTER_CRITICAL(&lvgl_flush_lock);
+        uint32_t inflight = ++lvgl_inflight;
+        portEXIT_CRITICAL(&lvgl_flush_lock);
+
+        // 前一块仍在传输时，esp_lcd 先等它完成再发送窗口设置命令和这一块
+        ret = esp_lcd_panel_draw_bitmap(panel_handle, x1, y1, x2, y2, data);
+        if (ret == ESP_OK) {
+            portENTER_CRITICAL(&lvgl_stats_lock);
+            lvgl_stats.flush_chunks++;
+            if (inflight > lvgl_stats.inflight_max) {
+                lvgl_stats.inflight_max = inflight;
+            }
+            portEXIT_CRITICAL(&lvgl_stats_lock);
+            break;
+        }
+
+        // 提交失败不会触发完成中断
+        portENTER_CRITICAL(&lvgl_flush_lock);
+        lvgl_inflight--;
+        portEXIT_CRITICAL(&lvgl_flush_lock);
+    }
+    lvgl_flush_backoff = false;
+    return ret;
+}
+
+/* 分块发送一个刷屏区域（刷屏任务）：每块交换字节序后立即提交，
+ * 下一块的交换与这一块的DMA传输重叠，最后一块完成时由中断通知LVGL */
+static void lvgl_flush_chunks(lv_display_t *disp, const lv_area_t *area, uint8_t *px_map)
 {
     esp_lcd_panel_handle_t panel_handle = lv_display_get_user_data(disp);
     int offsetx1 = area->x1;
@@ -79,9 +465,88 @@ void lvgl_flush_cb(lv_display_t *disp, const lv_area_t *area, uint8_t *px_map)
     int offsety1 = area->y1;
     int offsety2 = area->y2;
 
+    // 按整行分块
+    int width = offsetx2 + 1 - offsetx1;
+    int chunk_rows = LVGL_FLUSH_CHUNK_BYTES / (width * 2);
+    if (chunk_rows < 1) {
+        chunk_rows = 1;
+    }
+    uint32_t chunks = (offsety2 - offsety1 + chunk_rows) / chunk_rows;
+
+    portENTER_CRITICAL(&lvgl_flush_lock);
+    lvgl_chunks_pending = chunks;
+    lvgl_area_start_us = esp_timer_get_time();
+    lvgl_area_px = (uint32_t)width * (offsety2 + 1 - offsety1);
+    lvgl_area_sample = true;
+    portEXIT_CRITICAL(&lvgl_flush_lock);
+
+    uint8_t *chunk = px_map;
+    uint32_t queued = 0;
+    for (int y = offsety1; y <= offsety2; y += chunk_rows) {
+        int rows = offsety2 + 1 - y < chunk_rows ? offsety2 + 1 - y : chunk_rows;
+        uint32_t chunk_px = (uint32_t)width * rows;
+
+        // SPD2010是大端序，需要交换RGB字节顺序（全屏模式每帧整屏重绘，交换后无需换回）
+        lvgl_kernel_rgb565_swap(chunk, chunk_px);
+#if LVGL_RENDER_MODE == LVGL_RENDER_DIRECT
+        lvgl_swapped_px += chunk_px;
+#endif
+
+        esp_err_t ret = lvgl_flush_submit(panel_handle, offsetx1, y, offsetx2 + 1, y + rows, chunk);
+
+        // 重试后仍失败：放弃剩余分块并完成本区域（不完成LVGL会死锁），
+        // 未发送的行交给LVGL任务重新失效，下一帧重绘，屏幕上不会留下旧内容
+        if (ret != ESP_OK) {
+            ESP_LOGW(TAG, "⚠️  SPI传输失败(%s)，区域剩余 %lu 块重新失效", esp_err_to_name(ret), chunks - queued);
+            lv_area_t failed = { offsetx1, y, offsetx2, offsety2 };
+            portENTER_CRITICAL(&lvgl_flush_lock);
+            if (lvgl_reinv_pending) {
+                lv_area_join(&lvgl_reinv_area, &lvgl_reinv_area, &failed);
+            } else {
+                lvgl_reinv_area = failed;
+                lvgl_reinv_pending = true;
+            }
+            lvgl_chunks_pending -= chunks - queued;
+            bool done = lvgl_chunks_pending == 0;
+            portEXIT_CRITICAL(&lvgl_flush_lock);
+
+            portENTER_CRITICAL(&lvgl_stats_lock);
+            lvgl_stats.flush_drops += chunks - queued;
+            lvgl_stats.flush_reinvalidated++;
+            portEXIT_CRITICAL(&lvgl_stats_lock);
+
+            if (done) {
+                lv_display_flush_ready(disp);
+                lvgl_flushing = false;
+                xSemaphoreGive(lvgl_flush_sem);
+            }
+            lvgl_driver_wakeup();
+            return;
+        }
+        queued++;
+        chunk += chunk_px * 2;
+    }
+    // 正常情况下，由最后一块的传输完成中断 lvgl_flush_done_isr() 调用 lv_display_flush_ready()
+}
+
+void lvgl_flush_cb(lv_display_t *disp, const lv_area_t *area, uint8_t *px_map)
+{
+    int offsetx1 = area->x1;
+    int offsetx2 = area->x2;
+    int offsety1 = area->y1;
+    int offsety2 = area->y2;
+
     // 计算刷新像素数量
     uint32_t pixel_count = (offsetx2 + 1 - offsetx1) * (offsety2 + 1 - offsety1);
 
+#if LVGL_RENDER_MODE == LVGL_RENDER_DIRECT
+    // px_map 为整屏帧缓冲，脏区域已由 lvgl_rounder_cb 扩展为整行
+    lvgl_direct_restore();
+    px_map += (size_t)offsety1 * EXAMPLE_LCD_WIDTH * 2;
+    lvgl_swapped_data = px_map;
+    lvgl_swapped_px = 0;
+#endif
+
     // 调试：打印刷新信息（仅前几次）
     static int flush_count = 0;
     if (flush_count < 5) {
@@ -90,19 +555,17 @@ void lvgl_flush_cb(lv_display_t *disp, const lv_area_t *area, uint8_t *px_map)
         flush_count++;
     }
 
-    // SPD2010是大端序，需要交换RGB字节顺序
-    lv_draw_sw_rgb565_swap(px_map, pixel_count);
-
-    // 将缓冲区内容复制到显示屏的指定区域
-    esp_err_t ret = esp_lcd_panel_draw_bitmap(panel_handle, offsetx1, offsety1, offsetx2 + 1, offsety2 + 1, px_map);
-
-    // 关键修复：检查返回值，如果失败立即通知LVGL
-    // 原因：SPI队列满时传输失败，中断不会触发，必须手动清除flushing标志，否则死锁
-    if (ret != ESP_OK) {
-        ESP_LOGW(TAG, "⚠️  SPI传输失败(队列满?)，立即通知LVGL");
-        lv_display_flush_ready(disp);
+    if (lv_display_flush_is_last(disp)) {
+        lvgl_frame_done();
     }
-    // 正常情况下，由硬件中断回调 notify_lvgl_flush_ready() 调用 lv_display_flush_ready()
+
+    // 交给刷屏任务：LVGL在 flush_ready 之前不会再次调用 flush_cb，请求无需排队
+    lvgl_flush_req_seq++;
+    lvgl_flushing = true;
+    lvgl_flush_req.disp = disp;
+    lvgl_flush_req.area = *area;
+    lvgl_flush_req.px_map = px_map;
+    xTaskNotifyGive(lvgl_flush_task_handle);
 }
 
 
@@ -162,8 +625,18 @@ static esp_err_t lvgl_display_init(void)
     }
 
     // 设置显示缓冲区 - LVGL9中buffer_size参数是字节数
-    lv_display_set_buffers(g_lvgl_display, lvgl_draw_buf1, lvgl_draw_buf2,
-                           buffer_size, LV_DISPLAY_RENDER_MODE_PARTIAL);
+#if LVGL_RENDER_MODE == LVGL_RENDER_DIRECT
+    const lv_display_render_mode_t render_mode = LV_DISPLAY_RENDER_MODE_DIRECT;
+    const char *mode_name = "direct";
+#elif LVGL_RENDER_MODE == LVGL_RENDER_FULL
+    const lv_display_render_mode_t render_mode = LV_DISPLAY_RENDER_MODE_FULL;
+    const char *mode_name = "full";
+#else
+    const lv_display_render_mode_t render_mode = LV_DISPLAY_RENDER_MODE_PARTIAL;
+    const char *mode_name = "partial";
+#endif
+    lv_display_set_buffers(g_lvgl_display, lvgl_draw_buf1, lvgl_draw_buf2, buffer_size, render_mode);
+    ESP_LOGI(TAG, "渲染模式: %s, 显示缓冲区 2 x %u KB (PSRAM)", mode_name, (unsigned)(buffer_size / 1024));
 
     // 设置颜色格式为RGB565（与SPD2010匹配）
     lv_display_set_color_format(g_lvgl_display, LV_COLOR_FORMAT_RGB565);
@@ -171,6 +644,11 @@ static esp_err_t lvgl_display_init(void)
     // 设置刷新回调
     lv_display_set_flush_cb(g_lvgl_display, lvgl_flush_cb);
 
+    // 刷屏完成由SPI中断通过信号量通知，等待期间LVGL任务让出CPU
+    lvgl_flush_sem = xSemaphoreCreateBinaryStatic(&lvgl_flush_sem_buffer);
+    lvgl_slot_sem = xSemaphoreCreateBinaryStatic(&lvgl_slot_sem_buffer);
+    lv_display_set_flush_wait_cb(g_lvgl_display, lvgl_flush_wait_cb);
+
     // 获取官方组件的面板句柄
     esp_lcd_panel_handle_t official_panel = SPD2010_Get_Panel_Handle();
     if (!official_panel) {
@@ -181,8 +659,12 @@ static esp_err_t lvgl_display_init(void)
     // 设置用户数据 (LCD面板句柄)
     lv_display_set_user_data(g_lvgl_display, official_panel);
 
-    // 注册区域对齐回调 - 处理SPD2010的4字节对齐要求
+    // 注册区域对齐回调 - 处理SPD2010的4字节对齐要求，按代价模型合并脏区域
     lv_display_add_event_cb(g_lvgl_display, lvgl_rounder_cb, LV_EVENT_INVALIDATE_AREA, NULL);
+    lv_display_add_event_cb(g_lvgl_display, lvgl_refr_ready_cb, LV_EVENT_REFR_READY, NULL);
+#if LVGL_RENDER_MODE == LVGL_RENDER_DIRECT
+    lv_display_add_event_cb(g_lvgl_display, lvgl_refr_start_cb, LV_EVENT_REFR_START, NULL);
+#endif
 
     // 注册官方组件的硬件完成回调
     esp_err_t ret = SPD2010_Register_LVGL_Callback(g_lvgl_display);
@@ -190,6 +672,7 @@ static esp_err_t lvgl_display_init(void)
         ESP_LOGE(TAG, "Failed to register LVGL callback");
         return ret;
     }
+    SPD2010_Set_Flush_Done_Hook(lvgl_flush_done_isr);
 
     ESP_LOGI(TAG, "LVGL display initialized successfully");
     return ESP_OK;
@@ -214,59 +697,92 @@ static esp_err_t lvgl_indev_init(void)
     return ESP_OK;
 }
 
-static esp_err_t lvgl_tick_timer_init(void)
+static void lvgl_timer_task(void *pvParameters)
 {
-    ESP_LOGI(TAG, "Initializing LVGL tick timer");
+    ESP_LOGI(TAG, "LVGL timer task started");
 
-    // 创建定时器配置
-    const esp_timer_create_args_t timer_args = {
-        .callback = lvgl_tick_inc_cb,
-        .name = "lvgl_tick"
-    };
+    while (1) {
+        // 刷屏任务放弃发送的区域重新失效（区域失效需在LVGL上下文中）
+        portENTER_CRITICAL(&lvgl_flush_lock);
+        bool reinv = lvgl_reinv_pending;
+        lv_area_t reinv_area = lvgl_reinv_area;
+        lvgl_reinv_pending = false;
+        portEXIT_CRITICAL(&lvgl_flush_lock);
+        if (reinv) {
+            lv_lock();
+            lv_inv_area(g_lvgl_display, &reinv_area);
+            lv_unlock();
+        }
 
-    // 创建定时器
-    esp_err_t ret = esp_timer_create(&timer_args, &lvgl_tick_timer);
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to create tick timer: %s", esp_err_to_name(ret));
-        return ret;
-    }
+        // 刷屏正在退避重试：等它结束再渲染，避免渲染出发不出去的帧
+        if (lvgl_flush_backoff) {
+            portENTER_CRITICAL(&lvgl_stats_lock);
+            lvgl_stats.render_throttled++;
+            portEXIT_CRITICAL(&lvgl_stats_lock);
+            lvgl_flush_wait_cb(g_lvgl_display);
+        }
 
-    // 启动定时器
-    ret = esp_timer_start_periodic(lvgl_tick_timer, LVGL_TICK_PERIOD_MS * 1000);
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to start tick timer: %s", esp_err_to_name(ret));
-        esp_timer_delete(lvgl_tick_timer);
-        lvgl_tick_timer = NULL;
-        return ret;
-    }
+        // 调用LVGL定时器处理函数
+        int64_t t0 = esp_timer_get_time();
+        lvgl_flush_wait_us = 0;
+        uint32_t delay_ms = lv_timer_handler();
+        int64_t busy = esp_timer_get_time() - t0 - lvgl_flush_wait_us;
 
-    ESP_LOGI(TAG, "LVGL tick timer started successfully");
-    return ESP_OK;
+        // 按下一个定时器的到期时间休眠（向上取整到系统节拍，至少1个节拍）
+        if (delay_ms == LV_NO_TIMER_READY || delay_ms > LVGL_TASK_MAX_SLEEP_MS) {
+            delay_ms = LVGL_TASK_MAX_SLEEP_MS;
+        }
+        TickType_t ticks = (delay_ms * configTICK_RATE_HZ + 999) / 1000;
+        if (ticks == 0) {
+            ticks = 1;
+        }
+        bool early = ulTaskNotifyTake(pdTRUE, ticks) > 0;
+
+        portENTER_CRITICAL(&lvgl_stats_lock);
+        lvgl_stats.busy_us += busy;
+        lvgl_stats.wakeups++;
+        lvgl_stats.early_wakeups += early;
+        portEXIT_CRITICAL(&lvgl_stats_lock);
+
+        // 被提前唤醒：登记的定时器不等周期，在本轮 lv_timer_handler 中立即运行
+        if (early && lvgl_wake_timer_count) {
+            lv_lock();
+            for (uint8_t i = 0; i < lvgl_wake_timer_count; i++) {
+                lv_timer_ready(lvgl_wake_timers[i]);
+            }
+            lv_unlock();
+        }
+    }
 }
 
-static void lvgl_timer_task(void *pvParameters)
+static void lvgl_flush_task(void *pvParameters)
 {
-    ESP_LOGI(TAG, "LVGL timer task started");
-    
     while (1) {
-        // 调用LVGL定时器处理函数
-        uint32_t delay_ms = lv_timer_handler();
-        
-        // 动态延时，平衡性能和功耗
-        if (delay_ms == LV_NO_TIMER_READY) {
-            // 无定时器时等待200ms
-            vTaskDelay(pdMS_TO_TICKS(200));
-        } else if (delay_ms < 20) {
-            vTaskDelay(pdMS_TO_TICKS(20));
-        } else {
-            delay_ms = 100;
-            vTaskDelay(pdMS_TO_TICKS(delay_ms));
-        }
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        uint32_t seq = lvgl_flush_req_seq;
+        lvgl_flush_chunks(lvgl_flush_req.disp, &lvgl_flush_req.area, lvgl_flush_req.px_map);
+        lvgl_flush_done_seq = seq;
     }
 }
 
 static esp_err_t lvgl_task_init(void)
 {
+    // 刷屏任务在另一个核心上交换字节序，与LVGL任务渲染下一块并行
+    lvgl_flush_task_handle = xTaskCreateStaticPinnedToCore(
+                                 lvgl_flush_task,
+                                 "lvgl_flush",
+                                 LVGL_FLUSH_TASK_STACK_SIZE,
+                                 NULL,
+                                 8,                             // 高于LVGL任务，尽快提交下一块
+                                 lvgl_flush_task_stack,         // 栈数组(内部RAM)
+                                 &lvgl_flush_task_buffer,
+                                 0                              // 核心0
+                             );
+    if (lvgl_flush_task_handle == NULL) {
+        ESP_LOGE(TAG, "Failed to create LVGL flush task");
+        return ESP_FAIL;
+    }
+
     ESP_LOGI(TAG, "Creating LVGL timer task");
     
     lvgl_task_handle = xTaskCreateStaticPinnedToCore(
@@ -291,12 +807,19 @@ static esp_err_t lvgl_task_init(void)
 
 static void lvgl_cleanup_resources(void)
 {
-    // 停止并删除定时器
-    if (lvgl_tick_timer) {
-        esp_timer_stop(lvgl_tick_timer);
-        esp_timer_delete(lvgl_tick_timer);
-        lvgl_tick_timer = NULL;
+    // 取消刷屏完成回调
+    SPD2010_Set_Flush_Done_Hook(NULL);
+    if (lvgl_flush_task_handle) {
+        vTaskDelete(lvgl_flush_task_handle);
+        lvgl_flush_task_handle = NULL;
     }
+    lvgl_wake_timer_count = 0;
+#if LVGL_RENDER_MODE == LVGL_RENDER_DIRECT
+    lvgl_swapped_data = NULL;
+#endif
+#if LVGL_RENDER_MODE != LVGL_RENDER_FULL
+    lvgl_dirty_count = 0;
+#endif
 
     // 删除输入设备
     if (g_lvgl_indev) {
@@ -335,6 +858,14 @@ esp_err_t lvgl_driver_init(void)
 
     // 初始化LVGL库
     lv_init();
+    lv_tick_set_cb(lvgl_tick_get_cb);
+
+    // 像素核自检（ESP32-S3 启用 PIE SIMD，失败时使用标量实现，不影响初始化）
+    lvgl_kernels_init();
+#if LVGL_KERNELS_BENCH
+    lvgl_kernels_bench();
+#endif
+    lvgl_stats.window_start_us = esp_timer_get_time();
 
     // 初始化显示驱动
     esp_err_t ret = lvgl_display_init();
@@ -350,13 +881,6 @@ esp_err_t lvgl_driver_init(void)
         goto error;
     }
 
-    // 初始化tick定时器
-    ret = lvgl_tick_timer_init();
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to initialize tick timer");
-        goto error;
-    }
-
     // 创建LVGL任务
     ret = lvgl_task_init();
     if (ret != ESP_OK) {
@@ -378,3 +902,66 @@ void lvgl_driver_deinit(void)
     lvgl_cleanup_resources();
     ESP_LOGI(TAG, "LVGL driver deinitialized");
 }
+
+void lvgl_driver_wakeup(void)
+{
+    TaskHandle_t task = lvgl_task_handle;
+    if (task && task != xTaskGetCurrentTaskHandle()) {
+        xTaskNotifyGive(task);
+    }
+}
+
+void lvgl_driver_wakeup_from_isr(BaseType_t *woken)
+{
+    if (lvgl_task_handle) {
+        vTaskNotifyGiveFromISR(lvgl_task_handle, woken);
+    }
+}
+
+esp_err_t lvgl_driver_add_wake_timer(lv_timer_t *timer)
+{
+    if (!timer) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (lvgl_wake_timer_count >= LVGL_WAKE_TIMERS_MAX) {
+        ESP_LOGW(TAG, "唤醒定时器已满(%d)", LVGL_WAKE_TIMERS_MAX);
+        return ESP_ERR_NO_MEM;
+    }
+    lvgl_wake_timers[lvgl_wake_timer_count++] = timer;
+    return ESP_OK;
+}
+
+void lvgl_driver_get_stats(lvgl_driver_stats_t *stats, bool reset)
+{
+    if (!stats) {
+        return;
+    }
+
+    int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL(&lvgl_stats_lock);
+    int64_t window = now - lvgl_stats.window_start_us;
+    stats->frames = lvgl_stats.frames;
+    stats->frame_avg_us = lvgl_stats.frames ? (uint32_t)(lvgl_stats.frame_sum_us / lvgl_stats.frames) : 0;
+    stats->frame_max_us = lvgl_stats.frame_max_us;
+    stats->frame_jitter_us = lvgl_stats.jitter_count ?
+                             (uint32_t)(lvgl_stats.jitter_sum_us / lvgl_stats.jitter_count) : 0;
+    stats->wakeups = lvgl_stats.wakeups;
+    stats->early_wakeups = lvgl_stats.early_wakeups;
+    stats->busy_pct = window > 0 ? (uint32_t)(lvgl_stats.busy_us * 100 / window) : 0;
+    stats->flush_chunks = lvgl_stats.flush_chunks;
+    stats->flush_retries = lvgl_stats.flush_retries;
+    stats->flush_drops = lvgl_stats.flush_drops;
+    stats->flush_reinvalidated = lvgl_stats.flush_reinvalidated;
+    stats->flush_throttled = lvgl_stats.flush_throttled;
+    stats->flush_timeouts = lvgl_stats.flush_timeouts;
+    stats->render_throttled = lvgl_stats.render_throttled;
+    stats->inflight_max = lvgl_stats.inflight_max;
+    stats->areas_merged = lvgl_stats.areas_merged;
+    stats->cost_setup_us = lvgl_cost_setup_us;
+    stats->cost_px_ns = lvgl_cost_px_ns;
+    if (reset) {
+        memset(&lvgl_stats, 0, sizeof(lvgl_stats));
+        lvgl_stats.window_start_us = now;
+    }
+    portEXIT_CRITICAL(&lvgl_stats_lock);
+}
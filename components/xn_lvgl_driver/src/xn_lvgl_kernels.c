@@ -0,0 +1,458 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Description: RGB565 像素核：标量参考实现、PIE 分派、自检和周期基准
+ *
+ * 标量参考实现不依赖ESP-IDF，可在主机上编译，与LVGL 9.2的C实现逐位比对
+ * （tools/lvgl_kernels_test.c，由 lottie_assets.py kernels 编译运行）。
+ */
+
+#include <string.h>
+#include "xn_lvgl_kernels.h"
+
+#ifdef ESP_PLATFORM
+#include "sdkconfig.h"
+#include "esp_log.h"
+#include "esp_cpu.h"
+#include "esp_heap_caps.h"
+
+static const char *TAG = "LVGL_KERNELS";
+#endif
+
+#if defined(ESP_PLATFORM) && CONFIG_IDF_TARGET_ESP32S3
+#define LVGL_KERNELS_PIE    1
+// xn_lvgl_kernels_s3.S，地址均需16字节对齐
+void lvgl_pie_swap16(uint16_t *buf, uint32_t blocks);
+void lvgl_pie_fill16(uint16_t *dest, uint32_t blocks, const uint16_t *color);
+void lvgl_pie_copy16(uint16_t *dest, const uint16_t *src, uint32_t blocks);
+void lvgl_pie_blend_argb8888(uint16_t *dest, const uint8_t *src, uint32_t blocks,
+                             const uint16_t *k, uint16_t *scratch);
+
+// 混合核常量表（顺序与 xn_lvgl_kernels_s3.S 一致）
+static const uint16_t blend_consts[6] = { 1, 0x1F, 0x3F, 255, 2048, 32 };
+#else
+#define LVGL_KERNELS_PIE    0
+#endif
+
+static bool simd_enabled = false;
+
+// 自检和基准尺寸
+#define KERNEL_TEST_W       72      // 覆盖对齐头、整块和尾部
+#define KERNEL_TEST_ROWS    4
+#define KERNEL_BENCH_W      400     // 接近整屏宽度的动画
+#define KERNEL_BENCH_ROWS   40
+
+#define ALIGN16(p)          (((uintptr_t)(p) & 15) == 0)
+
+/*********************
+ * 标量参考实现
+ *********************/
+
+void lvgl_kernel_swap_ref(uint16_t *buf, uint32_t px)
+{
+    for (uint32_t i = 0; i < px; i++) {
+        buf[i] = (uint16_t)((buf[i] << 8) | (buf[i] >> 8));
+    }
+}
+
+void lvgl_kernel_fill_ref(uint16_t *dest, int32_t w, int32_t h, int32_t stride, uint16_t color)
+{
+    for (int32_t y = 0; y < h; y++) {
+        for (int32_t x = 0; x < w; x++) {
+            dest[x] = color;
+        }
+        dest = (uint16_t *)((uint8_t *)dest + stride);
+    }
+}
+
+void lvgl_kernel_copy_ref(uint16_t *dest, int32_t w, int32_t h, int32_t dest_stride,
+                          const uint16_t *src, int32_t src_stride)
+{
+    for (int32_t y = 0; y < h; y++) {
+        memcpy(dest, src, (size_t)w * 2);
+        dest = (uint16_t *)((uint8_t *)dest + dest_stride);
+        src = (const uint16_t *)((const uint8_t *)src + src_stride);
+    }
+}
+
+/* 与 LVGL 的 lv_color_24_16_mix 一致：透明度0/255特殊处理，其余按 >>8 近似 */
+static inline uint16_t blend_px(const uint8_t *c, uint16_t d)
+{
+    uint8_t a = c[3];
+    if (a == 0) {
+        return d;
+    }
+    if (a == 255) {
+        return (uint16_t)(((c[2] & 0xF8) << 8) + ((c[1] & 0xFC) << 3) + (c[0] >> 3));
+    }
+    uint32_t inv = 255 - a;
+    return (uint16_t)(((((c[2] >> 3) * a + ((d >> 11) & 0x1F) * inv) << 3) & 0xF800) +
+                      ((((c[1] >> 2) * a + ((d >> 5) & 0x3F) * inv) >> 3) & 0x07E0) +
+                      (((c[0] >> 3) * a + (d & 0x1F) * inv) >> 8));
+}
+
+void lvgl_kernel_blend_ref(uint16_t *dest, int32_t w, int32_t h, int32_t dest_stride,
+                           const uint8_t *src, int32_t src_stride)
+{
+    for (int32_t y = 0; y < h; y++) {
+        for (int32_t x = 0; x < w; x++) {
+            dest[x] = blend_px(&src[x * 4], dest[x]);
+        }
+        dest = (uint16_t *)((uint8_t *)dest + dest_stride);
+        src += src_stride;
+    }
+}
+
+/*********************
+ * PIE 分派：标量处理对齐头和尾部，中间整块交给 SIMD
+ *********************/
+
+#if LVGL_KERNELS_PIE
+
+static void swap_pie(uint16_t *buf, uint32_t px)
+{
+    while (px && !ALIGN16(buf)) {
+        *buf = (uint16_t)((*buf << 8) | (*buf >> 8));
+        buf++;
+        px--;
+    }
+    uint32_t blocks = px / 16;
+    if (blocks) {
+        lvgl_pie_swap16(buf, blocks);
+        buf += blocks * 16;
+        px -= blocks * 16;
+    }
+    lvgl_kernel_swap_ref(buf, px);
+}
+
+static void fill_pie(uint16_t *dest, int32_t w, int32_t h, int32_t stride, uint16_t color)
+{
+    for (int32_t y = 0; y < h; y++) {
+        uint16_t *d = dest;
+        int32_t n = w;
+        while (n && !ALIGN16(d)) {
+            *d++ = color;
+            n--;
+        }
+        if (n >= 8) {
+            lvgl_pie_fill16(d, n / 8, &color);
+            d += n & ~7;
+            n &= 7;
+        }
+        while (n--) {
+            *d++ = color;
+        }
+        dest = (uint16_t *)((uint8_t *)dest + stride);
+    }
+}
+
+static void copy_pie(uint16_t *dest, int32_t w, int32_t h, int32_t dest_stride,
+                     const uint16_t *src, int32_t src_stride)
+{
+    for (int32_t y = 0; y < h; y++) {
+        // 源和目标的对齐偏移不同时无法同时对齐，整行交给 memcpy
+        if (((uintptr_t)dest ^ (uintptr_t)src) & 15) {
+            memcpy(dest, src, (size_t)w * 2);
+        } else {
+            uint16_t *d = dest;
+            const uint16_t *s = src;
+            int32_t n = w;
+            while (n && !ALIGN16(d)) {
+                *d++ = *s++;
+                n--;
+            }
+            if (n >= 8) {
+                lvgl_pie_copy16(d, s, n / 8);
+                d += n & ~7;
+                s += n & ~7;
+                n &= 7;
+            }
+            memcpy(d, s, (size_t)n * 2);
+        }
+        dest = (uint16_t *)((uint8_t *)dest + dest_stride);
+        src = (const uint16_t *)((const uint8_t *)src + src_stride);
+    }
+}
+
+static void blend_pie(uint16_t *dest, int32_t w, int32_t h, int32_t dest_stride,
+                      const uint8_t *src, int32_t src_stride)
+{
+    uint16_t scratch[8] __attribute__((aligned(16)));
+
+    for (int32_t y = 0; y < h; y++) {
+        uint16_t *d = dest;
+        const uint8_t *s = src;
+        int32_t n = w;
+        while (n && !ALIGN16(d)) {
+            *d = blend_px(s, *d);
+            d++;
+            s += 4;
+            n--;
+        }
+        // 目标对齐后源也需16字节对齐（LVGL绘制缓冲区按行对齐时成立），否则整行走标量
+        if (n >= 8 && ALIGN16(s)) {
+            lvgl_pie_blend_argb8888(d, s, n / 8, blend_consts, scratch);
+            d += n & ~7;
+            s += (n & ~7) * 4;
+            n &= 7;
+        }
+        lvgl_kernel_blend_ref(d, n, 1, 0, s, 0);
+        dest = (uint16_t *)((uint8_t *)dest + dest_stride);
+        src += src_stride;
+    }
+}
+
+#endif
+
+/*********************
+ * 公共接口
+ *********************/
+
+void lvgl_kernel_rgb565_swap(void *buf, uint32_t px)
+{
+#if LVGL_KERNELS_PIE
+    if (simd_enabled && px >= LVGL_KERNEL_MIN_SIMD_PX) {
+        swap_pie(buf, px);
+        return;
+    }
+#endif
+    lvgl_kernel_swap_ref(buf, px);
+}
+
+bool lvgl_kernel_fill_rgb565(void *dest, int32_t w, int32_t h, int32_t stride, uint16_t color)
+{
+#if LVGL_KERNELS_PIE
+    if (simd_enabled && w >= LVGL_KERNEL_MIN_SIMD_PX) {
+        fill_pie(dest, w, h, stride, color);
+        return true;
+    }
+#endif
+    return false;
+}
+
+bool lvgl_kernel_copy_rgb565(void *dest, int32_t w, int32_t h, int32_t dest_stride,
+                             const void *src, int32_t src_stride)
+{
+#if LVGL_KERNELS_PIE
+    if (simd_enabled && w >= LVGL_KERNEL_MIN_SIMD_PX) {
+        copy_pie(dest, w, h, dest_stride, src, src_stride);
+        return true;
+    }
+#endif
+    return false;
+}
+
+bool lvgl_kernel_blend_argb8888_rgb565(void *dest, int32_t w, int32_t h, int32_t dest_stride,
+                                       const void *src, int32_t src_stride)
+{
+#if LVGL_KERNELS_PIE
+    if (simd_enabled && w >= LVGL_KERNEL_MIN_SIMD_PX) {
+        blend_pie(dest, w, h, dest_stride, src, src_stride);
+        return true;
+    }
+#endif
+    return false;
+}
+
+bool lvgl_kernels_simd_enabled(void)
+{
+    return simd_enabled;
+}
+
+#ifdef ESP_PLATFORM
+
+#if LVGL_KERNELS_PIE
+
+static uint32_t test_rng = 0x2545F491;
+
+static uint32_t test_rand(void)
+{
+    test_rng ^= test_rng << 13;
+    test_rng ^= test_rng >> 17;
+    test_rng ^= test_rng << 5;
+    return test_rng;
+}
+
+static void test_fill_random(uint8_t *buf, size_t size)
+{
+    for (size_t i = 0; i < size; i++) {
+        buf[i] = (uint8_t)test_rand();
+    }
+}
+
+/* 逐像素比对 SIMD 和参考实现：不同宽度（含小于一块）、不同起始对齐，透明度含0/255 */
+static bool kernels_selftest(void)
+{
+    const int32_t stride16 = (KERNEL_TEST_W + 8) * 2;
+    const int32_t stride32 = (KERNEL_TEST_W + 8) * 4;
+    size_t size16 = (size_t)stride16 * KERNEL_TEST_ROWS;
+    size_t size32 = (size_t)stride32 * KERNEL_TEST_ROWS;
+    uint8_t *a = heap_caps_aligned_alloc(16, size16, MALLOC_CAP_INTERNAL);
+    uint8_t *b = heap_caps_aligned_alloc(16, size16, MALLOC_CAP_INTERNAL);
+    uint8_t *src = heap_caps_aligned_alloc(16, size32, MALLOC_CAP_INTERNAL);
+    bool ok = a && b && src;
+
+    for (int32_t w = 1; ok && w <= KERNEL_TEST_W; w += (w < 20 ? 1 : 13)) {
+        for (int32_t off = 0; ok && off < 8; off++) {
+            uint16_t *da = (uint16_t *)a + off;
+            uint16_t *db = (uint16_t *)b + off;
+            uint32_t px = (uint32_t)w * KERNEL_TEST_ROWS;
+
+            test_fill_random(a, size16);
+            memcpy(b, a, size16);
+            lvgl_kernel_swap_ref(da, px);
+            swap_pie(db, px);
+            ok = memcmp(a, b, size16) == 0;
+            if (!ok) {
+                ESP_LOGE(TAG, "字节交换自检失败: w=%ld off=%ld", (long)w, (long)off);
+                break;
+            }
+
+            uint16_t color = (uint16_t)test_rand();
+            lvgl_kernel_fill_ref(da, w, KERNEL_TEST_ROWS, stride16, color);
+            fill_pie(db, w, KERNEL_TEST_ROWS, stride16, color);
+            ok = memcmp(a, b, size16) == 0;
+            if (!ok) {
+                ESP_LOGE(TAG, "填充自检失败: w=%ld off=%ld", (long)w, (long)off);
+                break;
+            }
+
+            // 复制：奇数偏移时源与目标同偏移（走SIMD），偶数偏移时源不偏移（除0外走memcpy）
+            test_fill_random(src, size32);
+            const uint16_t *s16 = (const uint16_t *)src + (off & 1 ? off : 0);
+            lvgl_kernel_copy_ref(da, w, KERNEL_TEST_ROWS, stride16, s16, stride16);
+            copy_pie(db, w, KERNEL_TEST_ROWS, stride16, s16, stride16);
+            ok = memcmp(a, b, size16) == 0;
+            if (!ok) {
+                ESP_LOGE(TAG, "复制自检失败: w=%ld off=%ld", (long)w, (long)off);
+                break;
+            }
+
+            // 混合：目标偏移 off 像素，源偏移相同像素数，目标对齐后源同样对齐
+            test_fill_random(src, size32);
+            for (size_t i = 3; i < size32; i += 4) {
+                uint32_t r = test_rand() & 3;
+                src[i] = r == 0 ? 0 : (r == 1 ? 255 : src[i]);
+            }
+            const uint8_t *s32 = src + off * 4;
+            lvgl_kernel_blend_ref(da, w, KERNEL_TEST_ROWS, stride16, s32, stride32);
+            blend_pie(db, w, KERNEL_TEST_ROWS, stride16, s32, stride32);
+            ok = memcmp(a, b, size16) == 0;
+            if (!ok) {
+                ESP_LOGE(TAG, "混合自检失败: w=%ld off=%ld", (long)w, (long)off);
+                break;
+            }
+        }
+    }
+
+    heap_caps_free(a);
+    heap_caps_free(b);
+    heap_caps_free(src);
+    return ok;
+}
+
+#endif
+
+esp_err_t lvgl_kernels_init(void)
+{
+#if LVGL_KERNELS_PIE
+    simd_enabled = false;
+    if (!kernels_selftest()) {
+        ESP_LOGE(TAG, "PIE 像素核自检失败，使用标量实现");
+        return ESP_FAIL;
+    }
+    simd_enabled = true;
+    ESP_LOGI(TAG, "PIE 像素核已启用（字节交换、填充、复制、ARGB8888混合）");
+    return ESP_OK;
+#else
+    ESP_LOGI(TAG, "目标不支持 PIE，使用标量像素核");
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+#if LVGL_KERNELS_PIE
+
+typedef enum {
+    BENCH_SWAP,
+    BENCH_FILL,
+    BENCH_COPY,
+    BENCH_BLEND,
+} bench_kernel_t;
+
+static void bench_run(bench_kernel_t kernel, bool simd, uint16_t *dest, const uint8_t *src,
+                      int32_t stride16, int32_t stride32)
+{
+    const int32_t w = KERNEL_BENCH_W;
+    const int32_t h = KERNEL_BENCH_ROWS;
+    switch (kernel) {
+    case BENCH_SWAP:
+        if (simd) {
+            swap_pie(dest, (uint32_t)(stride16 / 2) * h);
+        } else {
+            lvgl_kernel_swap_ref(dest, (uint32_t)(stride16 / 2) * h);
+        }
+        break;
+    case BENCH_FILL:
+        if (simd) {
+            fill_pie(dest, w, h, stride16, 0x1234);
+        } else {
+            lvgl_kernel_fill_ref(dest, w, h, stride16, 0x1234);
+        }
+        break;
+    case BENCH_COPY:
+        if (simd) {
+            copy_pie(dest, w, h, stride16, (const uint16_t *)src, stride16);
+        } else {
+            lvgl_kernel_copy_ref(dest, w, h, stride16, (const uint16_t *)src, stride16);
+        }
+        break;
+    case BENCH_BLEND:
+        if (simd) {
+            blend_pie(dest, w, h, stride16, src, stride32);
+        } else {
+            lvgl_kernel_blend_ref(dest, w, h, stride16, src, stride32);
+        }
+        break;
+    }
+}
+
+#endif
+
+void lvgl_kernels_bench(void)
+{
+#if LVGL_KERNELS_PIE
+    static const char *const names[] = { "字节交换", "填充", "复制", "ARGB8888混合" };
+    const int32_t stride16 = KERNEL_BENCH_W * 2;
+    const int32_t stride32 = KERNEL_BENCH_W * 4;
+    uint16_t *dest = heap_caps_aligned_alloc(16, (size_t)stride16 * KERNEL_BENCH_ROWS, MALLOC_CAP_SPIRAM);
+    uint8_t *src = heap_caps_aligned_alloc(16, (size_t)stride32 * KERNEL_BENCH_ROWS, MALLOC_CAP_SPIRAM);
+    if (!dest || !src) {
+        ESP_LOGE(TAG, "基准缓冲区分配失败");
+        heap_caps_free(dest);
+        heap_caps_free(src);
+        return;
+    }
+
+    test_fill_random(src, (size_t)stride32 * KERNEL_BENCH_ROWS);
+    const uint32_t px = KERNEL_BENCH_W * KERNEL_BENCH_ROWS;
+    for (int k = BENCH_SWAP; k <= BENCH_BLEND; k++) {
+        uint32_t cycles[2];
+        for (int simd = 0; simd < 2; simd++) {
+            bench_run(k, simd, dest, src, stride16, stride32);     // 预热缓存
+            uint32_t start = esp_cpu_get_cycle_count();
+            bench_run(k, simd, dest, src, stride16, stride32);
+            cycles[simd] = esp_cpu_get_cycle_count() - start;
+        }
+        ESP_LOGI(TAG, "%s: 参考 %lu.%02lu 周期/像素, PIE %lu.%02lu 周期/像素%s", names[k],
+                 (unsigned long)(cycles[0] / px), (unsigned long)(cycles[0] * 100 / px % 100),
+                 (unsigned long)(cycles[1] / px), (unsigned long)(cycles[1] * 100 / px % 100),
+                 simd_enabled ? "" : "（未启用）");
+    }
+
+    heap_caps_free(dest);
+    heap_caps_free(src);
+#else
+    ESP_LOGI(TAG, "目标不支持 PIE，无SIMD基准");
+#endif
+}
+
+#endif